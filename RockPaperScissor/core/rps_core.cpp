@@ -0,0 +1,311 @@
+#include "rps_core.h"
+
+#include "ComputerPlayer.h"
+#include "ContextTreeStrategy.h"
+#include "FrequencyFileWriter.h"
+#include "LongestMatchStrategy.h"
+#include "Move.h"
+#include "RandomStrategy.h"
+#include "SmartStrategy.h"
+#include "Strategy.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A session owns its strategy and history, like ComputerPlayer. 'smart' is
+// the strategy when it is a SmartStrategy, for saving its model.
+struct rps_session {
+    std::unique_ptr<Strategy> strategy;
+    SmartStrategy* smart = nullptr;
+    std::vector<std::pair<Move, Move>> history;
+    std::string modelPath;
+    rps_score score = {};
+};
+
+namespace {
+
+// Nothing may unwind through the C ABI.
+template <typename Function>
+int32_t guarded(Function&& function) {
+    try {
+        return function();
+    } catch (const std::bad_alloc&) {
+        return RPS_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        return RPS_ERROR_INTERNAL;
+    }
+}
+
+bool isMove(int32_t move) {
+    return move >= RPS_ROCK && move <= RPS_SCISSORS;
+}
+
+void markFailed(rps_round* round, int32_t status) {
+    if (round) {
+        *round = {-1, RPS_TIE, -1, status};
+    }
+}
+
+// Copy the fields the caller's config has; a config from an older, shorter
+// header keeps the defaults for the rest.
+bool readConfig(const rps_session_config* config, rps_session_config& out) {
+    rps_session_config_init(&out);
+    if (!config) {
+        return true;
+    }
+    if (config->struct_size < sizeof(uint32_t)) {
+        return false;
+    }
+    std::memcpy(&out, config, std::min<size_t>(config->struct_size, sizeof(out)));
+    out.struct_size = sizeof(out);
+    return true;
+}
+
+int32_t createSession(const rps_session_config& config, uint32_t seed, rps_session** out) {
+    auto session = std::make_unique<rps_session>();
+    switch (config.strategy) {
+        case RPS_STRATEGY_RANDOM:
+            session->strategy = std::make_unique<RandomStrategy>(seed, std::string());
+            break;
+        case RPS_STRATEGY_SMART: {
+            if (config.model_format != RPS_MODEL_TEXT && config.model_format != RPS_MODEL_COMPACT) {
+                return RPS_ERROR_INVALID_ARGUMENT;
+            }
+            session->modelPath = config.model_path ? config.model_path : "";
+            auto smart = std::make_unique<SmartStrategy>(seed, session->modelPath, std::string());
+            smart->setAdaptiveOrders(config.adaptive != 0);
+            smart->setModelFileFormat(config.model_format == RPS_MODEL_COMPACT ? ModelFileFormat::Compact
+                                                                              : ModelFileFormat::Text);
+            session->smart = smart.get();
+            session->strategy = std::move(smart);
+            break;
+        }
+        case RPS_STRATEGY_TREE: {
+            if (config.max_order < 1) {
+                return RPS_ERROR_INVALID_ARGUMENT;
+            }
+            session->strategy = std::make_unique<ContextTreeStrategy>(seed, 3, config.max_order);
+            break;
+        }
+        case RPS_STRATEGY_MATCH: {
+            session->strategy = std::make_unique<LongestMatchStrategy>(seed);
+            break;
+        }
+        default:
+            return RPS_ERROR_INVALID_ARGUMENT;
+    }
+    *out = session.release();
+    return RPS_OK;
+}
+
+// One round, in the same order as Game::play: the strategy moves on the
+// history so far, then learns from the completed round.
+void playRound(rps_session& session, int32_t humanMove, rps_round* round) {
+    Move computerMove = session.strategy->makeMove(session.history);
+    Move prediction;
+    int32_t predicted = strategyPrediction(*session.strategy, prediction) ? static_cast<int32_t>(prediction) : -1;
+
+    Move human = static_cast<Move>(humanMove);
+    session.history.emplace_back(human, computerMove);
+    session.strategy->updateFrequencies(session.history);
+
+    int outcome = determineWinner(human, computerMove);
+    session.score.rounds++;
+    if (outcome > 0) {
+        session.score.human_wins++;
+    } else if (outcome < 0) {
+        session.score.computer_wins++;
+    } else {
+        session.score.ties++;
+    }
+    if (round) {
+        *round = {static_cast<int32_t>(computerMove), outcome, predicted, RPS_OK};
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+uint32_t rps_core_abi_version(void) {
+    return RPS_CORE_ABI_VERSION;
+}
+
+const char* rps_status_string(int32_t status) {
+    switch (status) {
+        case RPS_OK:
+            return "ok";
+        case RPS_ERROR_INVALID_ARGUMENT:
+            return "invalid argument";
+        case RPS_ERROR_UNSUPPORTED:
+            return "not supported by this session";
+        case RPS_ERROR_IO:
+            return "file could not be written";
+        case RPS_ERROR_OUT_OF_MEMORY:
+            return "out of memory";
+        case RPS_ERROR_INTERNAL:
+            return "internal error";
+        default:
+            return "unknown status";
+    }
+}
+
+void rps_session_config_init(rps_session_config* config) {
+    if (!config) {
+        return;
+    }
+    *config = {};
+    config->struct_size = sizeof(rps_session_config);
+    config->strategy = RPS_STRATEGY_SMART;
+    config->seed = 0;
+    config->max_order = 16;
+    config->adaptive = 0;
+    config->model_format = RPS_MODEL_TEXT;
+    config->model_path = nullptr;
+}
+
+int32_t rps_session_create(const rps_session_config* config, rps_session** session) {
+    if (!session) {
+        return RPS_ERROR_INVALID_ARGUMENT;
+    }
+    *session = nullptr;
+    return guarded([&] {
+        rps_session_config settings;
+        if (!readConfig(config, settings)) {
+            return static_cast<int32_t>(RPS_ERROR_INVALID_ARGUMENT);
+        }
+        return createSession(settings, settings.seed, session);
+    });
+}
+
+void rps_session_destroy(rps_session* session) {
+    delete session;
+}
+
+int32_t rps_session_step(rps_session* session, int32_t human_move, rps_round* round) {
+    if (!session || !isMove(human_move)) {
+        markFailed(round, RPS_ERROR_INVALID_ARGUMENT);
+        return RPS_ERROR_INVALID_ARGUMENT;
+    }
+    int32_t status = guarded([&] {
+        playRound(*session, human_move, round);
+        return static_cast<int32_t>(RPS_OK);
+    });
+    if (status != RPS_OK) {
+        markFailed(round, status);
+    }
+    return status;
+}
+
+int32_t rps_session_step_many(rps_session* session, const int32_t* human_moves, size_t count, rps_round* rounds) {
+    if (count == 0) {
+        return RPS_OK;
+    }
+    if (!session || !human_moves || !rounds) {
+        return RPS_ERROR_INVALID_ARGUMENT;
+    }
+    size_t done = 0;
+    int32_t status = guarded([&] {
+        // The history grows by 'count' rounds: at most one reallocation per
+        // batch, still geometric so small batches do not copy it every time.
+        auto& history = session->history;
+        if (history.capacity() - history.size() < count) {
+            history.reserve(std::max(history.size() + count, 2 * history.capacity()));
+        }
+        for (; done < count; ++done) {
+            if (!isMove(human_moves[done])) {
+                return static_cast<int32_t>(RPS_ERROR_INVALID_ARGUMENT);
+            }
+            playRound(*session, human_moves[done], &rounds[done]);
+        }
+        return static_cast<int32_t>(RPS_OK);
+    });
+    for (size_t i = done; i < count; ++i) {
+        markFailed(&rounds[i], status);
+    }
+    return status;
+}
+
+int32_t rps_sessions_step(rps_session* const* sessions, const int32_t* human_moves, size_t count, rps_round* rounds) {
+    if (count == 0) {
+        return RPS_OK;
+    }
+    if (!sessions || !human_moves || !rounds) {
+        return RPS_ERROR_INVALID_ARGUMENT;
+    }
+    int32_t first = RPS_OK;
+    for (size_t i = 0; i < count; ++i) {
+        int32_t status = rps_session_step(sessions[i], human_moves[i], &rounds[i]);
+        if (status != RPS_OK && first == RPS_OK) {
+            first = status;
+        }
+    }
+    return first;
+}
+
+int32_t rps_sessions_create(const rps_session_config* config, size_t count, rps_session** sessions) {
+    if (count == 0) {
+        return RPS_OK;
+    }
+    if (!sessions) {
+        return RPS_ERROR_INVALID_ARGUMENT;
+    }
+    std::fill(sessions, sessions + count, nullptr);
+    int32_t status = guarded([&] {
+        rps_session_config settings;
+        if (!readConfig(config, settings)) {
+            return static_cast<int32_t>(RPS_ERROR_INVALID_ARGUMENT);
+        }
+        for (size_t i = 0; i < count; ++i) {
+            int32_t created = createSession(settings, settings.seed + static_cast<uint32_t>(i), &sessions[i]);
+            if (created != RPS_OK) {
+                return created;
+            }
+        }
+        return static_cast<int32_t>(RPS_OK);
+    });
+    if (status != RPS_OK) {
+        rps_sessions_destroy(sessions, count);
+        std::fill(sessions, sessions + count, nullptr);
+    }
+    return status;
+}
+
+void rps_sessions_destroy(rps_session* const* sessions, size_t count) {
+    if (!sessions) {
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        delete sessions[i];
+    }
+}
+
+int32_t rps_session_get_score(const rps_session* session, rps_score* score) {
+    if (!session || !score) {
+        return RPS_ERROR_INVALID_ARGUMENT;
+    }
+    *score = session->score;
+    return RPS_OK;
+}
+
+int32_t rps_session_save(rps_session* session, const char* path) {
+    if (!session) {
+        return RPS_ERROR_INVALID_ARGUMENT;
+    }
+    if (!session->smart) {
+        return RPS_ERROR_UNSUPPORTED;
+    }
+    return guarded([&] {
+        std::string target = path ? path : session->modelPath;
+        if (target.empty()) {
+            return static_cast<int32_t>(RPS_ERROR_UNSUPPORTED);
+        }
+        return static_cast<int32_t>(session->smart->saveModel(target) ? RPS_OK : RPS_ERROR_IO);
+    });
+}
+
+} // extern "C"
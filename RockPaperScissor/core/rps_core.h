@@ -0,0 +1,152 @@
+#ifndef RPS_CORE_H
+#define RPS_CORE_H
+
+/*
+ * rps_core: the game engine as a shared library with a C ABI, for host
+ * processes that run sessions in-process instead of wrapping rps_console.
+ *
+ * A session is one computer player (strategy, model and history) playing one
+ * human. Each step takes the human's move and returns the computer's move,
+ * which the strategy chose before seeing it, and the outcome. The batched
+ * calls advance many rounds or many sessions in one call, so a host that
+ * pays for every FFI crossing (Python, Java, ...) pays once per batch.
+ *
+ * Sessions are independent: different sessions may be used from different
+ * threads at the same time, but one session must not be used concurrently.
+ * No function throws; every failure is reported as an rps_status.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(RPS_CORE_BUILD)
+#define RPS_CORE_API __declspec(dllexport)
+#else
+#define RPS_CORE_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define RPS_CORE_API __attribute__((visibility("default")))
+#else
+#define RPS_CORE_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped whenever a function or struct changes incompatibly. */
+#define RPS_CORE_ABI_VERSION 1
+
+typedef struct rps_session rps_session;
+
+/* Moves, with the same values as the engine's Move. */
+enum {
+    RPS_ROCK = 0,
+    RPS_PAPER = 1,
+    RPS_SCISSORS = 2
+};
+
+enum {
+    RPS_STRATEGY_RANDOM = 0,
+    RPS_STRATEGY_SMART = 1,
+    RPS_STRATEGY_TREE = 2,
+    RPS_STRATEGY_MATCH = 3   /* longest earlier repetition of the history */
+};
+
+/* Outcome of a round, from the human's side. */
+enum {
+    RPS_COMPUTER_WIN = -1,
+    RPS_TIE = 0,
+    RPS_HUMAN_WIN = 1
+};
+
+/* Model file formats for rps_session_save. */
+enum {
+    RPS_MODEL_TEXT = 0,
+    RPS_MODEL_COMPACT = 1
+};
+
+typedef enum rps_status {
+    RPS_OK = 0,
+    RPS_ERROR_INVALID_ARGUMENT = 1,
+    RPS_ERROR_UNSUPPORTED = 2,  /* e.g. saving a session without a model */
+    RPS_ERROR_IO = 3,
+    RPS_ERROR_OUT_OF_MEMORY = 4,
+    RPS_ERROR_INTERNAL = 5
+} rps_status;
+
+typedef struct rps_session_config {
+    uint32_t struct_size;    /* sizeof(rps_session_config), set by rps_session_config_init */
+    int32_t strategy;        /* RPS_STRATEGY_*, default smart */
+    uint32_t seed;           /* seed for the computer's random choices */
+    int32_t max_order;       /* tree: longest sequence length, default 16 */
+    int32_t adaptive;        /* smart: nonzero enables adaptive orders */
+    int32_t model_format;    /* smart: RPS_MODEL_* used by rps_session_save */
+    const char* model_path;  /* smart: model file loaded at creation and saved to by
+                                rps_session_save; NULL or "" keeps it in memory only */
+} rps_session_config;
+
+typedef struct rps_round {
+    int32_t computer_move;   /* RPS_ROCK..RPS_SCISSORS, or -1 if the step failed */
+    int32_t outcome;         /* RPS_HUMAN_WIN, RPS_COMPUTER_WIN or RPS_TIE */
+    int32_t predicted_move;  /* the human move the strategy predicted, or -1 */
+    int32_t status;          /* rps_status of this step */
+} rps_round;
+
+typedef struct rps_score {
+    uint64_t rounds;
+    uint64_t human_wins;
+    uint64_t computer_wins;
+    uint64_t ties;
+} rps_score;
+
+RPS_CORE_API uint32_t rps_core_abi_version(void);
+
+/* Static, human-readable name of a status. */
+RPS_CORE_API const char* rps_status_string(int32_t status);
+
+/* Fill 'config' with the defaults. Always call it before setting fields, so
+   a host built against an older header keeps working with a newer library. */
+RPS_CORE_API void rps_session_config_init(rps_session_config* config);
+
+RPS_CORE_API int32_t rps_session_create(const rps_session_config* config, rps_session** session);
+
+/* Destroying NULL is a no-op. The model is not saved; see rps_session_save. */
+RPS_CORE_API void rps_session_destroy(rps_session* session);
+
+/* Play one round. 'round' receives the result and may be NULL. */
+RPS_CORE_API int32_t rps_session_step(rps_session* session, int32_t human_move, rps_round* round);
+
+/* Play 'count' rounds of one session, human_moves[i] in round i. Stops at
+   the first invalid move and returns its status; rounds[] from there on are
+   marked failed. */
+RPS_CORE_API int32_t rps_session_step_many(rps_session* session, const int32_t* human_moves,
+                                           size_t count, rps_round* rounds);
+
+/* Play one round in each of 'count' sessions: sessions[i] plays
+   human_moves[i] and its result goes to rounds[i]. Every entry is stepped
+   even if another fails; the first failure's status is returned. The same
+   session may appear more than once and then plays that many rounds, in
+   order. */
+RPS_CORE_API int32_t rps_sessions_step(rps_session* const* sessions, const int32_t* human_moves,
+                                       size_t count, rps_round* rounds);
+
+/* Create 'count' sessions from one config, session i seeded with
+   config->seed + i. On failure none are left created. */
+RPS_CORE_API int32_t rps_sessions_create(const rps_session_config* config, size_t count,
+                                         rps_session** sessions);
+
+RPS_CORE_API void rps_sessions_destroy(rps_session* const* sessions, size_t count);
+
+RPS_CORE_API int32_t rps_session_get_score(const rps_session* session, rps_score* score);
+
+/* Write a smart session's model to 'path', or to its model_path when 'path'
+   is NULL. */
+RPS_CORE_API int32_t rps_session_save(rps_session* session, const char* path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -5,14 +5,22 @@
 #include "SmartStrategy.h"
 #include "Game.h"
 #include "Move.h"
+#include "ScriptedPlayer.h"
+#include <chrono>
+#include <ctime>
+#include <fstream>
 #include <iostream>
 
 RPSGameManager::RPSGameManager()
-    : chosenStrategy(0), totalRounds(5), currentRound(0),
-      humanScore(0), computerScore(0), tieCount(0), lastComputerMove(Move::ROCK)
+    : chosenStrategy(0), totalRounds(5)
 {
 }
 
+RPSGameManager::~RPSGameManager()
+{
+    stopAutoPlay();
+}
+
 void RPSGameManager::setStrategy(int index)
 {
     chosenStrategy = index;
@@ -23,20 +31,37 @@ void RPSGameManager::setRounds(int r)
     totalRounds = r;
 }
 
+void RPSGameManager::setModelReload(int intervalMs)
+{
+    reloadIntervalMs = intervalMs;
+}
+
 void RPSGameManager::startNewGame()
 {
-    currentRound = 0;
-    humanScore = 0;
-    computerScore = 0;
-    tieCount = 0;
-    lastRoundResult.clear();
+    createGame(true);
+}
+
+void RPSGameManager::createGame(bool strategyLog)
+{
+    stopAutoPlay();
+    state = RoundState();
+    // Let the previous strategy finish saving before the next one loads.
+    game.reset();
 
     // Create new players.
     humanPlayer = std::make_unique<HumanPlayer>();
+    const unsigned int seed = static_cast<unsigned int>(std::time(nullptr));
     if (chosenStrategy == 0)
-        computerPlayer = std::make_unique<ComputerPlayer>(std::make_unique<RandomStrategy>());
-    else
-        computerPlayer = std::make_unique<ComputerPlayer>(std::make_unique<SmartStrategy>());
+        computerPlayer = std::make_unique<ComputerPlayer>(
+            std::make_unique<RandomStrategy>(seed, strategyLog ? "output-random.txt" : ""));
+    else {
+        // Save in the background so the UI thread never waits for freq.txt.
+        auto smart = std::make_unique<SmartStrategy>(seed, "freq.txt", strategyLog ? "output-smart.txt" : "");
+        smart->setBackgroundSave(true);
+        if (reloadIntervalMs > 0)
+            smart->setHotReload(true, std::chrono::milliseconds(reloadIntervalMs));
+        computerPlayer = std::make_unique<ComputerPlayer>(std::move(smart));
+    }
 
     // Create a new Game instance with the specified rounds.
     game = std::make_unique<Game>(
@@ -44,81 +69,162 @@ void RPSGameManager::startNewGame()
         std::move(computerPlayer),
         totalRounds
     );
+    strategyName = game->getComputerPlayer()->getStrategyName();
+    // A game of known length never grows the history while it is played.
+    game->getComputerPlayer()->reserveHistory(static_cast<std::size_t>(totalRounds));
 }
 
 void RPSGameManager::playRound(Move humanMove)
 {
-    if (!game || currentRound >= totalRounds)
+    if (isAutoPlaying())
+        return;
+    if (!game || state.currentRound >= totalRounds)
     {
         // Before indicating game over, save the strategy state.
         if (game) {
             game->getComputerPlayer()->saveState();
         }
-        lastRoundResult = "Game over!";
+        state.lastRoundResult = "Game over!";
         return;
     }
 
-    currentRound++;
+    playMove(state, humanMove);
+    game->getHumanPlayer()->recordResult(humanMove, state.lastComputerMove);
+}
+
+void RPSGameManager::playMove(RoundState& round, Move humanMove)
+{
+    round.currentRound++;
 
-    // Retrieve players using getters from Game (ensure these getters exist in Game.h)
     auto* cPlayer = game->getComputerPlayer();
-    auto* hPlayer = game->getHumanPlayer();
 
     // Get computer move
     Move computerMove = cPlayer->makeMove();
-    lastComputerMove = computerMove;
+    round.lastComputerMove = computerMove;
+
+    // The human move the strategy predicted for this round, if it made one
+    // (Smart only).
+    round.predictionValid = cPlayer->getPrediction(round.lastPredictedHumanMove);
 
-    // NEW: Retrieve the predicted human move from the computer player's strategy.
-    // This works only if the strategy is Smart.
-    // (If not, the getter will return a default value.)
-    // We do not store it separately here; we'll fetch it via getLastPredictedHumanMove().
-    
     int result = determineWinner(humanMove, computerMove);
     if (result > 0)
     {
-        humanScore++;
-        lastRoundResult = "You win this round!";
+        round.humanScore++;
+        round.lastRoundResult = "You win this round!";
     }
     else if (result < 0)
     {
-        computerScore++;
-        lastRoundResult = "Computer wins this round!";
+        round.computerScore++;
+        round.lastRoundResult = "Computer wins this round!";
     }
     else
     {
-        tieCount++;
-        lastRoundResult = "It's a tie!";
+        round.tieCount++;
+        round.lastRoundResult = "It's a tie!";
     }
 
-    hPlayer->recordResult(humanMove, computerMove);
     cPlayer->recordResult(humanMove, computerMove);
 }
 
-int RPSGameManager::getCurrentRound() const { return currentRound; }
-Move RPSGameManager::getLastComputerMove() const { return lastComputerMove; }
-std::string RPSGameManager::getRoundResult() const { return lastRoundResult; }
-int RPSGameManager::getHumanScore() const { return humanScore; }
-int RPSGameManager::getComputerScore() const { return computerScore; }
-int RPSGameManager::getTies() const { return tieCount; }
+bool RPSGameManager::startAutoPlay(const std::string& scriptPath)
+{
+    auto script = std::make_unique<std::ifstream>(scriptPath, std::ios::binary);
+    if (!*script) {
+        std::cerr << "Cannot open auto-play script " << scriptPath << std::endl;
+        return false;
+    }
+    createGame(false);
+    stopRequested = false;
+    snapshotWanted = false;
+    autoPlayDone = false;
+    published = state;
+    autoPlayRate = 0;
+    autoPlayStart = std::chrono::steady_clock::now();
+    autoPlayThread = std::thread(&RPSGameManager::runAutoPlay, this, std::move(script));
+    return true;
+}
 
+void RPSGameManager::runAutoPlay(std::unique_ptr<std::istream> script)
+{
+    ScriptedPlayer scripted(*script);
+    RoundState round = published;
+    while (!stopRequested.load(std::memory_order_relaxed) && !scripted.isExhausted()) {
+        playMove(round, scripted.makeMove());
+        // One relaxed load per round; the copy is made at most once per
+        // syncAutoPlay().
+        if (snapshotWanted.load(std::memory_order_relaxed)) {
+            snapshotWanted.store(false, std::memory_order_relaxed);
+            publish(round);
+        }
+    }
+    game->getComputerPlayer()->saveState();
+    publish(round);
+    autoPlayDone.store(true, std::memory_order_release);
+}
+
+void RPSGameManager::publish(const RoundState& round)
+{
+    std::lock_guard<std::mutex> lock(publishMutex);
+    published = round;
+}
+
+bool RPSGameManager::syncAutoPlay()
+{
+    if (!autoPlayThread.joinable())
+        return false;
+    // Checked before taking the state: once done, 'published' is final.
+    bool done = autoPlayDone.load(std::memory_order_acquire);
+    {
+        std::lock_guard<std::mutex> lock(publishMutex);
+        state = published;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - autoPlayStart).count();
+    if (seconds > 0)
+        autoPlayRate = state.currentRound / seconds;
+    if (done) {
+        autoPlayThread.join();
+        return false;
+    }
+    snapshotWanted.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+void RPSGameManager::stopAutoPlay()
+{
+    if (!autoPlayThread.joinable())
+        return;
+    stopRequested = true;
+    autoPlayThread.join();
+    state = published;
+}
+
+bool RPSGameManager::isAutoPlaying() const
+{
+    return autoPlayThread.joinable();
+}
+
+double RPSGameManager::getAutoPlayRate() const
+{
+    return autoPlayRate;
+}
+
+int RPSGameManager::getCurrentRound() const { return state.currentRound; }
+Move RPSGameManager::getLastComputerMove() const { return state.lastComputerMove; }
+std::string RPSGameManager::getRoundResult() const { return std::string(state.lastRoundResult); }
+int RPSGameManager::getHumanScore() const { return state.humanScore; }
+int RPSGameManager::getComputerScore() const { return state.computerScore; }
+int RPSGameManager::getTies() const { return state.tieCount; }
+
+// These read only the manager's own state, so they are safe to call while
+// the auto-play worker is using the game.
 std::string RPSGameManager::getStrategyName() const {
-    if (game && game->getComputerPlayer())
-        return game->getComputerPlayer()->getStrategyName();
-    return "";
+    return strategyName;
 }
 
 Move RPSGameManager::getLastPredictedHumanMove() const {
-    if (game && game->getComputerPlayer())
-        return game->getComputerPlayer()->getLastPredictedHumanMove();
-    return Move::ROCK;
+    return state.lastPredictedHumanMove;
 }
 
 bool RPSGameManager::isPredictionValid() const {
-    // If the current strategy is Smart, check its prediction validity.
-    if (game && game->getComputerPlayer()) {
-        auto *smart = dynamic_cast<SmartStrategy*>(game->getComputerPlayer()->getStrategy());
-        if (smart)
-            return smart->isPredictionValid();
-    }
-    return false;
+    return state.predictionValid;
 }
@@ -1,8 +1,13 @@
 #ifndef RPSGAMEMANAGER_H
 #define RPSGAMEMANAGER_H
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
 #include "Move.h"
 #include "HumanPlayer.h"
 #include "ComputerPlayer.h"
@@ -12,12 +17,31 @@ class RPSGameManager
 {
 public:
     RPSGameManager();
+    ~RPSGameManager();
 
     void setStrategy(int index);   // 0 = Random, 1 = Smart
     void setRounds(int r);
+    void setModelReload(int intervalMs);  // 0 = off; see SmartStrategy::setHotReload
     void startNewGame();
     void playRound(Move humanMove);
 
+    // Auto-play: start a new game whose human moves come from a script of
+    // R/P/S characters (see ScriptedPlayer) and play all of it on a worker
+    // thread, as fast as the engine goes. The rounds setting does not apply.
+    // Returns false if the file cannot be opened.
+    bool startAutoPlay(const std::string& scriptPath);
+    // Stop early; waits for the worker. The model is saved either way.
+    void stopAutoPlay();
+    bool isAutoPlaying() const;
+    // While auto-playing, the getters below only change here: this takes the
+    // latest state the worker published and asks it for a fresh one, so the
+    // worker copies its state once per call (once per frame) instead of once
+    // per round. Returns false once the script is done and the final state
+    // has been taken.
+    bool syncAutoPlay();
+    // Rounds per second of the current or last auto-play.
+    double getAutoPlayRate() const;
+
     // Getters for UI display
     int getCurrentRound() const;
     Move getLastComputerMove() const;
@@ -36,19 +60,47 @@ public:
     std::string getStrategyName() const;
 
 private:
+    // Everything the display shows about a game.
+    struct RoundState
+    {
+        int currentRound = 0;
+        int humanScore = 0;
+        int computerScore = 0;
+        int tieCount = 0;
+        Move lastComputerMove = Move::ROCK;
+        std::string_view lastRoundResult;  // one of playMove's literals
+        Move lastPredictedHumanMove = Move::ROCK;
+        bool predictionValid = false;
+    };
+
     int chosenStrategy;
     int totalRounds;
-    int currentRound;
-    int humanScore;
-    int computerScore;
-    int tieCount;
+    int reloadIntervalMs = 0;
 
-    Move lastComputerMove;
-    std::string lastRoundResult;
+    RoundState state;
+    std::string strategyName;
 
     std::unique_ptr<HumanPlayer> humanPlayer;
     std::unique_ptr<ComputerPlayer> computerPlayer;
     std::unique_ptr<Game> game;
+
+    // Auto-play. The worker owns the game until it has been joined; 'published'
+    // is its state as of the last request, guarded by publishMutex.
+    std::thread autoPlayThread;
+    std::atomic<bool> stopRequested{false};
+    std::atomic<bool> snapshotWanted{false};
+    std::atomic<bool> autoPlayDone{false};
+    std::mutex publishMutex;
+    RoundState published;
+    std::chrono::steady_clock::time_point autoPlayStart;
+    double autoPlayRate = 0;
+
+    // strategyLog: whether the strategy keeps its per-round log file, which
+    // auto-play, like scripted console games, does without.
+    void createGame(bool strategyLog);
+    void playMove(RoundState& round, Move humanMove);
+    void runAutoPlay(std::unique_ptr<std::istream> script);
+    void publish(const RoundState& round);
 };
 
 #endif // RPSGAMEMANAGER_H
@@ -1,10 +1,23 @@
 #include <QApplication>
+#include <QStringList>
 #include "mainwindow.h"
 
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
     MainWindow window;
+
+    // --reload-model MS: the smart strategy picks up new versions of freq.txt.
+    const QStringList args = app.arguments();
+    int reloadAt = args.indexOf("--reload-model");
+    if (reloadAt >= 0 && reloadAt + 1 < args.size())
+        window.setModelReload(args[reloadAt + 1].toInt());
+
+    // --auto-play FILE: play a script of R/P/S moves as soon as the window opens.
+    int autoPlayAt = args.indexOf("--auto-play");
+    if (autoPlayAt >= 0 && autoPlayAt + 1 < args.size())
+        window.startAutoPlay(args[autoPlayAt + 1]);
+
     window.show();
     return app.exec();
 }
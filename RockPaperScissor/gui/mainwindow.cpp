@@ -3,6 +3,8 @@
 #include <QFont>
 #include <QPalette>
 #include <QColor>
+#include <QFileDialog>
+#include <QScreen>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
@@ -45,6 +47,9 @@ MainWindow::MainWindow(QWidget *parent)
     startGameButton = new QPushButton("Start New Game");
     settingsLayout->addWidget(startGameButton);
 
+    autoPlayButton = new QPushButton("Auto Play...");
+    settingsLayout->addWidget(autoPlayButton);
+
     mainLayout->addLayout(settingsLayout);
 
     // --- Move Buttons Layout ---
@@ -134,6 +139,11 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::onRoundsChanged);
     connect(startGameButton, &QPushButton::clicked,
             this, &MainWindow::onStartGameClicked);
+    connect(autoPlayButton, &QPushButton::clicked,
+            this, &MainWindow::onAutoPlayClicked);
+
+    frameTimer = new QTimer(this);
+    connect(frameTimer, &QTimer::timeout, this, &MainWindow::onFrame);
 
     connect(rockButton, &QPushButton::clicked, this, &MainWindow::onMoveButtonClicked);
     connect(paperButton, &QPushButton::clicked, this, &MainWindow::onMoveButtonClicked);
@@ -145,6 +155,68 @@ MainWindow::MainWindow(QWidget *parent)
 MainWindow::~MainWindow()
 {
     // Qt automatically deletes child widgets
+    gameManager->stopAutoPlay();
+}
+
+void MainWindow::setModelReload(int intervalMs)
+{
+    gameManager->setModelReload(intervalMs);
+}
+
+void MainWindow::startAutoPlay(const QString &scriptPath)
+{
+    if (!gameManager->startAutoPlay(scriptPath.toStdString())) {
+        turnLabel->setText("Cannot open " + scriptPath);
+        return;
+    }
+    setAutoPlaying(true);
+    updateDisplay();
+}
+
+void MainWindow::onAutoPlayClicked()
+{
+    if (gameManager->isAutoPlaying()) {
+        gameManager->stopAutoPlay();
+        setAutoPlaying(false);
+        turnLabel->setText("Auto-play stopped");
+        updateDisplay();
+        return;
+    }
+    QString path = QFileDialog::getOpenFileName(this, "Auto-play script");
+    if (!path.isEmpty())
+        startAutoPlay(path);
+}
+
+void MainWindow::onFrame()
+{
+    // Rounds are played on the manager's worker; the labels are only
+    // rewritten here, once per frame, however many rounds went by.
+    bool running = gameManager->syncAutoPlay();
+    QString rate = QString::number(qRound64(gameManager->getAutoPlayRate()));
+    if (running) {
+        turnLabel->setText(QString("Auto-playing: %1 rounds/s").arg(rate));
+    } else {
+        setAutoPlaying(false);
+        turnLabel->setText(QString("Auto-play finished: %1 rounds/s").arg(rate));
+    }
+    updateDisplay();
+}
+
+void MainWindow::setAutoPlaying(bool on)
+{
+    strategyComboBox->setEnabled(!on);
+    roundsSpinBox->setEnabled(!on);
+    startGameButton->setEnabled(!on);
+    rockButton->setEnabled(!on);
+    paperButton->setEnabled(!on);
+    scissorsButton->setEnabled(!on);
+    autoPlayButton->setText(on ? "Stop Auto Play" : "Auto Play...");
+    if (on) {
+        qreal hz = screen() ? screen()->refreshRate() : 60.0;
+        frameTimer->start(qMax(1, qRound(1000.0 / (hz > 0 ? hz : 60.0))));
+    } else {
+        frameTimer->stop();
+    }
 }
 
 void MainWindow::onStrategyChanged(int index)
@@ -9,6 +9,7 @@
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QFont>
+#include <QTimer>
 #include <memory>
 #include "RPSGameManager.h"
 #include "Move.h"
@@ -21,11 +22,19 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Passed on to the game manager, see RPSGameManager::setModelReload.
+    void setModelReload(int intervalMs);
+
+    // Play a script of human moves at full speed, see RPSGameManager::startAutoPlay.
+    void startAutoPlay(const QString &scriptPath);
+
 private slots:
     void onStrategyChanged(int index);
     void onRoundsChanged(int value);
     void onStartGameClicked();
     void onMoveButtonClicked();
+    void onAutoPlayClicked();
+    void onFrame();
 
 private:
     // Central widget and main layouts
@@ -41,6 +50,7 @@ private:
     QComboBox   *strategyComboBox;
     QSpinBox    *roundsSpinBox;
     QPushButton *startGameButton;
+    QPushButton *autoPlayButton;
 
     // Move buttons
     QPushButton *rockButton;
@@ -64,7 +74,11 @@ private:
 
     std::unique_ptr<RPSGameManager> gameManager;
 
+    // Refreshes the display once per screen frame during auto-play.
+    QTimer *frameTimer;
+
     void updateDisplay();
+    void setAutoPlaying(bool on);
 };
 
 #endif // MAINWINDOW_H
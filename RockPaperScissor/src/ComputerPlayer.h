@@ -3,10 +3,31 @@
 
 #include "Player.h"
 #include "Strategy.h"
+#include "ContextTreeStrategy.h"
+#include "LongestMatchStrategy.h"
 #include "SmartStrategy.h"  // So we can use dynamic_cast
+#include <cstddef>
 #include <memory>
 #include <vector>
 
+// The human move 'strategy' predicted in its last makeMove, if it made a
+// prediction (Smart, ContextTree and LongestMatch only).
+inline bool strategyPrediction(const Strategy& strategy, Move& predicted) {
+    if (auto* smart = dynamic_cast<const SmartStrategy*>(&strategy)) {
+        predicted = smart->getLastPredictedHumanMove();
+        return smart->isPredictionValid();
+    }
+    if (auto* tree = dynamic_cast<const ContextTreeStrategy*>(&strategy)) {
+        predicted = tree->getLastPredictedHumanMove();
+        return tree->isPredictionValid();
+    }
+    if (auto* match = dynamic_cast<const LongestMatchStrategy*>(&strategy)) {
+        predicted = match->getLastPredictedHumanMove();
+        return match->isPredictionValid();
+    }
+    return false;
+}
+
 class ComputerPlayer : public Player {
 private:
     std::unique_ptr<Strategy> strategy;
@@ -23,6 +44,12 @@ public:
         history.emplace_back(playerMove, computerMove);
         strategy->updateFrequencies(history);
     }
+
+    // Room for 'rounds' rounds of history, so that recording them never
+    // reallocates it. Without this the history grows by doubling.
+    void reserveHistory(std::size_t rounds) {
+        history.reserve(rounds);
+    }
     
     void saveState() {
         strategy->saveState();
@@ -46,6 +73,12 @@ public:
         // For RandomStrategy or others, no prediction is available.
         return Move::ROCK; // or you might return a sentinel value if defined
     }
+
+    // The human move the strategy predicted in its last makeMove, if it made
+    // a prediction (Smart, ContextTree and LongestMatch only).
+    bool getPrediction(Move& predicted) const {
+        return strategyPrediction(*strategy, predicted);
+    }
 };
 
 #endif
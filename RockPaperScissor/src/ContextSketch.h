@@ -0,0 +1,170 @@
+#ifndef CONTEXT_SKETCH_H
+#define CONTEXT_SKETCH_H
+
+#include "Move.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Approximate move counts for long contexts, in a fixed amount of memory.
+//
+// The exact tables of FrequencyModel need one entry per context seen, and
+// there are 9^(N-1) possible contexts of sequence length N, so they stop at
+// short orders. This is a Count-Min sketch instead: 'depth' rows of 'width'
+// cells, each cell holding a counter per move. A context is hashed to one
+// cell per row; its estimated count for a move is the smallest of those
+// cells' counters. Different contexts share cells, so an estimate can be too
+// high but never too low, and update and query cost O(depth) whatever the
+// number of contexts.
+//
+// Updates are conservative: only the counters that equal the current
+// estimate are incremented, which leaves every estimate the same lower bound
+// and keeps the overestimates from collisions much smaller. Counters stop at
+// their maximum instead of being halved, since a cell is shared.
+//
+// Contexts are identified by a 64-bit hash of their rounds and length (see
+// hashContexts), so orders well beyond the 20 rounds a FrequencyModel key
+// holds can be counted.
+class ContextSketch {
+public:
+    using Counter = uint16_t;
+    static constexpr uint32_t COUNTER_MAX = std::numeric_limits<Counter>::max();
+    static constexpr int MOVES = ClassicRules::COUNT;
+
+private:
+    // Four counters per cell (one unused) keep a cell 8-byte aligned.
+    static constexpr std::size_t CELL_COUNTERS = 4;
+    static_assert(MOVES <= static_cast<int>(CELL_COUNTERS), "a cell holds one counter per move");
+
+    std::size_t width;  // cells per row, a power of two
+    int depth;
+    bool conservative;
+    std::vector<Counter> cells;
+
+    // Column of a context in each row, by double hashing.
+    void columns(uint64_t hash, std::size_t* out) const {
+        uint64_t step = (hash >> 32) | 1;
+        for (int row = 0; row < depth; ++row) {
+            out[row] = (static_cast<std::size_t>(row) * width + ((hash + row * step) & (width - 1))) * CELL_COUNTERS;
+        }
+    }
+
+public:
+    static constexpr int MAX_DEPTH = 8;
+
+    // A sketch of about 'bytes' bytes (rounded down to a power of two cells
+    // per row) with 'rows' hash rows.
+    explicit ContextSketch(std::size_t bytes = std::size_t(1) << 20, int rows = 4, bool conservativeUpdate = true)
+        : depth(std::clamp(rows, 1, MAX_DEPTH)), conservative(conservativeUpdate) {
+        std::size_t perRow = std::max<std::size_t>(bytes / (static_cast<std::size_t>(depth) * CELL_COUNTERS * sizeof(Counter)), 1);
+        width = 1;
+        while (width * 2 <= perRow) {
+            width *= 2;
+        }
+        cells.assign(width * static_cast<std::size_t>(depth) * CELL_COUNTERS, 0);
+    }
+
+    // Hash of every context that ends just before history[end]: out[k - 1]
+    // is the context of the k rounds history[end - k .. end - 1], as of
+    // sequence length k + 1, for k = 1 .. rounds. Contexts are built from
+    // the most recent round backwards, so all of them cost one pass.
+    static void hashContexts(const std::vector<std::pair<Move, Move>>& history, std::size_t end, int rounds,
+                             uint64_t* out) {
+        uint64_t state = 0x84222325cbf29ce4ULL;
+        for (int k = 1; k <= rounds; ++k) {
+            const auto& round = history[end - k];
+            state = (state ^ static_cast<uint64_t>(roundCode(round.first, round.second) + 1)) * 0x100000001b3ULL;
+            // The length is mixed in so contexts of different orders differ.
+            uint64_t x = state ^ (static_cast<uint64_t>(k) << 56);
+            x ^= x >> 33;
+            x *= 0xff51afd7ed558ccdULL;
+            x ^= x >> 33;
+            x *= 0xc4ceb9fe1a85ec53ULL;
+            out[k - 1] = x ^ (x >> 33);
+        }
+    }
+
+    // Start loading a context's cells. The cells of one context are in
+    // 'depth' different cache lines, so a caller about to touch many contexts
+    // prefetches them all first and lets the misses overlap.
+    void prefetch(uint64_t context) const {
+#if defined(__GNUC__) || defined(__clang__)
+        std::size_t at[MAX_DEPTH];
+        columns(context, at);
+        for (int row = 0; row < depth; ++row) {
+            __builtin_prefetch(&cells[at[row]]);
+        }
+#else
+        (void)context;
+#endif
+    }
+
+    void add(uint64_t context, Move move) {
+        std::size_t at[MAX_DEPTH];
+        columns(context, at);
+        int m = static_cast<int>(move);
+        if (!conservative) {
+            for (int row = 0; row < depth; ++row) {
+                Counter& counter = cells[at[row] + m];
+                if (counter < COUNTER_MAX) {
+                    counter++;
+                }
+            }
+            return;
+        }
+        Counter estimate = cells[at[0] + m];
+        for (int row = 1; row < depth; ++row) {
+            estimate = std::min(estimate, cells[at[row] + m]);
+        }
+        if (estimate == COUNTER_MAX) {
+            return;
+        }
+        // Branch-free: which rows are at the minimum is unpredictable.
+        for (int row = 0; row < depth; ++row) {
+            Counter& counter = cells[at[row] + m];
+            counter = static_cast<Counter>(counter + (counter == estimate));
+        }
+    }
+
+    // Estimated counts of the three moves after a context. Returns false
+    // when all three are zero, i.e. the context was certainly never seen.
+    bool estimate(uint64_t context, uint32_t counts[MOVES]) const {
+        std::size_t at[MAX_DEPTH];
+        columns(context, at);
+        bool seen = false;
+        for (int m = 0; m < MOVES; ++m) {
+            Counter value = cells[at[0] + m];
+            for (int row = 1; row < depth; ++row) {
+                value = std::min(value, cells[at[row] + m]);
+            }
+            counts[m] = value;
+            seen = seen || value != 0;
+        }
+        return seen;
+    }
+
+    void clear() {
+        std::fill(cells.begin(), cells.end(), 0);
+    }
+
+    std::size_t getWidth() const {
+        return width;
+    }
+
+    int getDepth() const {
+        return depth;
+    }
+
+    bool isConservative() const {
+        return conservative;
+    }
+
+    std::size_t memoryUsage() const {
+        return cells.size() * sizeof(Counter);
+    }
+};
+
+#endif
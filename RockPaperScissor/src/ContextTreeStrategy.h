@@ -0,0 +1,239 @@
+#ifndef CONTEXT_TREE_STRATEGY_H
+#define CONTEXT_TREE_STRATEGY_H
+
+#include "Strategy.h"
+#include <vector>
+#include <string>
+#include <random>
+#include <ctime>
+#include <cstdint>
+#include <cstddef>
+
+// Variable-order context-tree (PPM-style) strategy.
+//
+// SmartStrategy keeps one table per sequence length, so the keys of the
+// longer tables repeat the shorter ones. Here all contexts live in a single
+// trie keyed backwards from the most recent round: the node at depth d holds
+// the counts of the human moves that followed the last d rounds (sequence
+// length N = d + 1). Shared suffixes are stored once, and one walk from the
+// root yields the counts for every order at once, for both prediction and
+// update, so the maximum order can go well beyond 7.
+//
+// With the Sum blend and orders 3..7 the predictions match SmartStrategy on a
+// fresh model. The tree is kept in memory for the session only.
+//
+// The tree works for any move set; ContextTreeStrategy is the one the game
+// plays Rock-Paper-Scissors with.
+template <typename MoveSet>
+class BasicContextTreeStrategy : public BasicStrategy<MoveSet> {
+public:
+    using Rules = MoveRules<MoveSet>;
+    using Move = typename Rules::Move;
+    static constexpr int MOVES = Rules::COUNT;
+
+    enum class Blend {
+        Sum,     // add the counts of every matching order, as SmartStrategy does
+        Longest  // predict from the deepest context that has data (PPM-style)
+    };
+
+private:
+    // Children are kept as a sibling list: most contexts have only a few
+    // continuations, so this is far smaller than a ROUND_CODES-way child array.
+    struct Node {
+        int32_t counts[MOVES] = {};
+        int32_t firstChild = -1;
+        int32_t nextSibling = -1;
+        uint8_t code = 0;  // roundCode() of the round this node adds to its parent's context
+    };
+
+    std::vector<Node> nodes;
+    int minOrder;
+    int maxOrder;
+    Blend blend = Blend::Sum;
+    std::mt19937 rng;
+
+    bool predictionValid = false;
+    Move lastPredictedHumanMove = Move::ROCK;
+
+    int findChild(int parent, int code) const {
+        for (int child = nodes[parent].firstChild; child != -1; child = nodes[child].nextSibling) {
+            if (nodes[child].code == code) {
+                return child;
+            }
+        }
+        return -1;
+    }
+
+    int findOrAddChild(int parent, int code) {
+        int child = findChild(parent, code);
+        if (child != -1) {
+            return child;
+        }
+        Node node;
+        node.code = static_cast<uint8_t>(code);
+        node.nextSibling = nodes[parent].firstChild;
+        nodes.push_back(node);
+        child = static_cast<int>(nodes.size()) - 1;
+        nodes[parent].firstChild = child;
+        return child;
+    }
+
+    Move randomMove() {
+        return static_cast<Move>(std::uniform_int_distribution<int>(0, MOVES - 1)(rng));
+    }
+
+    static int64_t total(const int32_t counts[MOVES]) {
+        int64_t sum = 0;
+        for (int m = 0; m < MOVES; ++m) {
+            sum += counts[m];
+        }
+        return sum;
+    }
+
+public:
+    BasicContextTreeStrategy() : BasicContextTreeStrategy(static_cast<unsigned int>(std::time(nullptr))) {}
+
+    // Orders are sequence lengths N (context of N-1 rounds), as in SmartStrategy.
+    explicit BasicContextTreeStrategy(unsigned int seed, int minSeqLen = 3, int maxSeqLen = 16)
+        : minOrder(minSeqLen < 1 ? 1 : minSeqLen),
+          maxOrder(maxSeqLen < minSeqLen ? minSeqLen : maxSeqLen),
+          rng(seed) {
+        nodes.emplace_back();  // root: the empty context (N = 1)
+    }
+
+    void setBlend(Blend b) {
+        blend = b;
+    }
+
+    Move makeMove(const std::vector<std::pair<Move, Move>>& history) override {
+        int64_t sums[MOVES] = {};
+        bool anyData = false;
+
+        // Walk back from the most recent round; depth d is sequence length d + 1.
+        int node = 0;
+        size_t n = history.size();
+        for (int depth = 0; depth < maxOrder; ++depth) {
+            if (depth > 0) {
+                if (static_cast<size_t>(depth) > n) break;
+                const auto& round = history[n - depth];
+                node = findChild(node, Rules::roundCode(round.first, round.second));
+                if (node == -1) break;
+            }
+            if (depth + 1 < minOrder) continue;
+            const Node& ctx = nodes[node];
+            if (total(ctx.counts) == 0) continue;
+            if (blend == Blend::Longest) {
+                for (int64_t& sum : sums) sum = 0;
+            }
+            for (int m = 0; m < MOVES; ++m) {
+                sums[m] += ctx.counts[m];
+            }
+            anyData = true;
+        }
+
+        predictionValid = anyData;
+        if (!anyData) {
+            // Same fallbacks as SmartStrategy: a plain random move until the
+            // shortest order has enough history, then the counter to a random guess.
+            if (n + 1 < static_cast<size_t>(minOrder)) {
+                return randomMove();
+            }
+            lastPredictedHumanMove = randomMove();
+            return Rules::counter(lastPredictedHumanMove);
+        }
+
+        int best = 0;
+        for (int m = 1; m < MOVES; ++m) {
+            if (sums[m] > sums[best]) best = m;
+        }
+        lastPredictedHumanMove = static_cast<Move>(best);
+        return Rules::counter(lastPredictedHumanMove);
+    }
+
+    void updateFrequencies(const std::vector<std::pair<Move, Move>>& history) override {
+        if (history.empty()) {
+            return;
+        }
+        // The contexts that preceded the human's latest move, all in one walk.
+        int move = static_cast<int>(history.back().first);
+        size_t n = history.size() - 1;  // rounds before the latest one
+        int node = 0;
+        for (int depth = 0; depth < maxOrder; ++depth) {
+            if (depth > 0) {
+                if (static_cast<size_t>(depth) > n) break;
+                const auto& round = history[n - depth];
+                node = findOrAddChild(node, Rules::roundCode(round.first, round.second));
+            }
+            if (depth + 1 >= minOrder) {
+                nodes[node].counts[move]++;
+            }
+        }
+    }
+
+    void saveState() override {
+        // The context tree is rebuilt every session; nothing to save.
+    }
+
+    void loadState() override {
+        // Nothing to load, see saveState().
+    }
+
+    std::string getName() const override {
+        return "ContextTree";
+    }
+
+    Move getLastPredictedHumanMove() const {
+        return lastPredictedHumanMove;
+    }
+
+    bool isPredictionValid() const {
+        return predictionValid;
+    }
+
+    size_t getNodeCount() const {
+        return nodes.size();
+    }
+
+    // Bytes held by the tree (node storage including spare capacity).
+    size_t getMemoryUsage() const {
+        return nodes.capacity() * sizeof(Node);
+    }
+
+    int getMaxOrder() const {
+        return maxOrder;
+    }
+
+    // Counts stored for one context, given its round codes from the most
+    // recent round backwards, or null if the tree has no such context.
+    const int32_t* findContextCounts(const std::vector<int>& codesNewestFirst) const {
+        int node = 0;
+        for (int code : codesNewestFirst) {
+            node = findChild(node, code);
+            if (node == -1) return nullptr;
+        }
+        return nodes[node].counts;
+    }
+
+    // Sum of every counter stored for one sequence length.
+    int64_t totalCount(int seqLen) const {
+        int64_t sum = 0;
+        std::vector<int> level = {0};
+        for (int depth = 0; depth < seqLen - 1 && !level.empty(); ++depth) {
+            std::vector<int> next;
+            for (int node : level) {
+                for (int child = nodes[node].firstChild; child != -1; child = nodes[child].nextSibling) {
+                    next.push_back(child);
+                }
+            }
+            level.swap(next);
+        }
+        for (int node : level) {
+            sum += total(nodes[node].counts);
+        }
+        return sum;
+    }
+};
+
+using ContextTreeStrategy = BasicContextTreeStrategy<RockPaperScissors>;
+
+#endif
@@ -0,0 +1,382 @@
+#ifndef FREQUENCY_FILE_READER_H
+#define FREQUENCY_FILE_READER_H
+
+#include "FrequencyModel.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Loader for the model files written by FrequencyFileWriter: the freq.txt
+// text format and the compact binary format, told apart by the compact
+// format's magic bytes.
+//
+// The whole file is read into one buffer and parsed in place with
+// std::from_chars; no per-line strings or streams are created. A first pass
+// finds the blocks (one per sequence length), sizes each table for the
+// entry count its block declares, and then the blocks are parsed in parallel
+// (every sequence length has its own table, so the threads never share one).
+// Small files are parsed on the calling thread.
+//
+// Both formats hold Rock-Paper-Scissors models: keys are base-9 rounds and
+// every context has up to MOVES (three) counts. Loading a model of another
+// move set does not compile.
+class FrequencyFileReader {
+public:
+    static constexpr int MOVES = ClassicRules::COUNT;
+
+    enum class Status {
+        Ok,
+        NotFound,  // the file could not be opened
+        Invalid    // no block count before the end of the file, or a damaged compact file
+    };
+
+    // Start of a compact model file: "RPSF" and the format version.
+    static constexpr char COMPACT_MAGIC[5] = {'R', 'P', 'S', 'F', 1};
+
+private:
+    // Files smaller than this are not worth starting threads for.
+    static constexpr std::size_t PARALLEL_MIN_BYTES = 256 * 1024;
+
+    struct Block {
+        int seqLen;
+        const char* begin;  // first line after the entry count
+        const char* end;    // start of the next block header, or end of file
+        std::size_t entries;
+    };
+
+    // Line-by-line view of a buffer range. Lines exclude the '\n'.
+    class LineCursor {
+    private:
+        const char* pos;
+        const char* end;
+
+    public:
+        LineCursor(const char* begin, const char* finish) : pos(begin), end(finish) {}
+
+        const char* position() const {
+            return pos;
+        }
+
+        bool nextLine(std::string_view& line) {
+            if (pos >= end) {
+                return false;
+            }
+            const char* newline = static_cast<const char*>(std::char_traits<char>::find(pos, end - pos, '\n'));
+            const char* lineEnd = newline ? newline : end;
+            line = std::string_view(pos, static_cast<std::size_t>(lineEnd - pos));
+            pos = newline ? newline + 1 : end;
+            return true;
+        }
+
+        // Next line that is neither empty nor a '#' comment.
+        bool nextDataLine(std::string_view& line) {
+            while (nextLine(line)) {
+                if (!line.empty() && line[0] != '#') {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    static void skipSpaces(const char*& pos, const char* end) {
+        while (pos < end && isSpace(*pos)) ++pos;
+    }
+
+    // Whitespace-separated integer, as 'istream >> int' reads it.
+    template <typename Int>
+    static bool readInt(const char*& pos, const char* end, Int& value) {
+        skipSpaces(pos, end);
+        auto result = std::from_chars(pos, end, value);
+        if (result.ec != std::errc()) {
+            return false;
+        }
+        pos = result.ptr;
+        return true;
+    }
+
+    static std::string_view readToken(const char*& pos, const char* end) {
+        skipSpaces(pos, end);
+        const char* start = pos;
+        while (pos < end && !isSpace(*pos)) ++pos;
+        return std::string_view(start, static_cast<std::size_t>(pos - start));
+    }
+
+    // "# Sequence length: N" header; seqLen is 0 when N does not parse.
+    static bool isBlockHeader(std::string_view line, int& seqLen) {
+        if (line.empty() || line[0] != '#') {
+            return false;
+        }
+        std::size_t marker = line.find("Sequence length:");
+        if (marker == std::string_view::npos) {
+            return false;
+        }
+        const char* pos = line.data() + line.find(':') + 1;
+        seqLen = 0;
+        if (!readInt(pos, line.data() + line.size(), seqLen)) {
+            seqLen = 0;
+        }
+        return true;
+    }
+
+    template <typename Model>
+    static void parseBlock(const Block& block, Model& model) {
+        static_assert(Model::MOVES == MOVES, "model files hold Rock-Paper-Scissors models only");
+        LineCursor cursor(block.begin, block.end);
+        std::string_view line;
+        for (std::size_t i = 0; i < block.entries; ++i) {
+            if (!cursor.nextDataLine(line)) {
+                return;
+            }
+            const char* pos = line.data();
+            const char* lineEnd = pos + line.size();
+            std::string_view keyText = readToken(pos, lineEnd);
+            int numMoves = 0;
+            if (!readInt(pos, lineEnd, numMoves)) {
+                numMoves = 0;
+            }
+            uint64_t key = 0;
+            bool validKey = Model::parseKey(keyText.data(), keyText.size(), block.seqLen - 1, key);
+            int64_t counts[MOVES] = {};
+            uint8_t moves = 0;
+            for (int j = 0; j < numMoves; ++j) {
+                if (!cursor.nextDataLine(line)) {
+                    break;
+                }
+                pos = line.data();
+                lineEnd = pos + line.size();
+                int moveInt = 0;
+                int64_t freq = 0;
+                if (validKey && readInt(pos, lineEnd, moveInt) && readInt(pos, lineEnd, freq) &&
+                    moveInt >= 0 && moveInt < MOVES) {
+                    counts[moveInt] = freq;
+                    moves |= static_cast<uint8_t>(1 << moveInt);
+                }
+            }
+            if (validKey) {
+                model.setCounts(block.seqLen, key, counts, moves);
+            }
+        }
+    }
+
+    // LEB128 unsigned varint, as written by FrequencyFileWriter.
+    static bool readVarint(const char*& pos, const char* end, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+            uint8_t byte = static_cast<uint8_t>(*pos++);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Contexts of a compact block: key delta from the previous key, move mask,
+    // then one count per move in the mask.
+    template <typename Model>
+    static bool parseCompactBlock(const Block& block, Model& model) {
+        static_assert(Model::MOVES == MOVES, "model files hold Rock-Paper-Scissors models only");
+        const char* pos = block.begin;
+        uint64_t key = 0;
+        for (std::size_t i = 0; i < block.entries; ++i) {
+            uint64_t delta = 0;
+            if (!readVarint(pos, block.end, delta) || pos >= block.end) {
+                return false;
+            }
+            key += delta;
+            uint8_t moves = static_cast<uint8_t>(*pos++);
+            if (moves >> MOVES) {
+                return false;
+            }
+            int64_t counts[MOVES] = {};
+            for (int m = 0; m < MOVES; ++m) {
+                uint64_t count = 0;
+                if ((moves & (1 << m)) && !readVarint(pos, block.end, count)) {
+                    return false;
+                }
+                counts[m] = static_cast<int64_t>(std::min<uint64_t>(count, INT64_MAX));
+            }
+            model.setCounts(block.seqLen, key, counts, moves);
+        }
+        return pos == block.end;
+    }
+
+    // Block list of a compact file; false if the file is damaged.
+    template <typename Model>
+    static bool findCompactBlocks(const char* data, std::size_t size, std::vector<Block>& blocks) {
+        const char* end = data + size;
+        const char* pos = data + sizeof(COMPACT_MAGIC);
+        uint64_t numBlocks = 0;
+        if (!readVarint(pos, end, numBlocks)) {
+            return false;
+        }
+        for (uint64_t b = 0; b < numBlocks; ++b) {
+            uint64_t seqLen = 0;
+            uint64_t entries = 0;
+            uint64_t length = 0;
+            if (!readVarint(pos, end, seqLen) || !readVarint(pos, end, entries) || !readVarint(pos, end, length) ||
+                length > static_cast<uint64_t>(end - pos) || !Model::isValidSeqLen(static_cast<int>(seqLen)) ||
+                entries > length / 2) {
+                return false;
+            }
+            blocks.push_back({static_cast<int>(seqLen), pos, pos + length, static_cast<std::size_t>(entries)});
+            pos += length;
+        }
+        return true;
+    }
+
+    // Block list of a text file.
+    template <typename Model>
+    static bool findTextBlocks(const char* data, std::size_t size, std::vector<Block>& blocks) {
+        const char* end = data + size;
+        LineCursor cursor(data, end);
+        std::string_view line;
+
+        // Block count: the first line that is not a comment.
+        if (!cursor.nextDataLine(line)) {
+            return false;
+        }
+        const char* pos = line.data();
+        int numBlocks = 0;
+        if (!readInt(pos, line.data() + line.size(), numBlocks)) {
+            numBlocks = 0;
+        }
+
+        // Locate the first numBlocks headers and read each block's entry count.
+        int headersSeen = 0;
+        int seqLen = 0;
+        while (headersSeen < numBlocks && cursor.nextLine(line)) {
+            if (!isBlockHeader(line, seqLen)) {
+                continue;
+            }
+            if (!blocks.empty() && blocks.back().end == end) {
+                blocks.back().end = line.data();
+            }
+            ++headersSeen;
+            if (!Model::isValidSeqLen(seqLen)) {
+                continue;
+            }
+            Block block{seqLen, cursor.position(), end, 0};
+            LineCursor countCursor(block.begin, end);
+            std::string_view countLine;
+            if (countCursor.nextDataLine(countLine)) {
+                const char* countPos = countLine.data();
+                long long entries = 0;
+                if (readInt(countPos, countLine.data() + countLine.size(), entries) && entries > 0) {
+                    block.entries = static_cast<std::size_t>(entries);
+                }
+                block.begin = countCursor.position();
+            }
+            blocks.push_back(block);
+        }
+        // The last block ends at the next header, even one past numBlocks.
+        if (!blocks.empty() && blocks.back().end == end) {
+            while (cursor.nextLine(line)) {
+                if (isBlockHeader(line, seqLen)) {
+                    blocks.back().end = line.data();
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+
+public:
+    static bool isCompact(const char* data, std::size_t size) {
+        return size >= sizeof(COMPACT_MAGIC) &&
+               std::char_traits<char>::compare(data, COMPACT_MAGIC, sizeof(COMPACT_MAGIC)) == 0;
+    }
+
+    // Parse a complete model file image into 'model' (which should be empty).
+    // maxThreads == 0 uses every hardware thread.
+    template <typename Model>
+    static Status parse(const char* data, std::size_t size, Model& model, unsigned int maxThreads = 0) {
+        const bool compact = isCompact(data, size);
+        std::vector<Block> blocks;
+        if (!(compact ? findCompactBlocks<Model>(data, size, blocks) : findTextBlocks<Model>(data, size, blocks))) {
+            return Status::Invalid;
+        }
+        if (blocks.empty()) {
+            return Status::Ok;
+        }
+
+        // Blocks that repeat a sequence length are parsed in file order by
+        // the same worker. Each table is sized up front (an entry takes at
+        // least two bytes in either format, which bounds the reservation for
+        // damaged counts).
+        std::vector<std::vector<const Block*>> groups(Model::MAX_SEQ_LEN + 1);
+        std::vector<std::size_t> declared(Model::MAX_SEQ_LEN + 1, 0);
+        for (const Block& block : blocks) {
+            groups[block.seqLen].push_back(&block);
+            std::size_t bound = static_cast<std::size_t>(block.end - block.begin) / 2;
+            declared[block.seqLen] += std::min(block.entries, bound);
+        }
+        std::vector<int> lengths;
+        for (int n = 0; n <= Model::MAX_SEQ_LEN; ++n) {
+            if (!groups[n].empty()) {
+                model.reserve(n, declared[n]);
+                lengths.push_back(n);
+            }
+        }
+
+        std::atomic<std::size_t> nextGroup{0};
+        std::atomic<bool> damaged{false};
+        auto worker = [&]() {
+            std::size_t g;
+            while ((g = nextGroup.fetch_add(1)) < lengths.size()) {
+                for (const Block* block : groups[lengths[g]]) {
+                    if (!compact) {
+                        parseBlock(*block, model);
+                    } else if (!parseCompactBlock(*block, model)) {
+                        damaged = true;
+                    }
+                }
+            }
+        };
+
+        unsigned int threads = maxThreads > 0 ? maxThreads : std::thread::hardware_concurrency();
+        threads = std::max(1u, std::min(threads, static_cast<unsigned int>(lengths.size())));
+        if (size < PARALLEL_MIN_BYTES) {
+            threads = 1;
+        }
+        std::vector<std::thread> helpers;
+        for (unsigned int t = 1; t < threads; ++t) {
+            helpers.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& helper : helpers) {
+            helper.join();
+        }
+        return damaged ? Status::Invalid : Status::Ok;
+    }
+
+    template <typename Model>
+    static Status load(const std::string& path, Model& model, unsigned int maxThreads = 0) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            return Status::NotFound;
+        }
+        file.seekg(0, std::ios::end);
+        std::streamoff length = file.tellg();
+        file.seekg(0, std::ios::beg);
+        std::string buffer(length > 0 ? static_cast<std::size_t>(length) : 0, '\0');
+        if (!buffer.empty() && !file.read(&buffer[0], static_cast<std::streamsize>(buffer.size()))) {
+            return Status::Invalid;
+        }
+        return parse(buffer.data(), buffer.size(), model, maxThreads);
+    }
+};
+
+#endif
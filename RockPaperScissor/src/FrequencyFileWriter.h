@@ -0,0 +1,157 @@
+#ifndef FREQUENCY_FILE_WRITER_H
+#define FREQUENCY_FILE_WRITER_H
+
+#include "FrequencyFileReader.h"
+#include "FrequencyModel.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <process.h>
+#endif
+
+enum class ModelFileFormat {
+    Text,    // the human-readable freq.txt format
+    Compact  // binary: varint key deltas and counts, a few bytes per context
+};
+
+// Writer for the model files read by FrequencyFileReader. Works on a
+// FrequencyModel or on a FrequencyModel::Snapshot, of any counter width.
+//
+// The file is written next to its destination and renamed over it when
+// complete, so a reader (or a crash) never sees a half-written model. The
+// temporary name carries the process and thread, so writers that do not
+// share a lock (a plain save, a profile, an rps_core session) never write
+// into the same temporary file.
+// Like the reader, it writes Rock-Paper-Scissors models only.
+class FrequencyFileWriter {
+private:
+    static constexpr int MOVES = FrequencyFileReader::MOVES;
+
+    static std::string tempPathFor(const std::string& path) {
+#if defined(__unix__) || defined(__APPLE__)
+        unsigned long processId = static_cast<unsigned long>(::getpid());
+#elif defined(_WIN32)
+        unsigned long processId = static_cast<unsigned long>(::_getpid());
+#else
+        unsigned long processId = 0;
+#endif
+        // A thread writes one file at a time, so its id is enough within a process.
+        std::size_t threadId = std::hash<std::thread::id>()(std::this_thread::get_id());
+        return path + ".tmp." + std::to_string(processId) + "." + std::to_string(threadId);
+    }
+
+    static void putVarint(std::string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    template <typename Model>
+    static void writeText(const Model& model, std::ofstream& file) {
+        static_assert(Model::MOVES == MOVES, "model files hold Rock-Paper-Scissors models only");
+        // Write a legend
+        file << "# Legend:" << '\n';
+        file << "# Each block corresponds to a sequence length (N) frequency table." << '\n';
+        file << "# For a given sequence length N, keys are constructed from the last (N-1) rounds," << '\n';
+        file << "# and the following lines show the frequencies for each human move that followed that sequence." << '\n';
+        file << '\n';
+
+        // Write frequency data for each sequence length
+        std::vector<int> lengths = model.seqLengths();
+        file << lengths.size() << '\n';
+        for (int seqLen : lengths) {
+            file << "# Sequence length: " << seqLen << '\n';
+            file << model.contextCount(seqLen) << '\n';
+            for (const auto* entry : model.sortedContexts(seqLen)) {
+                int numMoves = 0;
+                for (int m = 0; m < MOVES; ++m) {
+                    numMoves += (entry->mask >> m) & 1;
+                }
+                file << FrequencyModel::keyToString(entry->key(), seqLen - 1) << " " << numMoves
+                     << " # Key for N=" << seqLen << '\n';
+                for (int m = 0; m < MOVES; ++m) {
+                    if (!(entry->mask & (1 << m))) continue;
+                    file << m << " " << static_cast<int64_t>(entry->counts[m]) << " # "
+                         << RockPaperScissors::LETTERS[m] << '\n';
+                }
+            }
+        }
+    }
+
+    // Magic, block count, then per block: sequence length, context count,
+    // byte length and the contexts in key order (see FrequencyFileReader).
+    template <typename Model>
+    static void writeCompact(const Model& model, std::ofstream& file) {
+        static_assert(Model::MOVES == MOVES, "model files hold Rock-Paper-Scissors models only");
+        std::string out(FrequencyFileReader::COMPACT_MAGIC, sizeof(FrequencyFileReader::COMPACT_MAGIC));
+        std::vector<int> lengths = model.seqLengths();
+        putVarint(out, lengths.size());
+        std::string block;
+        for (int seqLen : lengths) {
+            block.clear();
+            auto contexts = model.sortedContexts(seqLen);
+            uint64_t previousKey = 0;
+            for (const auto* entry : contexts) {
+                putVarint(block, entry->key() - previousKey);
+                previousKey = entry->key();
+                block.push_back(static_cast<char>(entry->mask));
+                for (int m = 0; m < MOVES; ++m) {
+                    if (entry->mask & (1 << m)) {
+                        putVarint(block, static_cast<uint64_t>(entry->counts[m]));
+                    }
+                }
+            }
+            putVarint(out, static_cast<uint64_t>(seqLen));
+            putVarint(out, contexts.size());
+            putVarint(out, block.size());
+            out += block;
+        }
+        file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    }
+
+public:
+    template <typename Model>
+    static bool write(const Model& model, const std::string& path, ModelFileFormat format = ModelFileFormat::Text) {
+        const std::string tempPath = tempPathFor(path);
+        std::ofstream file(tempPath, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open file for saving strategy data." << std::endl;
+            return false;
+        }
+        if (format == ModelFileFormat::Compact) {
+            writeCompact(model, file);
+        } else {
+            writeText(model, file);
+        }
+
+        file.close();
+        if (file.fail()) {
+            std::cerr << "Failed to write strategy data to " << tempPath << std::endl;
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        // std::rename does not replace an existing file everywhere.
+        if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+            std::remove(path.c_str());
+            if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+                std::cerr << "Failed to replace " << path << std::endl;
+                std::remove(tempPath.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,569 @@
+#ifndef FREQUENCY_MODEL_H
+#define FREQUENCY_MODEL_H
+
+#include "Move.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Frequency tables used by SmartStrategy, one per sequence length N.
+//
+// A context is the (N-1) rounds that preceded a human move. Each round is a
+// roundCode() in 0..8, and the context key is those codes read as a base-9
+// number with the oldest round most significant, so sorting keys numerically
+// gives the same order as sorting the digit strings written to freq.txt.
+// For another move set the radix, the counters per context and the longest
+// key are those of its MoveRules.
+//
+// Contexts are never freed individually. Each table bump-allocates them from
+// its own slab arena (chunks that never move) and finds them through an
+// open-addressing index of context ids. A new context costs no allocation
+// unless a chunk fills up, loading a model is a sequence of bump allocations,
+// the contexts of one table sit next to each other in memory, and tearing a
+// model down frees a handful of chunks instead of one node per context.
+//
+// Counters are CounterT wide and saturating: when the counter about to be
+// incremented is at its maximum, all counters of the context are
+// halved first, which keeps their ratios (and so the predicted move) while
+// old observations slowly lose weight. FrequencyModel, the model the game
+// uses, has 16-bit counters; the 8- and 32-bit variants are there to
+// measure the trade-off (rps_bench counters).
+//
+// Each context also caches its most frequent move. An increment only moves
+// it when the incremented counter overtakes it, so reading a context's
+// prediction is one load rather than a comparison of three counters.
+template <typename CounterT, typename MoveSet = RockPaperScissors>
+class BasicFrequencyModel {
+public:
+    using Rules = MoveRules<MoveSet>;
+    using Move = typename Rules::Move;
+    static constexpr int MOVES = Rules::COUNT;
+
+    // Keys of up to 20 rounds fit in 64 bits (9^20 < 2^64).
+    static constexpr int MAX_SEQ_LEN = Rules::MAX_KEY_ROUNDS + 1;
+
+    static_assert(MOVES <= 8, "move masks are one byte");
+    static_assert(MOVES <= 10, "freq.txt writes one digit per move");
+
+    using Counter = CounterT;
+    static constexpr int64_t COUNTER_MAX = std::numeric_limits<CounterT>::max();
+
+    // The key is stored as two 32-bit halves so the struct only needs 4-byte
+    // alignment: 12 bytes with 8-bit counters, 16 with 16-bit, 24 with 32-bit.
+    struct Context {
+        uint32_t keyLow;
+        uint32_t keyHigh;
+        CounterT counts[MOVES];              // indexed by Move
+        uint8_t mask : Rules::MASK_BITS;     // bit m set when move m has an entry (even with count 0)
+        uint8_t best : Rules::MOVE_BITS;     // largestCounter(counts), shares mask's byte
+
+        uint64_t key() const {
+            return (static_cast<uint64_t>(keyHigh) << 32) | keyLow;
+        }
+
+        // Most frequent move; ties go to the lowest move, and a context
+        // without counts predicts Rock.
+        Move bestMove() const {
+            return static_cast<Move>(best);
+        }
+    };
+
+    // Index of the largest counter, the lowest index on a tie.
+    static uint8_t largestCounter(const CounterT counts[MOVES]) {
+        uint8_t largest = 0;
+        for (uint8_t m = 1; m < MOVES; ++m) {
+            if (counts[m] > counts[largest]) {
+                largest = m;
+            }
+        }
+        return largest;
+    }
+
+private:
+    static constexpr std::size_t CHUNK_BITS = 10;
+    static constexpr std::size_t CHUNK_SIZE = std::size_t(1) << CHUNK_BITS;
+    static constexpr std::size_t FIRST_CHUNK_SIZE = 32;
+    static constexpr uint32_t EMPTY_SLOT = 0;
+
+    // Slab arena of Contexts. Ids are stable; storage is released all at once.
+    // The first chunk starts at FIRST_CHUNK_SIZE contexts and is regrown by
+    // doubling until it reaches CHUNK_SIZE, so a small model (one player's
+    // profile, say) stays small; every later chunk is full size.
+    // Chunks are reference counted so snapshots can share them; once a
+    // snapshot has been taken, a chunk is copied before its first write while
+    // a snapshot still holds it (copy-on-write).
+    class ContextArena {
+    private:
+        std::vector<std::shared_ptr<Context[]>> chunks;
+        std::size_t used = 0;
+        std::size_t capacity = 0;
+        bool shared = false;  // set once a snapshot has referenced the chunks
+
+        std::size_t chunkCapacity(std::size_t chunkIndex) const {
+            return chunkIndex == 0 ? std::min(capacity, CHUNK_SIZE) : CHUNK_SIZE;
+        }
+
+        // Copy a chunk into a new block of newCapacity contexts.
+        void replaceChunk(std::size_t chunkIndex, std::size_t newCapacity) {
+            std::shared_ptr<Context[]>& chunk = chunks[chunkIndex];
+            std::shared_ptr<Context[]> copy(new Context[newCapacity]);
+            std::copy(chunk.get(), chunk.get() + chunkCapacity(chunkIndex), copy.get());
+            chunk = std::move(copy);
+        }
+
+        Context* writableChunk(std::size_t chunkIndex) {
+            std::shared_ptr<Context[]>& chunk = chunks[chunkIndex];
+            if (shared) {
+                if (chunk.use_count() != 1) {
+                    replaceChunk(chunkIndex, chunkCapacity(chunkIndex));
+                } else {
+                    // Pairs with the release of the last snapshot reference.
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                }
+            }
+            return chunk.get();
+        }
+
+    public:
+        uint32_t allocate(uint64_t key) {
+            if (used == capacity) {
+                if (capacity == 0) {
+                    chunks.emplace_back(new Context[FIRST_CHUNK_SIZE]);
+                    capacity = FIRST_CHUNK_SIZE;
+                } else if (capacity < CHUNK_SIZE) {
+                    replaceChunk(0, capacity * 2);
+                    capacity *= 2;
+                } else {
+                    chunks.emplace_back(new Context[CHUNK_SIZE]);
+                    capacity += CHUNK_SIZE;
+                }
+            }
+            Context& context = writable(static_cast<uint32_t>(used));
+            context.keyLow = static_cast<uint32_t>(key);
+            context.keyHigh = static_cast<uint32_t>(key >> 32);
+            for (CounterT& count : context.counts) {
+                count = 0;
+            }
+            context.mask = 0;
+            context.best = 0;
+            return static_cast<uint32_t>(used++);
+        }
+
+        void reserve(std::size_t count) {
+            chunks.reserve((count + CHUNK_SIZE - 1) >> CHUNK_BITS);
+        }
+
+        // Mutable access; copies the chunk first if a snapshot shares it.
+        Context& writable(uint32_t id) {
+            return writableChunk(id >> CHUNK_BITS)[id & (CHUNK_SIZE - 1)];
+        }
+
+        const Context& operator[](uint32_t id) const {
+            return chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)];
+        }
+
+        std::size_t size() const {
+            return used;
+        }
+
+        std::size_t bytes() const {
+            return capacity * sizeof(Context) + chunks.capacity() * sizeof(chunks[0]);
+        }
+
+        std::vector<std::shared_ptr<const Context[]>> share() {
+            shared = true;
+            return std::vector<std::shared_ptr<const Context[]>>(chunks.begin(), chunks.end());
+        }
+
+        // A second arena over the same chunks; both copy a chunk before their
+        // first write to it while the other still holds it.
+        ContextArena fork() {
+            shared = true;
+            ContextArena copy;
+            copy.chunks = chunks;
+            copy.used = used;
+            copy.capacity = capacity;
+            copy.shared = true;
+            return copy;
+        }
+    };
+
+    struct Table {
+        ContextArena arena;
+        std::vector<uint32_t> index;  // context id + 1, or EMPTY_SLOT
+        std::size_t mask = 0;
+    };
+
+    // Indexed by sequence length; null until the first context of that length.
+    std::vector<std::unique_ptr<Table>> tables;
+
+    static std::size_t hashKey(uint64_t key) {
+        key ^= key >> 29;
+        key *= 0xbf58476d1ce4e5b9ULL;
+        key ^= key >> 32;
+        return static_cast<std::size_t>(key);
+    }
+
+    static void rebuildIndex(Table& table, std::size_t slots) {
+        const ContextArena& arena = table.arena;
+        table.index.assign(slots, EMPTY_SLOT);
+        table.mask = slots - 1;
+        for (std::size_t id = 0; id < arena.size(); ++id) {
+            std::size_t slot = hashKey(arena[static_cast<uint32_t>(id)].key()) & table.mask;
+            while (table.index[slot] != EMPTY_SLOT) {
+                slot = (slot + 1) & table.mask;
+            }
+            table.index[slot] = static_cast<uint32_t>(id + 1);
+        }
+    }
+
+    Table* getTable(int seqLen) const {
+        if (seqLen < 1 || seqLen >= static_cast<int>(tables.size())) {
+            return nullptr;
+        }
+        return tables[seqLen].get();
+    }
+
+    static void sortByKey(std::vector<const Context*>& contexts) {
+        std::sort(contexts.begin(), contexts.end(),
+                  [](const Context* a, const Context* b) { return a->key() < b->key(); });
+    }
+
+    Table& tableFor(int seqLen) {
+        if (seqLen >= static_cast<int>(tables.size())) {
+            tables.resize(seqLen + 1);
+        }
+        if (!tables[seqLen]) {
+            tables[seqLen] = std::make_unique<Table>();
+            rebuildIndex(*tables[seqLen], 64);
+        }
+        return *tables[seqLen];
+    }
+
+public:
+    BasicFrequencyModel() = default;
+    BasicFrequencyModel(BasicFrequencyModel&&) = default;
+    BasicFrequencyModel& operator=(BasicFrequencyModel&&) = default;
+
+    static bool isValidSeqLen(int seqLen) {
+        return seqLen >= 2 && seqLen <= MAX_SEQ_LEN;
+    }
+
+    // Key of 'length' rounds of history starting at 'start'.
+    static uint64_t makeKey(const std::vector<std::pair<Move, Move>>& history, std::size_t start, int length) {
+        uint64_t key = 0;
+        for (std::size_t i = start; i < start + length; ++i) {
+            key = key * Rules::ROUND_CODES + Rules::roundCode(history[i].first, history[i].second);
+        }
+        return key;
+    }
+
+    // The digit string used in freq.txt: human and computer move of each
+    // round, oldest round first.
+    static std::string keyToString(uint64_t key, int rounds) {
+        std::string text(static_cast<std::size_t>(rounds) * 2, '0');
+        writeKey(key, rounds, text.data());
+        return text;
+    }
+
+    // keyToString() into 'out', which holds 2 * rounds characters.
+    static void writeKey(uint64_t key, int rounds, char* out) {
+        for (int i = rounds - 1; i >= 0; --i) {
+            int code = static_cast<int>(key % Rules::ROUND_CODES);
+            key /= Rules::ROUND_CODES;
+            out[2 * i] = static_cast<char>('0' + code / MOVES);
+            out[2 * i + 1] = static_cast<char>('0' + code % MOVES);
+        }
+    }
+
+    // Inverse of keyToString(). Fails on anything the writer cannot produce.
+    static bool parseKey(const char* text, std::size_t length, int rounds, uint64_t& key) {
+        if (length != static_cast<std::size_t>(rounds) * 2) {
+            return false;
+        }
+        key = 0;
+        for (std::size_t i = 0; i < length; i += 2) {
+            int human = text[i] - '0';
+            int computer = text[i + 1] - '0';
+            if (human < 0 || human >= MOVES || computer < 0 || computer >= MOVES) {
+                return false;
+            }
+            key = key * Rules::ROUND_CODES + static_cast<uint64_t>(human * MOVES + computer);
+        }
+        return true;
+    }
+
+    const Context* find(int seqLen, uint64_t key) const {
+        const Table* table = getTable(seqLen);
+        if (!table) {
+            return nullptr;
+        }
+        std::size_t slot = hashKey(key) & table->mask;
+        while (true) {
+            uint32_t entry = table->index[slot];
+            if (entry == EMPTY_SLOT) {
+                return nullptr;
+            }
+            const Context& context = table->arena[entry - 1];
+            if (context.key() == key) {
+                return &context;
+            }
+            slot = (slot + 1) & table->mask;
+        }
+    }
+
+    Context& findOrInsert(int seqLen, uint64_t key) {
+        Table& table = tableFor(seqLen);
+        std::size_t slot = hashKey(key) & table.mask;
+        while (true) {
+            uint32_t entry = table.index[slot];
+            if (entry == EMPTY_SLOT) {
+                break;
+            }
+            if (table.arena[entry - 1].key() == key) {
+                return table.arena.writable(entry - 1);
+            }
+            slot = (slot + 1) & table.mask;
+        }
+        uint32_t id = table.arena.allocate(key);
+        table.index[slot] = id + 1;
+        // Keep the index at most half full.
+        if (table.arena.size() * 2 > table.index.size()) {
+            rebuildIndex(table, table.index.size() * 2);
+        }
+        return table.arena.writable(id);
+    }
+
+    // Create the table for seqLen and size it for 'contexts' entries, so a bulk
+    // load never rebuilds the index. Once their tables exist, tables of
+    // different sequence lengths can be filled from different threads.
+    void reserve(int seqLen, std::size_t contexts) {
+        Table& table = tableFor(seqLen);
+        std::size_t slots = table.index.size();
+        while (slots < contexts * 2 + 2) {
+            slots *= 2;
+        }
+        table.arena.reserve(contexts);
+        if (slots != table.index.size()) {
+            rebuildIndex(table, slots);
+        }
+    }
+
+    // Count 'move' after the context and return the context, which stays
+    // valid until the next context of this sequence length is added.
+    const Context& increment(int seqLen, uint64_t key, Move move) {
+        Context& context = findOrInsert(seqLen, key);
+        int m = static_cast<int>(move);
+        if (context.counts[m] == COUNTER_MAX) {
+            for (CounterT& count : context.counts) {
+                count >>= 1;
+            }
+            // Rounding down can tie counters that were apart.
+            context.best = largestCounter(context.counts);
+        }
+        context.counts[m]++;
+        context.mask |= static_cast<uint8_t>(1 << m);
+        // Only counts[m] grew, so the best move changes only if m overtakes it.
+        int best = context.best;
+        if (m != best && (context.counts[m] > context.counts[best] ||
+                          (context.counts[m] == context.counts[best] && m < best))) {
+            context.best = static_cast<uint8_t>(m);
+        }
+        return context;
+    }
+
+    // Set the counters of the moves in 'moves' (a move mask) and mark them
+    // present; the others keep their value. Counts above COUNTER_MAX scale
+    // all counters down by the same power of two, negative ones load as 0.
+    void setCounts(int seqLen, uint64_t key, const int64_t counts[MOVES], uint8_t moves) {
+        Context& context = findOrInsert(seqLen, key);
+        int64_t values[MOVES];
+        int64_t largest = 0;
+        for (int m = 0; m < MOVES; ++m) {
+            values[m] = (moves & (1 << m)) ? std::max<int64_t>(counts[m], 0) : context.counts[m];
+            largest = std::max(largest, values[m]);
+        }
+        int shift = 0;
+        while ((largest >> shift) > COUNTER_MAX) {
+            ++shift;
+        }
+        for (int m = 0; m < MOVES; ++m) {
+            context.counts[m] = static_cast<CounterT>(values[m] >> shift);
+        }
+        context.mask |= moves;
+        context.best = largestCounter(context.counts);
+    }
+
+    std::size_t contextCount(int seqLen) const {
+        const Table* table = getTable(seqLen);
+        return table ? table->arena.size() : 0;
+    }
+
+    // Sequence lengths that have a table, in increasing order.
+    std::vector<int> seqLengths() const {
+        std::vector<int> lengths;
+        for (std::size_t n = 0; n < tables.size(); ++n) {
+            if (tables[n]) lengths.push_back(static_cast<int>(n));
+        }
+        return lengths;
+    }
+
+    // Contexts of one sequence length in insertion order.
+    template <typename Visitor>
+    void forEachContext(int seqLen, Visitor visit) const {
+        const Table* table = getTable(seqLen);
+        if (!table) {
+            return;
+        }
+        for (std::size_t id = 0; id < table->arena.size(); ++id) {
+            visit(table->arena[static_cast<uint32_t>(id)]);
+        }
+    }
+
+    // Contexts of one sequence length ordered by key, as written to freq.txt.
+    std::vector<const Context*> sortedContexts(int seqLen) const {
+        std::vector<const Context*> sorted;
+        sorted.reserve(contextCount(seqLen));
+        forEachContext(seqLen, [&sorted](const Context& context) { sorted.push_back(&context); });
+        sortByKey(sorted);
+        return sorted;
+    }
+
+    // Read-only view of the contexts as they were when snapshot() was called.
+    // It shares the arena chunks with the model instead of copying them, so
+    // taking one costs about a pointer per 1024 contexts; the model copies a
+    // shared chunk the first time it writes to it. A snapshot can be read on
+    // another thread while the model keeps changing.
+    class Snapshot {
+    private:
+        friend class BasicFrequencyModel;
+
+        struct TableView {
+            int seqLen;
+            std::size_t size;
+            std::vector<std::shared_ptr<const Context[]>> chunks;
+        };
+        std::vector<TableView> views;
+
+        const TableView* view(int seqLen) const {
+            for (const TableView& table : views) {
+                if (table.seqLen == seqLen) return &table;
+            }
+            return nullptr;
+        }
+
+    public:
+        static constexpr int MOVES = BasicFrequencyModel::MOVES;
+
+        std::vector<int> seqLengths() const {
+            std::vector<int> lengths;
+            for (const TableView& table : views) {
+                lengths.push_back(table.seqLen);
+            }
+            return lengths;
+        }
+
+        std::size_t contextCount(int seqLen) const {
+            const TableView* table = view(seqLen);
+            return table ? table->size : 0;
+        }
+
+        template <typename Visitor>
+        void forEachContext(int seqLen, Visitor visit) const {
+            const TableView* table = view(seqLen);
+            if (!table) {
+                return;
+            }
+            for (std::size_t id = 0; id < table->size; ++id) {
+                visit(table->chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)]);
+            }
+        }
+
+        std::vector<const Context*> sortedContexts(int seqLen) const {
+            std::vector<const Context*> sorted;
+            sorted.reserve(contextCount(seqLen));
+            forEachContext(seqLen, [&sorted](const Context& context) { sorted.push_back(&context); });
+            sortByKey(sorted);
+            return sorted;
+        }
+
+        // Visit each context of one sequence length together with the same
+        // context in 'earlier', an older snapshot of the same model, or null
+        // if it has been added since. Contexts keep their id and are only
+        // appended, so this needs no lookups.
+        template <typename Visitor>
+        void forEachSince(const Snapshot& earlier, int seqLen, Visitor visit) const {
+            const TableView* table = view(seqLen);
+            if (!table) {
+                return;
+            }
+            const TableView* old = earlier.view(seqLen);
+            std::size_t oldSize = old ? old->size : 0;
+            for (std::size_t id = 0; id < table->size; ++id) {
+                const Context& context = table->chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)];
+                const Context* before = nullptr;
+                if (id < oldSize) {
+                    before = &old->chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)];
+                    // Not the same model after all (it was cleared and refilled).
+                    if (before->key() != context.key()) {
+                        before = nullptr;
+                    }
+                }
+                visit(context, before);
+            }
+        }
+    };
+
+    Snapshot snapshot() {
+        Snapshot result;
+        for (std::size_t n = 0; n < tables.size(); ++n) {
+            if (tables[n]) {
+                result.views.push_back({static_cast<int>(n), tables[n]->arena.size(), tables[n]->arena.share()});
+            }
+        }
+        return result;
+    }
+
+    // A writable copy of the model that shares its arena chunks, copy-on-write
+    // as with snapshot(); only the indexes are copied. Neither model may be
+    // in use on another thread while forking.
+    BasicFrequencyModel fork() {
+        BasicFrequencyModel copy;
+        copy.tables.resize(tables.size());
+        for (std::size_t n = 0; n < tables.size(); ++n) {
+            if (tables[n]) {
+                copy.tables[n] = std::make_unique<Table>();
+                copy.tables[n]->arena = tables[n]->arena.fork();
+                copy.tables[n]->index = tables[n]->index;
+                copy.tables[n]->mask = tables[n]->mask;
+            }
+        }
+        return copy;
+    }
+
+    void clear() {
+        tables.clear();
+    }
+
+    // Heap bytes held by the model (arena chunks and indexes).
+    std::size_t memoryUsage() const {
+        std::size_t bytes = tables.capacity() * sizeof(tables[0]);
+        for (const auto& table : tables) {
+            if (table) {
+                bytes += sizeof(Table) + table->arena.bytes() + table->index.capacity() * sizeof(uint32_t);
+            }
+        }
+        return bytes;
+    }
+};
+
+using FrequencyModel = BasicFrequencyModel<uint16_t>;
+using FrequencyModel8 = BasicFrequencyModel<uint8_t>;
+using FrequencyModel32 = BasicFrequencyModel<int32_t>;
+
+#endif
@@ -4,12 +4,24 @@
 #include "Player.h"
 #include "ComputerPlayer.h"
 #include "HumanPlayer.h"  // Include the complete header for HumanPlayer
+#include "GameAnalytics.h"
+#include "ShadowEvaluator.h"
 #include <memory>
 #include <iostream>
 #include <iomanip>
+#include <string>
+
+// How much Game::play writes per round.
+enum class OutputMode {
+    Verbose,  // Line-by-line console output, flushed every line (interactive play)
+    Batch,    // Same text, built in a reusable buffer and written in large blocks
+    Quiet     // No per-round output; only progress lines and the final summary
+};
 
 class Game {
 private:
+    static constexpr std::size_t BATCH_FLUSH_SIZE = 1 << 16;
+
     std::unique_ptr<Player> humanPlayer;
     std::unique_ptr<ComputerPlayer> computerPlayer;
     int humanScore;
@@ -17,7 +29,77 @@ private:
     int ties;
     const int rounds;
 
+    OutputMode outputMode = OutputMode::Verbose;
+    int progressInterval = 0;
+    std::string outputBuffer;
+    GameAnalytics* analytics = nullptr;
+    ShadowEvaluator* shadows = nullptr;
+
+    void appendInt(long long value) {
+        char digits[24];
+        int n = 0;
+        bool negative = value < 0;
+        unsigned long long v = negative ? 0ULL - static_cast<unsigned long long>(value)
+                                        : static_cast<unsigned long long>(value);
+        do {
+            digits[n++] = static_cast<char>('0' + v % 10);
+            v /= 10;
+        } while (v != 0);
+        if (negative) outputBuffer += '-';
+        while (n > 0) outputBuffer += digits[--n];
+    }
+
+    void flushBuffer() {
+        if (!outputBuffer.empty()) {
+            std::cout.write(outputBuffer.data(), static_cast<std::streamsize>(outputBuffer.size()));
+            outputBuffer.clear();  // keeps its capacity for the next block
+        }
+    }
+
+    // Batch mode: the same round report as verbose mode, appended to the buffer.
+    void bufferRound(int round, Move humanMove, Move computerMove, int result) {
+        outputBuffer += "\nRound ";
+        appendInt(round);
+        if (rounds > 0) {
+            outputBuffer += " of ";
+            appendInt(rounds);
+        }
+        outputBuffer += "\nYou chose: ";
+        outputBuffer += moveName(humanMove);
+        outputBuffer += "\nComputer chose: ";
+        outputBuffer += moveName(computerMove);
+        if (result > 0) {
+            outputBuffer += "\nYou win this round!";
+        } else if (result < 0) {
+            outputBuffer += "\nComputer wins this round!";
+        } else {
+            outputBuffer += "\nIt's a tie!";
+        }
+        outputBuffer += "\nCurrent score - You: ";
+        appendInt(humanScore);
+        outputBuffer += ", Computer: ";
+        appendInt(computerScore);
+        outputBuffer += ", Ties: ";
+        appendInt(ties);
+        outputBuffer += '\n';
+        if (outputBuffer.size() >= BATCH_FLUSH_SIZE) {
+            flushBuffer();
+        }
+    }
+
+    void reportProgress(int played) {
+        flushBuffer();
+        std::cout << "[progress] " << played << " rounds - You: " << humanScore
+                  << ", Computer: " << computerScore
+                  << ", Ties: " << ties << std::endl;
+    }
+
+    static long long percent(int count, int total) {
+        return total > 0 ? static_cast<long long>(count) * 100 / total : 0;
+    }
+
 public:
+    // A non-positive numRounds plays until the human player is exhausted.
     Game(std::unique_ptr<Player> human, std::unique_ptr<ComputerPlayer> computer, int numRounds = 20)
         : humanPlayer(std::move(human)), 
           computerPlayer(std::move(computer)), 
@@ -26,22 +108,71 @@ public:
           ties(0),
           rounds(numRounds) {}
 
-    // The original play() method for the console version remains unchanged.
+    // Select how much per-round output play() produces (Verbose by default).
+    void setOutputMode(OutputMode mode) {
+        outputMode = mode;
+    }
+
+    // Print a one-line running score every 'interval' rounds (0 disables it).
+    void setProgressInterval(int interval) {
+        progressInterval = interval;
+    }
+
+    // Feed every round to 'stats' (not owned; null disables it). The game is
+    // closed with endGame() when play() finishes.
+    void setAnalytics(GameAnalytics* stats) {
+        analytics = stats;
+    }
+
+    // Also play the shadow strategies of 'evaluator' (not owned; null
+    // disables it) on every round. Call evaluator->flush() for the results.
+    void setShadows(ShadowEvaluator* evaluator) {
+        shadows = evaluator;
+        if (shadows) {
+            shadows->setLiveName(computerPlayer->getStrategyName());
+        }
+    }
+
+    // Play until the rounds are done or the human runs out of moves,
+    // printing each round as the output mode says, then the final score.
     void play() {
-        std::cout << "Starting a new game with " << rounds << " rounds." << std::endl;
+        if (rounds > 0) {
+            std::cout << "Starting a new game with " << rounds << " rounds." << std::endl;
+        } else {
+            std::cout << "Starting a new game that runs until the input ends." << std::endl;
+        }
         std::cout << "Computer is using " << computerPlayer->getStrategyName() << " strategy." << std::endl;
         std::cout << "------------------------------" << std::endl;
         
-        for (int round = 1; round <= rounds; ++round) {
-            std::cout << "\nRound " << round << " of " << rounds << std::endl;
+        const bool verbose = outputMode == OutputMode::Verbose;
+        if (rounds > 0) {
+            computerPlayer->reserveHistory(static_cast<std::size_t>(rounds));
+        }
+        if (outputMode == OutputMode::Batch) {
+            outputBuffer.reserve(BATCH_FLUSH_SIZE + 256);
+        }
+
+        int played = 0;
+        for (int round = 1; rounds <= 0 || round <= rounds; ++round) {
+            // Scripted players may run out of moves before the last round.
+            if (humanPlayer->isExhausted()) {
+                break;
+            }
+            if (verbose) {
+                std::cout << "\nRound " << round;
+                if (rounds > 0) std::cout << " of " << rounds;
+                std::cout << std::endl;
+            }
             
             // Get moves from players
             Move humanMove = humanPlayer->makeMove();
             Move computerMove = computerPlayer->makeMove();
             
             // Display moves
-            std::cout << "You chose: " << moveToString(humanMove) << std::endl;
-            std::cout << "Computer chose: " << moveToString(computerMove) << std::endl;
+            if (verbose) {
+                std::cout << "You chose: " << moveName(humanMove) << std::endl;
+                std::cout << "Computer chose: " << moveName(computerMove) << std::endl;
+            }
             
             // Determine winner
             int result = determineWinner(humanMove, computerMove);
@@ -49,34 +180,57 @@ public:
             // Update scores and display result
             if (result > 0) {
                 humanScore++;
-                std::cout << "You win this round!" << std::endl;
+                if (verbose) std::cout << "You win this round!" << std::endl;
             } else if (result < 0) {
                 computerScore++;
-                std::cout << "Computer wins this round!" << std::endl;
+                if (verbose) std::cout << "Computer wins this round!" << std::endl;
             } else {
                 ties++;
-                std::cout << "It's a tie!" << std::endl;
+                if (verbose) std::cout << "It's a tie!" << std::endl;
             }
             
             // Display current score
-            std::cout << "Current score - You: " << humanScore 
-                      << ", Computer: " << computerScore 
-                      << ", Ties: " << ties << std::endl;
+            if (verbose) {
+                std::cout << "Current score - You: " << humanScore
+                          << ", Computer: " << computerScore
+                          << ", Ties: " << ties << std::endl;
+            } else if (outputMode == OutputMode::Batch) {
+                bufferRound(round, humanMove, computerMove, result);
+            }
+            
+            if (analytics || shadows) {
+                Move predicted;
+                int prediction = computerPlayer->getPrediction(predicted) ? static_cast<int>(predicted) : -1;
+                if (analytics) analytics->observe(humanMove, computerMove, prediction);
+                if (shadows) shadows->record(humanMove, computerMove, prediction);
+            }
             
             // Record the result for both players
             humanPlayer->recordResult(humanMove, computerMove);
             computerPlayer->recordResult(humanMove, computerMove);
+            played++;
+
+            if (progressInterval > 0 && played % progressInterval == 0) {
+                reportProgress(played);
+            }
+        }
+        flushBuffer();
+        if (analytics) {
+            analytics->endGame();
+        }
+        if (shadows) {
+            shadows->endGame();
         }
         
         // Display final results
         std::cout << "\n------------------------------" << std::endl;
         std::cout << "Game Over! " << std::endl;    
         std::cout << "   Human wins: " << std::setw(5) << humanScore << "  " 
-                  << std::setw(3) << (rounds > 0 ? (humanScore * 100 / rounds) : 0) << "%" << std::endl;
+                  << std::setw(3) << percent(humanScore, played) << "%" << std::endl;
         std::cout << "Computer wins: " << std::setw(5) << computerScore << "  " 
-                  << std::setw(3) << (rounds > 0 ? (computerScore * 100 / rounds) : 0) << "%" << std::endl;
+                  << std::setw(3) << percent(computerScore, played) << "%" << std::endl;
         std::cout << "         Ties: " << std::setw(5) << ties << "  " 
-                  << std::setw(3) << (rounds > 0 ? (ties * 100 / rounds) : 0) << "%" << std::endl;
+                  << std::setw(3) << percent(ties, played) << "%" << std::endl;
         
         if (humanScore > computerScore) {
             std::cout << "You win!" << std::endl;
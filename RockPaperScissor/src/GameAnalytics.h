@@ -0,0 +1,371 @@
+#ifndef GAME_ANALYTICS_H
+#define GAME_ANALYTICS_H
+
+#include "Move.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// One-pass statistics over a stream of rounds: outcome rates over a sliding
+// window, streak lengths, the human's move entropy, how predictable the
+// human's next move is from the previous 1..MAX_ORDER moves, and how often
+// the strategy predicted the human's move.
+//
+// Memory is fixed when the object is made (the window plus about 4 KiB of
+// counters), however many rounds it sees, so one object per player is
+// cheap. Results are mergeable: the analytics of separate games can be
+// built on different threads and merged, which gives the same numbers as a
+// single pass over all of them. Windows, streaks and n-grams never span two
+// games; call endGame() between them.
+class GameAnalytics {
+public:
+    enum class Outcome { HumanWin, ComputerWin, Tie };
+
+    static constexpr int OUTCOMES = 3;
+    static constexpr int MOVES = ClassicRules::COUNT;
+    static constexpr int MAX_ORDER = 4;    // longest n-gram context, in human moves
+    static constexpr int MAX_STREAK = 32;  // longer streaks are counted in the last bucket
+    static constexpr int RATE_BINS = 10;   // histogram of windowed computer win rates
+
+private:
+    // MOVES^order contexts of each order.
+    static constexpr std::array<int, MAX_ORDER + 1> CONTEXTS = [] {
+        std::array<int, MAX_ORDER + 1> contexts{};
+        contexts[0] = 1;
+        for (int order = 1; order <= MAX_ORDER; ++order) {
+            contexts[order] = contexts[order - 1] * MOVES;
+        }
+        return contexts;
+    }();
+
+    // Counters of the order-k contexts start at NGRAM_OFFSET[k]; each context
+    // has one counter per next move.
+    static constexpr std::array<int, MAX_ORDER + 2> NGRAM_OFFSET = [] {
+        std::array<int, MAX_ORDER + 2> offsets{};
+        for (int order = 0; order <= MAX_ORDER; ++order) {
+            offsets[order + 1] = offsets[order] + CONTEXTS[order] * MOVES;
+        }
+        return offsets;
+    }();
+
+    int windowSize;
+    std::vector<uint8_t> window;  // outcomes of the last windowSize rounds of this game
+    int windowFill = 0;
+    int windowPos = 0;
+    int windowCounts[OUTCOMES] = {0, 0, 0};
+
+    uint64_t rounds = 0;
+    uint64_t games = 0;
+    uint64_t outcomes[OUTCOMES] = {0, 0, 0};
+
+    // Every full window position: sum, minimum and maximum of each outcome's
+    // count, and a histogram of the computer's win rate.
+    uint64_t windows = 0;
+    uint64_t windowSums[OUTCOMES] = {0, 0, 0};
+    int windowMin[OUTCOMES] = {0, 0, 0};
+    int windowMax[OUTCOMES] = {0, 0, 0};
+    uint64_t rateHistogram[RATE_BINS] = {};
+
+    // Closed streaks by outcome and length (bucket i is length i + 1).
+    uint64_t streaks[OUTCOMES][MAX_STREAK] = {};
+    uint64_t longestStreak[OUTCOMES] = {0, 0, 0};
+    int streakOutcome = -1;  // outcome of the open streak, -1 at the start of a game
+    uint64_t streakLength = 0;
+
+    std::array<uint64_t, NGRAM_OFFSET[MAX_ORDER + 1]> ngrams = {};
+    int recentMoves = 0;    // last MAX_ORDER human moves of this game, base MOVES, newest last
+    int recentLength = 0;   // how many of them there are
+
+    uint64_t predictions = 0;
+    uint64_t correctPredictions = 0;
+
+    static int outcomeOf(Move humanMove, Move computerMove) {
+        int result = determineWinner(humanMove, computerMove);
+        return static_cast<int>(result > 0 ? Outcome::HumanWin : (result < 0 ? Outcome::ComputerWin : Outcome::Tie));
+    }
+
+    void closeStreak() {
+        if (streakOutcome >= 0 && streakLength > 0) {
+            streaks[streakOutcome][std::min<uint64_t>(streakLength, MAX_STREAK) - 1]++;
+        }
+        streakOutcome = -1;
+        streakLength = 0;
+    }
+
+    void recordWindow() {
+        windows++;
+        for (int o = 0; o < OUTCOMES; ++o) {
+            windowSums[o] += static_cast<uint64_t>(windowCounts[o]);
+            if (windows == 1 || windowCounts[o] < windowMin[o]) windowMin[o] = windowCounts[o];
+            if (windows == 1 || windowCounts[o] > windowMax[o]) windowMax[o] = windowCounts[o];
+        }
+        int computerWins = windowCounts[static_cast<int>(Outcome::ComputerWin)];
+        rateHistogram[std::min(computerWins * RATE_BINS / windowSize, RATE_BINS - 1)]++;
+    }
+
+    // Entries of the order-k table, summed over contexts: the number of
+    // rounds, of rounds matching their context's most frequent move, and the
+    // entropy of the next move in bits, weighted by context frequency.
+    void ngramSummary(int order, uint64_t& total, uint64_t& matched, double& weightedEntropy) const {
+        total = 0;
+        matched = 0;
+        weightedEntropy = 0;
+        for (int context = 0; context < CONTEXTS[order]; ++context) {
+            const uint64_t* counts = &ngrams[static_cast<std::size_t>(NGRAM_OFFSET[order] + MOVES * context)];
+            uint64_t contextTotal = 0;
+            uint64_t largest = 0;
+            for (int m = 0; m < MOVES; ++m) {
+                contextTotal += counts[m];
+                largest = std::max(largest, counts[m]);
+            }
+            if (contextTotal == 0) continue;
+            total += contextTotal;
+            matched += largest;
+            for (int m = 0; m < MOVES; ++m) {
+                if (counts[m] > 0) {
+                    double p = static_cast<double>(counts[m]) / contextTotal;
+                    weightedEntropy -= counts[m] * std::log2(p);
+                }
+            }
+        }
+    }
+
+public:
+    explicit GameAnalytics(int windowRounds = 100)
+        : windowSize(std::max(1, windowRounds)), window(static_cast<std::size_t>(windowSize)) {}
+
+    // One round. predictedHumanMove is the strategy's prediction for it, or
+    // -1 when the strategy made none.
+    void observe(Move humanMove, Move computerMove, int predictedHumanMove = -1) {
+        int outcome = outcomeOf(humanMove, computerMove);
+        rounds++;
+        outcomes[outcome]++;
+
+        if (windowFill == windowSize) {
+            windowCounts[window[static_cast<std::size_t>(windowPos)]]--;
+        } else {
+            windowFill++;
+        }
+        window[static_cast<std::size_t>(windowPos)] = static_cast<uint8_t>(outcome);
+        windowCounts[outcome]++;
+        windowPos = windowPos + 1 == windowSize ? 0 : windowPos + 1;
+        if (windowFill == windowSize) {
+            recordWindow();
+        }
+
+        if (outcome != streakOutcome) {
+            closeStreak();
+            streakOutcome = outcome;
+        }
+        streakLength++;
+        longestStreak[outcome] = std::max(longestStreak[outcome], streakLength);
+
+        int move = static_cast<int>(humanMove);
+        for (int order = 0; order <= std::min(recentLength, MAX_ORDER); ++order) {
+            int context = recentMoves % CONTEXTS[order];  // the last 'order' moves
+            ngrams[static_cast<std::size_t>(NGRAM_OFFSET[order] + MOVES * context + move)]++;
+        }
+        recentMoves = (recentMoves * MOVES + move) % CONTEXTS[MAX_ORDER];
+        recentLength = std::min(recentLength + 1, MAX_ORDER);
+
+        if (predictedHumanMove >= 0) {
+            predictions++;
+            if (predictedHumanMove == move) correctPredictions++;
+        }
+    }
+
+    // Close the current game: its last streak is counted and the next round
+    // starts a new window and n-gram context.
+    void endGame() {
+        if (windowFill == 0 && streakOutcome < 0) {
+            return;
+        }
+        closeStreak();
+        games++;
+        windowFill = 0;
+        windowPos = 0;
+        windowCounts[0] = windowCounts[1] = windowCounts[2] = 0;
+        recentMoves = 0;
+        recentLength = 0;
+    }
+
+    // Add the statistics of 'other', whose games are separate from these; a
+    // game still open in 'other' counts as ended. Both must use the same
+    // window size.
+    bool merge(const GameAnalytics& other) {
+        if (other.windowSize != windowSize) {
+            std::cerr << "Cannot merge analytics with different window sizes." << std::endl;
+            return false;
+        }
+        rounds += other.rounds;
+        games += other.games + (other.windowFill > 0 ? 1 : 0);
+        for (int o = 0; o < OUTCOMES; ++o) {
+            outcomes[o] += other.outcomes[o];
+            if (other.windows > 0) {
+                windowMin[o] = windows > 0 ? std::min(windowMin[o], other.windowMin[o]) : other.windowMin[o];
+                windowMax[o] = windows > 0 ? std::max(windowMax[o], other.windowMax[o]) : other.windowMax[o];
+            }
+            windowSums[o] += other.windowSums[o];
+            for (int length = 0; length < MAX_STREAK; ++length) {
+                streaks[o][length] += other.streaks[o][length];
+            }
+            longestStreak[o] = std::max(longestStreak[o], other.longestStreak[o]);
+        }
+        if (other.streakOutcome >= 0 && other.streakLength > 0) {
+            streaks[other.streakOutcome][std::min<uint64_t>(other.streakLength, MAX_STREAK) - 1]++;
+        }
+        windows += other.windows;
+        for (int bin = 0; bin < RATE_BINS; ++bin) {
+            rateHistogram[bin] += other.rateHistogram[bin];
+        }
+        for (std::size_t i = 0; i < ngrams.size(); ++i) {
+            ngrams[i] += other.ngrams[i];
+        }
+        predictions += other.predictions;
+        correctPredictions += other.correctPredictions;
+        return true;
+    }
+
+    uint64_t getRounds() const {
+        return rounds;
+    }
+
+    uint64_t getGames() const {
+        return games + (windowFill > 0 ? 1 : 0);
+    }
+
+    uint64_t getOutcomeCount(Outcome outcome) const {
+        return outcomes[static_cast<int>(outcome)];
+    }
+
+    int getWindowSize() const {
+        return windowSize;
+    }
+
+    // Rate of an outcome over the last getWindowSize() rounds of the current
+    // game (fewer at its start).
+    double getWindowRate(Outcome outcome) const {
+        return windowFill > 0 ? static_cast<double>(windowCounts[static_cast<int>(outcome)]) / windowFill : 0.0;
+    }
+
+    // Number of full windows seen, and the mean, lowest and highest rate of
+    // an outcome over them.
+    uint64_t getWindowCount() const {
+        return windows;
+    }
+
+    double getWindowMeanRate(Outcome outcome) const {
+        return windows > 0 ? static_cast<double>(windowSums[static_cast<int>(outcome)]) / (windows * windowSize) : 0.0;
+    }
+
+    double getWindowMinRate(Outcome outcome) const {
+        return static_cast<double>(windowMin[static_cast<int>(outcome)]) / windowSize;
+    }
+
+    double getWindowMaxRate(Outcome outcome) const {
+        return static_cast<double>(windowMax[static_cast<int>(outcome)]) / windowSize;
+    }
+
+    // Full windows whose computer win rate falls in [bin, bin + 1) / RATE_BINS.
+    uint64_t getRateHistogram(int bin) const {
+        return rateHistogram[bin];
+    }
+
+    // Closed streaks of exactly 'length' rounds (length MAX_STREAK counts
+    // every longer streak too).
+    uint64_t getStreakCount(Outcome outcome, int length) const {
+        return length >= 1 && length <= MAX_STREAK ? streaks[static_cast<int>(outcome)][length - 1] : 0;
+    }
+
+    uint64_t getLongestStreak(Outcome outcome) const {
+        return longestStreak[static_cast<int>(outcome)];
+    }
+
+    // Entropy of the human's moves in bits (log2(3) = 1.585 for uniform play).
+    double getMoveEntropy() const {
+        return getConditionalEntropy(0);
+    }
+
+    // Entropy of the human's next move given the previous 'order' moves.
+    double getConditionalEntropy(int order) const {
+        uint64_t total, matched;
+        double weighted;
+        ngramSummary(std::clamp(order, 0, MAX_ORDER), total, matched, weighted);
+        return total > 0 ? weighted / total : 0.0;
+    }
+
+    // Share of rounds in which the human played the move that most often
+    // followed the previous 'order' moves, over the whole stream. This is
+    // the accuracy an order-'order' predictor would reach with hindsight.
+    double getPredictability(int order) const {
+        uint64_t total, matched;
+        double weighted;
+        ngramSummary(std::clamp(order, 0, MAX_ORDER), total, matched, weighted);
+        return total > 0 ? static_cast<double>(matched) / total : 0.0;
+    }
+
+    uint64_t getPredictionCount() const {
+        return predictions;
+    }
+
+    // Share of the strategy's predictions that named the human's move.
+    double getPredictionAccuracy() const {
+        return predictions > 0 ? static_cast<double>(correctPredictions) / predictions : 0.0;
+    }
+
+    std::size_t memoryUsage() const {
+        return sizeof(*this) + window.capacity();
+    }
+
+    void report(std::ostream& out) const {
+        static const char* const names[OUTCOMES] = {"Human wins", "Computer wins", "Ties"};
+        std::ios::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        out << std::fixed << std::setprecision(1);
+        out << "Analytics: " << rounds << " rounds in " << getGames() << " games" << '\n';
+        out << "  Outcome        total%   window " << windowSize << ": mean%  min%  max%   longest streak" << '\n';
+        for (int o = 0; o < OUTCOMES; ++o) {
+            Outcome outcome = static_cast<Outcome>(o);
+            out << "  " << std::left << std::setw(14) << names[o] << std::right
+                << std::setw(7) << (rounds > 0 ? outcomes[o] * 100.0 / rounds : 0.0)
+                << std::setw(18) << getWindowMeanRate(outcome) * 100
+                << std::setw(6) << getWindowMinRate(outcome) * 100
+                << std::setw(6) << getWindowMaxRate(outcome) * 100
+                << std::setw(17) << longestStreak[o] << '\n';
+        }
+        out << "  Computer win rate per window (" << windows << " windows):";
+        for (int bin = 0; bin < RATE_BINS; ++bin) {
+            out << ' ' << rateHistogram[bin];
+        }
+        out << '\n';
+        out << "  Streaks of length 1..7, 8+:" << '\n';
+        for (int o = 0; o < OUTCOMES; ++o) {
+            out << "    " << std::left << std::setw(14) << names[o] << std::right;
+            uint64_t longer = 0;
+            for (int length = 1; length <= MAX_STREAK; ++length) {
+                if (length < 8) out << ' ' << getStreakCount(static_cast<Outcome>(o), length);
+                else longer += getStreakCount(static_cast<Outcome>(o), length);
+            }
+            out << ' ' << longer << '\n';
+        }
+        out << std::setprecision(3);
+        out << "  Move entropy: " << getMoveEntropy() << " bits" << '\n';
+        out << "  Order  cond. entropy  predictability%" << '\n';
+        for (int order = 1; order <= MAX_ORDER; ++order) {
+            out << std::setw(7) << order << std::setw(15) << getConditionalEntropy(order)
+                << std::setw(17) << std::setprecision(1) << getPredictability(order) * 100 << std::setprecision(3) << '\n';
+        }
+        out << std::setprecision(1);
+        out << "  Strategy predictions: " << predictions << ", accuracy "
+            << getPredictionAccuracy() * 100 << "%" << '\n';
+        out.flags(flags);
+        out.precision(precision);
+    }
+};
+
+#endif
@@ -0,0 +1,390 @@
+#ifndef GAME_SCHEDULER_H
+#define GAME_SCHEDULER_H
+
+#include "ComputerPlayer.h"
+#include "GameAnalytics.h"
+#include "Move.h"
+#include "Strategy.h"
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Owning handle of a game coroutine. The coroutine starts suspended and is
+// resumed by GameScheduler; an exception inside it is kept and rethrown
+// from the scheduler.
+class GameTask {
+public:
+    struct promise_type {
+        std::exception_ptr error;
+
+        GameTask get_return_object() {
+            return GameTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+
+        // Frames are counted so the cost of a suspended game can be reported.
+        static void* operator new(std::size_t size) {
+            frameBytes() += static_cast<long long>(size);
+            return ::operator new(size);
+        }
+        static void operator delete(void* frame, std::size_t size) {
+            frameBytes() -= static_cast<long long>(size);
+            ::operator delete(frame);
+        }
+    };
+
+    // Bytes held by live game coroutine frames, over all schedulers.
+    static std::atomic<long long>& frameBytes() {
+        static std::atomic<long long> bytes{0};
+        return bytes;
+    }
+
+    GameTask() = default;
+    GameTask(GameTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    GameTask& operator=(GameTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    GameTask(const GameTask&) = delete;
+    GameTask& operator=(const GameTask&) = delete;
+    ~GameTask() { reset(); }
+
+    std::coroutine_handle<promise_type> get() const { return handle; }
+
+    void reset() {
+        if (handle) {
+            handle.destroy();
+            handle = {};
+        }
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+    explicit GameTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+};
+
+// Runs many games on one thread, with the game loop of Game::play written as
+// a coroutine that suspends while it waits for the human's next move. A
+// waiting game costs its coroutine frame and its player state, not a thread,
+// so one scheduler can hold tens of thousands of games whose moves arrive
+// whenever their source (a socket, a pipe, a simulator) has them.
+//
+// Moves are given to a game with deliver() on the scheduler's thread, or
+// with post() from any thread, which run() picks up. Closing a game's input
+// ends it early, as a script running out ends Game::play. Games do no
+// console output.
+//
+// A finished game keeps its state (scores, strategy and history) until it
+// is released with release(); its id is then reused by a later spawn().
+// A long-running scheduler should release games once their results are
+// read, or it holds every game it ever ran.
+class GameScheduler {
+public:
+    using GameId = std::size_t;
+
+    struct GameState {
+        ComputerPlayer computer;
+        int rounds;                  // 0 = until the input is closed
+        int played = 0;
+        int humanScore = 0;
+        int computerScore = 0;
+        int ties = 0;
+        bool finished = false;
+        GameAnalytics* analytics = nullptr;
+
+        GameState(std::unique_ptr<Strategy> strategy, int roundLimit)
+            : computer(std::move(strategy)), rounds(roundLimit) {}
+
+    private:
+        friend class GameScheduler;
+
+        // Moves delivered before the game asked for them; empty (and
+        // unallocated) in the usual case of one move per wake-up.
+        std::vector<Move> pending;
+        std::size_t pendingHead = 0;
+        bool inputClosed = false;
+        bool queued = false;              // in the scheduler's ready list
+        std::coroutine_handle<> waiting;  // set while suspended
+        GameTask task;
+    };
+
+private:
+    // co_await NextMove{game}: the human's next move, or nothing once the
+    // input is closed. Only suspends when no move is waiting.
+    struct NextMove {
+        GameState& game;
+
+        bool await_ready() const noexcept {
+            return game.pendingHead < game.pending.size() || game.inputClosed;
+        }
+        void await_suspend(std::coroutine_handle<> handle) noexcept {
+            game.waiting = handle;
+        }
+        std::optional<Move> await_resume() {
+            if (game.pendingHead == game.pending.size()) {
+                return std::nullopt;
+            }
+            Move move = game.pending[game.pendingHead++];
+            if (game.pendingHead == game.pending.size()) {
+                game.pending.clear();
+                game.pendingHead = 0;
+            }
+            return move;
+        }
+    };
+
+    // A move (or, with close set, the end of the input) posted from another thread.
+    struct Posted {
+        GameId game;
+        Move move;
+        bool close;
+    };
+
+    std::vector<std::unique_ptr<GameState>> games;  // null for released ids
+    std::vector<GameId> freeIds;
+    std::vector<GameState*> ready;
+    std::vector<GameState*> running;
+    std::size_t activeGames = 0;
+    std::atomic<long long> roundsPlayed{0};
+
+    std::mutex inboxMutex;
+    std::condition_variable inboxReady;
+    std::vector<Posted> inbox;
+    std::vector<Posted> draining;
+
+    static GameTask play(GameState& game, std::atomic<long long>& roundsPlayed) {
+        while (game.rounds <= 0 || game.played < game.rounds) {
+            std::optional<Move> humanMove = co_await NextMove{game};
+            if (!humanMove) {
+                break;
+            }
+            Move computerMove = game.computer.makeMove();
+            int result = determineWinner(*humanMove, computerMove);
+            if (result > 0) {
+                game.humanScore++;
+            } else if (result < 0) {
+                game.computerScore++;
+            } else {
+                game.ties++;
+            }
+            if (game.analytics) {
+                Move predicted;
+                bool hasPrediction = game.computer.getPrediction(predicted);
+                game.analytics->observe(*humanMove, computerMove, hasPrediction ? static_cast<int>(predicted) : -1);
+            }
+            game.computer.recordResult(*humanMove, computerMove);
+            game.played++;
+            roundsPlayed.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (game.analytics) {
+            game.analytics->endGame();
+        }
+        game.computer.saveState();
+    }
+
+    void wake(GameState& game) {
+        if (game.waiting && !game.queued) {
+            game.queued = true;
+            ready.push_back(&game);
+        }
+    }
+
+    // Resume one game; a finished game's frame is freed straight away.
+    void resume(GameState& game) {
+        game.queued = false;
+        std::exchange(game.waiting, {}).resume();
+        if (game.task.get().done()) {
+            std::exception_ptr error = game.task.get().promise().error;
+            game.task.reset();
+            game.finished = true;
+            activeGames--;
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    bool drainInbox() {
+        {
+            std::lock_guard<std::mutex> lock(inboxMutex);
+            draining.swap(inbox);
+        }
+        for (const Posted& posted : draining) {
+            if (posted.close) {
+                close(posted.game);
+            } else {
+                deliver(posted.game, posted.move);
+            }
+        }
+        bool any = !draining.empty();
+        draining.clear();
+        return any;
+    }
+
+public:
+    GameScheduler() = default;
+    GameScheduler(const GameScheduler&) = delete;
+    GameScheduler& operator=(const GameScheduler&) = delete;
+
+    // Add a game of 'rounds' rounds (0 = until its input is closed). It runs
+    // up to its first wait on the next runReady(). Reuses a released id if
+    // there is one.
+    GameId spawn(std::unique_ptr<Strategy> strategy, int rounds, GameAnalytics* analytics = nullptr) {
+        auto game = std::make_unique<GameState>(std::move(strategy), rounds);
+        game->analytics = analytics;
+        game->task = play(*game, roundsPlayed);
+        game->waiting = game->task.get();
+        wake(*game);
+        activeGames++;
+        if (!freeIds.empty()) {
+            GameId id = freeIds.back();
+            freeIds.pop_back();
+            games[id] = std::move(game);
+            return id;
+        }
+        games.push_back(std::move(game));
+        return games.size() - 1;
+    }
+
+    // Free a finished game's state and make its id available to spawn().
+    // False, and nothing happens, while the game is still running. Moves
+    // must no longer be posted for it.
+    bool release(GameId id) {
+        if (id >= games.size() || !games[id] || !games[id]->finished) {
+            return false;
+        }
+        games[id].reset();
+        freeIds.push_back(id);
+        return true;
+    }
+
+    // Give a game its human's next move. Scheduler thread only.
+    void deliver(GameId id, Move move) {
+        GameState* game = id < games.size() ? games[id].get() : nullptr;
+        if (!game || game->finished || game->inputClosed) {
+            return;
+        }
+        game->pending.push_back(move);
+        wake(*game);
+    }
+
+    // End a game's input: it finishes after the moves already delivered.
+    void close(GameId id) {
+        GameState* game = id < games.size() ? games[id].get() : nullptr;
+        if (!game) {
+            return;
+        }
+        game->inputClosed = true;
+        wake(*game);
+    }
+
+    // Thread-safe versions of deliver() and close(), applied by run().
+    void post(GameId id, Move move) {
+        {
+            std::lock_guard<std::mutex> lock(inboxMutex);
+            inbox.push_back({id, move, false});
+        }
+        inboxReady.notify_one();
+    }
+
+    void postClose(GameId id) {
+        {
+            std::lock_guard<std::mutex> lock(inboxMutex);
+            inbox.push_back({id, Move::ROCK, true});
+        }
+        inboxReady.notify_one();
+    }
+
+    // Post a batch of moves with one lock and one wake-up.
+    void post(const std::vector<std::pair<GameId, Move>>& moves) {
+        {
+            std::lock_guard<std::mutex> lock(inboxMutex);
+            for (const auto& entry : moves) {
+                inbox.push_back({entry.first, entry.second, false});
+            }
+        }
+        inboxReady.notify_one();
+    }
+
+    // Resume every game that can make progress. Returns whether any ran.
+    // An error thrown by a game's strategy propagates from here once the
+    // game is marked finished; the games not yet resumed stay ready.
+    bool runReady() {
+        if (ready.empty()) {
+            return false;
+        }
+        // Puts the games after 'next' back in front of the queue, and leaves
+        // 'running' empty, however the loop below ends.
+        struct Requeue {
+            GameScheduler& scheduler;
+            std::size_t next = 0;
+            ~Requeue() {
+                std::vector<GameState*>& running = scheduler.running;
+                scheduler.ready.insert(scheduler.ready.begin(), running.begin() + static_cast<std::ptrdiff_t>(next),
+                                       running.end());
+                running.clear();
+            }
+        };
+        while (!ready.empty()) {
+            running.swap(ready);
+            Requeue requeue{*this};
+            while (requeue.next < running.size()) {
+                resume(*running[requeue.next++]);
+            }
+        }
+        return true;
+    }
+
+    // Drive the games until all have finished, applying posted moves and
+    // sleeping while there is nothing to do.
+    void run() {
+        while (activeGames > 0) {
+            drainInbox();
+            if (runReady()) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(inboxMutex);
+            inboxReady.wait(lock, [this] { return !inbox.empty(); });
+        }
+    }
+
+    // A game that has not been released.
+    const GameState& game(GameId id) const {
+        return *games[id];
+    }
+
+    // Ids handed out so far, released ones included: ids are below this.
+    std::size_t gameCount() const {
+        return games.size();
+    }
+
+    // Games whose state is held, finished or not.
+    std::size_t getHeldGames() const {
+        return games.size() - freeIds.size();
+    }
+
+    std::size_t getActiveGames() const {
+        return activeGames;
+    }
+
+    // Rounds played by all games; may be read from any thread.
+    long long getRoundsPlayed() const {
+        return roundsPlayed.load(std::memory_order_relaxed);
+    }
+};
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef LONGEST_MATCH_STRATEGY_H
+#define LONGEST_MATCH_STRATEGY_H
+
+#include "Strategy.h"
+#include "SuffixAutomaton.h"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <random>
+#include <string>
+#include <vector>
+
+// Plays against the move that followed the longest earlier repetition of
+// the recent history, however far back or however long it is.
+//
+// SmartStrategy and ContextTreeStrategy only look at a bounded number of
+// recent rounds and keep counts, so a pattern longer than their deepest
+// context is learned slowly if at all. Here suffix automata over the whole
+// session find the longest suffix of the history that occurred before, in
+// amortized O(1) per round, and the prediction is what the human played
+// after it. A cycle of any length is caught once it has gone round once.
+//
+// There are two automata: one over whole rounds (roundCode) and one over
+// the human's moves alone. The human-only one still matches while the
+// computer's own moves differ, for example while it was guessing. The
+// rounds one also sees opponents that react to the computer. Each
+// prediction is scored against the move the human then made, and the
+// automaton with the better recent score is followed.
+//
+// Like the context tree, the automata are kept for the session only. They
+// take up to about 200 bytes per round.
+class LongestMatchStrategy : public Strategy {
+private:
+    // Recent hit scores decay by 1/2^SCORE_DECAY_BITS per round.
+    static constexpr int SCORE_DECAY_BITS = 4;
+    static constexpr int32_t SCORE_HIT = 256;
+
+    SuffixAutomaton<ClassicRules::ROUND_CODES> rounds;
+    SuffixAutomaton<ClassicRules::COUNT> humanMoves;
+    int32_t roundsScore = 0;
+    int32_t humanScore = 0;
+    int pendingRounds = -1;  // each automaton's prediction this round, or -1
+    int pendingHuman = -1;
+    int lastMatchLength = 0;
+    std::mt19937 rng;
+
+    bool predictionValid = false;
+    Move lastPredictedHumanMove = Move::ROCK;
+
+    Move randomMove() {
+        return static_cast<Move>(std::uniform_int_distribution<int>(0, ClassicRules::COUNT - 1)(rng));
+    }
+
+    // Add the rounds of 'history' the automata have not seen yet. Normally
+    // updateFrequencies adds each round as it is played; a caller that
+    // skipped it, or replays a history, is caught up here.
+    void appendRounds(const std::vector<std::pair<Move, Move>>& history) {
+        for (std::size_t i = rounds.size(); i < history.size(); ++i) {
+            rounds.append(roundCode(history[i].first, history[i].second));
+            humanMoves.append(static_cast<int>(history[i].first));
+        }
+    }
+
+    static void score(int32_t& score, int predicted, int actual) {
+        score -= score >> SCORE_DECAY_BITS;
+        if (predicted == actual) {
+            score += SCORE_HIT;
+        }
+    }
+
+public:
+    LongestMatchStrategy() : LongestMatchStrategy(static_cast<unsigned int>(std::time(nullptr))) {}
+
+    explicit LongestMatchStrategy(unsigned int seed) : rng(seed) {}
+
+    // Predicts from the automata, which hold the rounds of this session; any
+    // of 'history' they are missing are added first. The history must be
+    // this session's, growing from round to round.
+    Move makeMove(const std::vector<std::pair<Move, Move>>& history) override {
+        appendRounds(history);
+        int next = rounds.predictNext();
+        pendingRounds = next < 0 ? -1 : next / ClassicRules::COUNT;  // the human half of the round
+        pendingHuman = humanMoves.predictNext();
+
+        bool useRounds = pendingRounds >= 0 && (pendingHuman < 0 || roundsScore >= humanScore);
+        int predicted = useRounds ? pendingRounds : pendingHuman;
+        lastMatchLength = predicted < 0 ? 0
+                          : (useRounds ? rounds.getMatchLength() : humanMoves.getMatchLength());
+        predictionValid = predicted >= 0;
+        if (!predictionValid) {
+            return randomMove();
+        }
+        lastPredictedHumanMove = static_cast<Move>(predicted);
+        return counterMove(lastPredictedHumanMove);
+    }
+
+    void updateFrequencies(const std::vector<std::pair<Move, Move>>& history) override {
+        if (history.size() <= rounds.size()) {
+            return;
+        }
+        int human = static_cast<int>(history.back().first);
+        if (pendingRounds >= 0) {
+            score(roundsScore, pendingRounds, human);
+        }
+        if (pendingHuman >= 0) {
+            score(humanScore, pendingHuman, human);
+        }
+        pendingRounds = pendingHuman = -1;
+        // Normally one round; any the strategy did not see are added as well.
+        appendRounds(history);
+    }
+
+    void saveState() override {
+        // The automata describe this session only; nothing to save.
+    }
+
+    void loadState() override {
+        // Nothing to load, see saveState().
+    }
+
+    std::string getName() const override {
+        return "LongestMatch";
+    }
+
+    Move getLastPredictedHumanMove() const {
+        return lastPredictedHumanMove;
+    }
+
+    bool isPredictionValid() const {
+        return predictionValid;
+    }
+
+    // Rounds matched by the repetition the last prediction came from.
+    int getLastMatchLength() const {
+        return lastMatchLength;
+    }
+
+    // Bytes held by both automata.
+    std::size_t getMemoryUsage() const {
+        return rounds.getMemoryUsage() + humanMoves.getMemoryUsage();
+    }
+};
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef MODEL_RELOADER_H
+#define MODEL_RELOADER_H
+
+#include "FrequencyFileReader.h"
+#include "FrequencyModel.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+// Watches a model file and loads every new version of it on a background
+// thread, so a process can pick up a model retrained elsewhere without
+// restarting its games.
+//
+// The file's modification time and size are polled every interval. A change
+// is loaded once the file has stayed the same for one more poll, so a file
+// that is still being written in place is not read half-way; a version that
+// does not load is skipped until the file changes again.
+//
+// New models are published RCU-style: a model is complete before its version
+// is published, and the game thread adopts it in take(). That costs one atomic
+// load while nothing has changed and never waits; if the watcher happens to
+// hold the lock, the model is adopted on a later call. The model it replaces
+// is handed back and freed on the watcher thread.
+class ModelReloader {
+public:
+    struct Stats {
+        long long polls = 0;
+        long long loads = 0;
+        long long failed = 0;   // changed versions that did not load
+        long long adopted = 0;  // models taken by the game
+    };
+
+private:
+    struct Stamp {
+        std::filesystem::file_time_type time{};
+        std::uintmax_t size = 0;
+        bool exists = false;
+
+        bool operator==(const Stamp& other) const {
+            return exists == other.exists && time == other.time && size == other.size;
+        }
+        bool operator!=(const Stamp& other) const {
+            return !(*this == other);
+        }
+    };
+
+    const std::string path;
+    const std::chrono::milliseconds interval;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::unique_ptr<FrequencyModel> staged;   // loaded, not yet adopted
+    std::unique_ptr<FrequencyModel> retired;  // replaced by take(), freed by the watcher
+    std::atomic<uint64_t> published{0};
+    bool pollRequested = false;
+    bool stopping = false;
+    Stats stats;
+    std::thread watcher;
+
+    // Game thread only.
+    uint64_t adoptedVersion = 0;
+
+    Stamp readStamp() const {
+        Stamp stamp;
+        std::error_code error;
+        stamp.time = std::filesystem::last_write_time(path, error);
+        if (error) {
+            return stamp;
+        }
+        stamp.size = std::filesystem::file_size(path, error);
+        stamp.exists = !error;
+        return stamp;
+    }
+
+    void run(Stamp loaded) {
+        Stamp pending = loaded;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait_for(lock, interval, [this] { return stopping || pollRequested || retired; });
+            if (stopping) {
+                return;
+            }
+            std::unique_ptr<FrequencyModel> old = std::move(retired);
+            pollRequested = false;
+            stats.polls++;
+            lock.unlock();
+
+            old.reset();
+            Stamp now = readStamp();
+            if (now.exists && now != loaded) {
+                if (now != pending) {
+                    pending = now;  // still changing, or just changed: look again next poll
+                } else {
+                    auto model = std::make_unique<FrequencyModel>();
+                    bool ok = FrequencyFileReader::load(path, *model) == FrequencyFileReader::Status::Ok;
+                    loaded = now;
+                    lock.lock();
+                    if (ok) {
+                        std::swap(staged, model);  // an unadopted older version is freed below
+                        published.fetch_add(1, std::memory_order_release);
+                        stats.loads++;
+                    } else {
+                        stats.failed++;
+                    }
+                    lock.unlock();
+                }
+            }
+            lock.lock();
+        }
+    }
+
+public:
+    // The caller has already loaded the current version of 'modelPath'; only
+    // later versions are reloaded.
+    explicit ModelReloader(const std::string& modelPath,
+                           std::chrono::milliseconds pollInterval = std::chrono::milliseconds(1000))
+        : path(modelPath), interval(pollInterval) {
+        watcher = std::thread(&ModelReloader::run, this, readStamp());
+    }
+
+    ModelReloader(const ModelReloader&) = delete;
+    ModelReloader& operator=(const ModelReloader&) = delete;
+
+    ~ModelReloader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        watcher.join();
+    }
+
+    // Swap in the newest loaded model, if there is one the game has not taken
+    // yet. Returns whether 'model' was replaced. Call from the game thread.
+    bool take(FrequencyModel& model) {
+        if (published.load(std::memory_order_acquire) == adoptedVersion) {
+            return false;
+        }
+        // The previous model must have been freed by the watcher first, so it
+        // is never freed on this thread.
+        std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+        if (!lock.owns_lock() || !staged || retired) {
+            return false;
+        }
+        std::swap(model, *staged);
+        retired = std::move(staged);
+        adoptedVersion = published.load(std::memory_order_relaxed);
+        stats.adopted++;
+        lock.unlock();
+        wake.notify_one();
+        return true;
+    }
+
+    // Poll now instead of at the end of the interval.
+    void pollNow() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pollRequested = true;
+        }
+        wake.notify_one();
+    }
+
+    // Versions published so far, and the one the game last took (game
+    // thread only). Neither takes the lock.
+    uint64_t getPublishedVersion() const {
+        return published.load(std::memory_order_acquire);
+    }
+
+    uint64_t getAdoptedVersion() const {
+        return adoptedVersion;
+    }
+
+    const std::string& getPath() const {
+        return path;
+    }
+
+    Stats getStats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+};
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef MODEL_SAVER_H
+#define MODEL_SAVER_H
+
+#include "FrequencyFileWriter.h"
+#include "FrequencyModel.h"
+#include "SharedModelFile.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+// Writes model snapshots to disk on a background thread, so the game keeps
+// playing while a large model is persisted.
+//
+// Jobs run in submission order. Any number of snapshots can be queued; a job
+// that has not started yet is replaced when a newer snapshot for the same
+// path arrives, since only the newest one would survive on disk anyway. The
+// worker thread is started on the first submit, and the destructor waits for
+// every queued job.
+//
+// A job can also merge into the file instead of replacing it (submitMerge,
+// see SharedModelFile). When a newer merge replaces a queued one, the
+// queued job's base is kept, so the replacement still carries every change
+// since that base. Only the last queued job for a path is replaced, and only
+// by a job of the same kind: a plain write and a merge do different things
+// to the file, so both stay queued, in order.
+class ModelSaver {
+public:
+    struct Stats {
+        long long submitted = 0;
+        long long written = 0;
+        long long failed = 0;
+        long long superseded = 0;  // dropped in favour of a newer snapshot
+    };
+
+private:
+    struct Job {
+        FrequencyModel::Snapshot snapshot;
+        std::string path;
+        ModelFileFormat format;
+        bool merge = false;
+        FrequencyModel::Snapshot base;  // merge jobs: what the file had from this model
+    };
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable idle;
+    std::deque<Job> queue;
+    bool busy = false;
+    std::string busyPath;  // path of the job being written
+    bool stopping = false;
+    Stats stats;
+    std::thread worker;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            workAvailable.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            Job job = std::move(queue.front());
+            queue.pop_front();
+            busy = true;
+            busyPath = job.path;
+            lock.unlock();
+
+            bool ok = job.merge ? SharedModelFile::save(job.base, job.snapshot, job.path, job.format)
+                                : FrequencyFileWriter::write(job.snapshot, job.path, job.format);
+            job = Job();  // release the shared chunks before reporting
+
+            lock.lock();
+            busy = false;
+            busyPath.clear();
+            if (ok) {
+                stats.written++;
+            } else {
+                stats.failed++;
+            }
+            idle.notify_all();
+        }
+    }
+
+public:
+    ModelSaver() = default;
+    ModelSaver(const ModelSaver&) = delete;
+    ModelSaver& operator=(const ModelSaver&) = delete;
+
+    ~ModelSaver() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        workAvailable.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    void submit(FrequencyModel::Snapshot snapshot, const std::string& path,
+                ModelFileFormat format = ModelFileFormat::Text) {
+        enqueue({std::move(snapshot), path, format, false, {}});
+    }
+
+    // Merge the changes from 'base' to 'snapshot' into the file at 'path'.
+    void submitMerge(FrequencyModel::Snapshot base, FrequencyModel::Snapshot snapshot, const std::string& path,
+                     ModelFileFormat format = ModelFileFormat::Text) {
+        enqueue({std::move(snapshot), path, format, true, std::move(base)});
+    }
+
+private:
+    void enqueue(Job job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.submitted++;
+            bool replaced = false;
+            for (auto queued = queue.rbegin(); queued != queue.rend(); ++queued) {
+                if (queued->path != job.path) {
+                    continue;
+                }
+                if (queued->merge == job.merge) {
+                    // Two merges keep the older base.
+                    queued->snapshot = std::move(job.snapshot);
+                    queued->format = job.format;
+                    stats.superseded++;
+                    replaced = true;
+                }
+                break;
+            }
+            if (!replaced) {
+                queue.push_back(std::move(job));
+            }
+            if (!worker.joinable()) {
+                worker = std::thread(&ModelSaver::run, this);
+            }
+        }
+        workAvailable.notify_one();
+    }
+
+public:
+    // Block until every submitted snapshot has been written.
+    void waitIdle() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return queue.empty() && !busy; });
+    }
+
+    // Block until no snapshot for 'path' is queued or being written.
+    void waitFor(const std::string& path) {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this, &path] {
+            if (busy && busyPath == path) return false;
+            for (const Job& queued : queue) {
+                if (queued.path == path) return false;
+            }
+            return true;
+        });
+    }
+
+    // Snapshots queued or being written.
+    std::size_t pending() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.size() + (busy ? 1 : 0);
+    }
+
+    Stats getStats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+};
+
+#endif
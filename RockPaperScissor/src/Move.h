@@ -1,59 +1,68 @@
 #ifndef MOVE_H
 #define MOVE_H
 
+#include "MoveSet.h"
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 
-enum class Move {
-    ROCK,
-    PAPER,
-    SCISSORS
-};
+// The game's moves. Everything below is Rock-Paper-Scissors' MoveRules
+// under the names the rest of the code uses; code written for any move set
+// takes the set as a template parameter and uses MoveRules<Set> directly.
+using Move = RockPaperScissors::Move;
 
 // Convert a character input to a Move
 inline Move charToMove(char c) {
-    switch (c) {
-        case 'R':
-        case 'r':
-            return Move::ROCK;
-        case 'P':
-        case 'p':
-            return Move::PAPER;
-        case 'S':
-        case 's':
-            return Move::SCISSORS;
-        default:
-            throw std::invalid_argument("Invalid move character");
+    int move = ClassicRules::fromChar(c);
+    if (move < 0) {
+        throw std::invalid_argument("Invalid move character");
     }
+    return static_cast<Move>(move);
+}
+
+// Name of a move for display. The round paths use these rather than
+// moveToString so that printing a move never builds a string.
+constexpr std::string_view moveName(Move move) {
+    return ClassicRules::name(move);
+}
+
+constexpr std::string_view moveNameUpper(Move move) {
+    return ClassicRules::nameUpper(move);
 }
 
 // Convert a Move to a string for display
 inline std::string moveToString(Move move) {
-    switch (move) {
-        case Move::ROCK:
-            return "Rock";
-        case Move::PAPER:
-            return "Paper";
-        case Move::SCISSORS:
-            return "Scissors";
-        default:
-            return "Unknown";
-    }
+    return std::string(moveName(move));
 }
 
-// Determine the winner given two moves
-inline int determineWinner(Move playerMove, Move computerMove) {
-    if (playerMove == computerMove) {
-        return 0; // Tie
-    }
-    
-    if ((playerMove == Move::ROCK && computerMove == Move::SCISSORS) ||
-        (playerMove == Move::PAPER && computerMove == Move::ROCK) ||
-        (playerMove == Move::SCISSORS && computerMove == Move::PAPER)) {
-        return 1; // Player wins
-    }
-    
-    return -1; // Computer wins
+// The move that beats 'move'.
+constexpr Move counterMove(Move move) {
+    return ClassicRules::counter(move);
+}
+
+// Encode one round (human move, computer move) as a single number in 0..8.
+constexpr int roundCode(Move humanMove, Move computerMove) {
+    return ClassicRules::roundCode(humanMove, computerMove);
+}
+
+// Determine the winner given two moves: 1 player, -1 computer, 0 tie.
+constexpr int determineWinner(Move playerMove, Move computerMove) {
+    return ClassicRules::winner(playerMove, computerMove);
+}
+
+// A determineWinner result as the strategies' round logs print it.
+constexpr std::string_view winnerName(int result) {
+    return result > 0 ? "HUMAN" : (result < 0 ? "COMPUTER" : "TIE");
+}
+
+// Bit c is set when a round with roundCode c has the given determineWinner result.
+constexpr unsigned int roundCodesWithOutcome(int outcome) {
+    return static_cast<unsigned int>(ClassicRules::roundCodesWithOutcome(outcome));
 }
 
+static_assert(determineWinner(Move::ROCK, Move::SCISSORS) == 1, "rock beats scissors");
+static_assert(determineWinner(Move::PAPER, Move::SCISSORS) == -1, "scissors beat paper");
+static_assert(determineWinner(counterMove(Move::SCISSORS), Move::SCISSORS) == 1, "counter move wins");
+
 #endif
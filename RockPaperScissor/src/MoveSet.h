@@ -0,0 +1,232 @@
+#ifndef MOVE_SET_H
+#define MOVE_SET_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// Move sets the engine can be built for. A descriptor names its moves, the
+// letter each is typed as, and which move beats which; everything else
+// (payoffs, counter moves, round codes, key sizes) is derived from it at
+// compile time by MoveRules. Adding a variant is adding a descriptor.
+//
+// A descriptor provides:
+//   enum class Move          the moves, numbered from 0
+//   COUNT                    the number of moves
+//   NAMES, NAMES_UPPER       display names, and as the round logs print them
+//   LETTERS                  input letter of each move (matched in any case)
+//   BEATS[a][b]              true when move a beats move b
+
+// Classic Rock-Paper-Scissors.
+struct RockPaperScissors {
+    enum class Move {
+        ROCK,
+        PAPER,
+        SCISSORS
+    };
+
+    static constexpr int COUNT = 3;
+    static constexpr const char* NAMES[COUNT] = {"Rock", "Paper", "Scissors"};
+    static constexpr const char* NAMES_UPPER[COUNT] = {"ROCK", "PAPER", "SCISSORS"};
+    static constexpr char LETTERS[COUNT] = {'R', 'P', 'S'};
+    static constexpr bool BEATS[COUNT][COUNT] = {
+        {false, false, true},   // Rock blunts Scissors
+        {true, false, false},   // Paper covers Rock
+        {false, true, false},   // Scissors cut Paper
+    };
+};
+
+// Rock-Paper-Scissors-Lizard-Spock. Spock is typed K, since S is taken.
+struct RockPaperScissorsLizardSpock {
+    enum class Move {
+        ROCK,
+        PAPER,
+        SCISSORS,
+        LIZARD,
+        SPOCK
+    };
+
+    static constexpr int COUNT = 5;
+    static constexpr const char* NAMES[COUNT] = {"Rock", "Paper", "Scissors", "Lizard", "Spock"};
+    static constexpr const char* NAMES_UPPER[COUNT] = {"ROCK", "PAPER", "SCISSORS", "LIZARD", "SPOCK"};
+    static constexpr char LETTERS[COUNT] = {'R', 'P', 'S', 'L', 'K'};
+    static constexpr bool BEATS[COUNT][COUNT] = {
+        {false, false, true, true, false},   // Rock crushes Scissors and Lizard
+        {true, false, false, false, true},   // Paper covers Rock, disproves Spock
+        {false, true, false, true, false},   // Scissors cut Paper, decapitate Lizard
+        {false, true, false, false, true},   // Lizard eats Paper, poisons Spock
+        {true, false, true, false, false},   // Spock vaporizes Rock, smashes Scissors
+    };
+};
+
+// The rules of a move set, derived from its descriptor. Everything here is
+// constexpr, so code templated on a move set compiles to the same table
+// lookups as code written for one.
+template <typename MoveSet>
+class MoveRules {
+public:
+    using Move = typename MoveSet::Move;
+
+    static constexpr int COUNT = MoveSet::COUNT;
+
+    // A round (human move, computer move) as one number in 0..ROUND_CODES-1.
+    static constexpr int ROUND_CODES = COUNT * COUNT;
+
+private:
+    static constexpr int bitsFor(int values) {
+        int bits = 1;
+        while ((1 << bits) < values) {
+            ++bits;
+        }
+        return bits;
+    }
+
+    // Most rounds whose codes, read as a base-ROUND_CODES number, fit in 64 bits.
+    static constexpr int maxKeyRounds() {
+        int rounds = 0;
+        for (uint64_t span = 1; span <= UINT64_MAX / ROUND_CODES; span *= ROUND_CODES) {
+            ++rounds;
+        }
+        return rounds;
+    }
+
+    static constexpr std::array<std::array<int8_t, COUNT>, COUNT> makePayoff() {
+        std::array<std::array<int8_t, COUNT>, COUNT> payoff{};
+        for (int human = 0; human < COUNT; ++human) {
+            for (int computer = 0; computer < COUNT; ++computer) {
+                payoff[human][computer] = MoveSet::BEATS[human][computer] ? 1
+                                          : (MoveSet::BEATS[computer][human] ? -1 : 0);
+            }
+        }
+        return payoff;
+    }
+
+    // The lowest move that beats each move, or the move itself if none does.
+    static constexpr std::array<Move, COUNT> makeCounters() {
+        std::array<Move, COUNT> counters{};
+        for (int move = 0; move < COUNT; ++move) {
+            counters[move] = static_cast<Move>(move);
+            for (int other = COUNT - 1; other >= 0; --other) {
+                if (MoveSet::BEATS[other][move]) {
+                    counters[move] = static_cast<Move>(other);
+                }
+            }
+        }
+        return counters;
+    }
+
+    // Move index by input character, -1 for characters that are not a move.
+    static constexpr std::array<int8_t, 256> makeCharMoves() {
+        std::array<int8_t, 256> moves{};
+        for (int8_t& move : moves) {
+            move = -1;
+        }
+        for (int move = 0; move < COUNT; ++move) {
+            char letter = MoveSet::LETTERS[move];
+            moves[static_cast<unsigned char>(letter)] = static_cast<int8_t>(move);
+            if (letter >= 'A' && letter <= 'Z') {
+                moves[static_cast<unsigned char>(letter - 'A' + 'a')] = static_cast<int8_t>(move);
+            }
+        }
+        return moves;
+    }
+
+    // Every pair of different moves has a winner, no move beats itself, every
+    // move can be beaten and letters are distinct (case-insensitively).
+    static constexpr bool isValid() {
+        for (int a = 0; a < COUNT; ++a) {
+            bool beaten = false;
+            for (int b = 0; b < COUNT; ++b) {
+                if (a != b && MoveSet::BEATS[a][b] == MoveSet::BEATS[b][a]) {
+                    return false;
+                }
+                beaten = beaten || MoveSet::BEATS[b][a];
+                char la = MoveSet::LETTERS[a] | 0x20;
+                char lb = MoveSet::LETTERS[b] | 0x20;
+                if (a != b && la == lb) {
+                    return false;
+                }
+            }
+            if (MoveSet::BEATS[a][a] || !beaten) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    // Bits that hold a move index, and one bit per move for a move mask.
+    static constexpr int MOVE_BITS = bitsFor(COUNT);
+    static constexpr int MASK_BITS = COUNT;
+
+    // Rounds a 64-bit context key holds (20 for Rock-Paper-Scissors).
+    static constexpr int MAX_KEY_ROUNDS = maxKeyRounds();
+
+    // Round outcome from the human's side, indexed [human][computer]:
+    // 1 when the human wins, -1 when the computer wins, 0 for a tie.
+    static constexpr std::array<std::array<int8_t, COUNT>, COUNT> PAYOFF = makePayoff();
+
+    static constexpr std::array<Move, COUNT> COUNTERS = makeCounters();
+
+    static constexpr std::array<int8_t, 256> CHAR_MOVES = makeCharMoves();
+
+    static_assert(COUNT >= 2, "a move set needs at least two moves");
+    static_assert(ROUND_CODES <= 64, "round outcomes are kept as 64-bit code masks");
+    static_assert(isValid(), "every pair of moves needs exactly one winner, and letters must differ");
+
+    // Determine the winner given two moves: 1 player, -1 computer, 0 tie.
+    static constexpr int winner(Move playerMove, Move computerMove) {
+        return PAYOFF[static_cast<int>(playerMove)][static_cast<int>(computerMove)];
+    }
+
+    // A move that beats 'move'; the lowest one where several do.
+    static constexpr Move counter(Move move) {
+        return COUNTERS[static_cast<int>(move)];
+    }
+
+    static constexpr int roundCode(Move humanMove, Move computerMove) {
+        return static_cast<int>(humanMove) * COUNT + static_cast<int>(computerMove);
+    }
+
+    // Index of the move typed as 'c', or -1.
+    static constexpr int fromChar(char c) {
+        return CHAR_MOVES[static_cast<unsigned char>(c)];
+    }
+
+    static constexpr std::string_view name(Move move) {
+        int index = static_cast<int>(move);
+        return (index >= 0 && index < COUNT) ? MoveSet::NAMES[index] : "Unknown";
+    }
+
+    static constexpr std::string_view nameUpper(Move move) {
+        int index = static_cast<int>(move);
+        return (index >= 0 && index < COUNT) ? MoveSet::NAMES_UPPER[index] : "UNKNOWN";
+    }
+
+    // Bit c is set when a round with roundCode c has the given winner() result.
+    static constexpr uint64_t roundCodesWithOutcome(int outcome) {
+        uint64_t codes = 0;
+        for (int human = 0; human < COUNT; ++human) {
+            for (int computer = 0; computer < COUNT; ++computer) {
+                if (PAYOFF[human][computer] == outcome) {
+                    codes |= uint64_t(1) << (human * COUNT + computer);
+                }
+            }
+        }
+        return codes;
+    }
+};
+
+using ClassicRules = MoveRules<RockPaperScissors>;
+using LizardSpockRules = MoveRules<RockPaperScissorsLizardSpock>;
+
+static_assert(ClassicRules::MAX_KEY_ROUNDS == 20, "9^20 < 2^64");
+static_assert(LizardSpockRules::MAX_KEY_ROUNDS == 13, "25^13 < 2^64");
+static_assert(LizardSpockRules::winner(RockPaperScissorsLizardSpock::Move::SPOCK,
+                                       RockPaperScissorsLizardSpock::Move::ROCK) == 1,
+              "Spock vaporizes Rock");
+static_assert(LizardSpockRules::winner(RockPaperScissorsLizardSpock::Move::LIZARD,
+                                       RockPaperScissorsLizardSpock::Move::ROCK) == -1,
+              "Rock crushes Lizard");
+
+#endif
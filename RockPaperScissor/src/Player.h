@@ -8,6 +8,12 @@ public:
     virtual ~Player() = default;
     virtual Move makeMove() = 0;
     virtual void recordResult(Move playerMove, Move opponentMove) = 0;
+
+    // Players fed from a finite source (e.g. a script) report when they have
+    // no moves left so the game can end early. Interactive players never run out.
+    virtual bool isExhausted() {
+        return false;
+    }
 };
 
 #endif
@@ -0,0 +1,191 @@
+#ifndef PREDICTION_CACHE_H
+#define PREDICTION_CACHE_H
+
+#include "Move.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// SmartStrategy's aggregated predictions by combined context. A combined
+// context is the rounds its longest order looks at. The context of every
+// shorter order is a suffix of it, so it fixes the summed counts, and the
+// entry holds the move they predicted.
+//
+// Playing a round increments one context per order, all suffixes of the
+// combined context just played, and all for the human's move. The only
+// aggregates that can change are those of combined contexts ending in the
+// same rounds as the shortest order's context. These form one bucket, and
+// the cache counts the rounds of each bucket by human move.
+//
+// An entry keeps those counts as they were when it was stored, and how far
+// the predicted move was ahead of each other move. Say d[m] more rounds of
+// move m have been played in the bucket since. Then the predicted move has
+// gained at least d[best] from the shortest order, and any other move at
+// most 'orders' * d[m]. While the lead covers that, the prediction cannot
+// have changed and the entry answers without looking at the counts. The
+// strategy stores the entry of the context it has just updated again, from
+// the counts it has at hand; the rest are recomputed when they no longer
+// answer.
+//
+// This assumes counts only grow, so the strategy clears the cache when
+// counters may have been halved. The table is direct-mapped, 10 KiB,
+// allocated by the first store; a context that lost its slot to another
+// is recomputed as well. Against an opponent whose contexts rarely repeat,
+// such as a random one, almost every lookup misses: if fewer than 1 in
+// MIN_HIT_RATIO lookups of a WINDOW hit, the cache is bypassed for
+// BYPASS_ROUNDS predictions and then tried again.
+class PredictionCache {
+public:
+    struct Stats {
+        long long lookups = 0;
+        long long hits = 0;
+        long long bypassed = 0;  // predictions made while bypassed
+    };
+
+private:
+    static constexpr int SLOT_BITS = 8;
+    static constexpr int WINDOW = 1024;
+    static constexpr int MIN_HIT_RATIO = 16;
+    static constexpr int BYPASS_ROUNDS = 8 * WINDOW;
+    static constexpr uint64_t NO_KEY = ~uint64_t(0);  // above any 20-round key
+    static constexpr int MOVES = ClassicRules::COUNT;
+
+    struct Entry {
+        uint64_t key = NO_KEY;
+        uint32_t rounds[MOVES] = {};  // the bucket's rounds by move when stored
+        uint32_t lead[MOVES] = {};    // summed count of 'move' minus that of each move
+        Move move = Move::ROCK;
+        bool valid = false;  // false when no order had data; the strategy plays randomly
+    };
+
+    int orders;
+    std::vector<Entry> entries;  // empty until the first store
+    std::vector<uint32_t> bucketRounds;  // MOVES per bucket, by human move; wraps harmlessly
+    Stats stats;
+    int windowLookups = 0;
+    int windowHits = 0;
+    int bypassLeft = 0;
+
+    static std::size_t slotOf(uint64_t key) {
+        return static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ULL) >> (64 - SLOT_BITS));
+    }
+
+    uint32_t* roundsOf(uint64_t key) {
+        return &bucketRounds[static_cast<std::size_t>(key % (bucketRounds.size() / MOVES)) * MOVES];
+    }
+
+    // Whether the entry's move is still the prediction, given the rounds its
+    // bucket has seen since it was stored.
+    bool isCurrent(const Entry& entry, const uint32_t* rounds) const {
+        int64_t since[MOVES];
+        bool anySince = false;
+        for (int m = 0; m < MOVES; ++m) {
+            since[m] = static_cast<uint32_t>(rounds[m] - entry.rounds[m]);
+            anySince = anySince || since[m] != 0;
+        }
+        if (!entry.valid) {
+            // Any round may have added the first context.
+            return !anySince;
+        }
+        int best = static_cast<int>(entry.move);
+        for (int m = 0; m < MOVES; ++m) {
+            if (m == best) {
+                continue;
+            }
+            int64_t worstLead = entry.lead[m] + since[best] - orders * since[m];
+            // A tie still goes to the lower move.
+            if (worstLead < 0 || (worstLead == 0 && m < best)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    // shortestRounds: rounds in the shortest order's context; orderCount:
+    // the number of orders whose counts are summed.
+    PredictionCache(int shortestRounds, int orderCount)
+        : orders(orderCount) {
+        std::size_t buckets = 1;
+        for (int i = 0; i < shortestRounds; ++i) {
+            buckets *= ClassicRules::ROUND_CODES;
+        }
+        bucketRounds.assign(buckets * MOVES, 0);
+    }
+
+    // Whether the next prediction should go through the cache. Counts down a
+    // bypass; call once per prediction.
+    bool beginPrediction() {
+        if (bypassLeft > 0) {
+            bypassLeft--;
+            stats.bypassed++;
+            return false;
+        }
+        return true;
+    }
+
+    // Whether stores are worth making.
+    bool isBypassed() const {
+        return bypassLeft > 0;
+    }
+
+    // The cached prediction for a combined context, if it is current.
+    bool lookup(uint64_t key, Move& move, bool& valid) {
+        stats.lookups++;
+        bool hit = false;
+        if (!entries.empty()) {
+            const Entry& entry = entries[slotOf(key)];
+            hit = entry.key == key && isCurrent(entry, roundsOf(key));
+            if (hit) {
+                stats.hits++;
+                windowHits++;
+                move = entry.move;
+                valid = entry.valid;
+            }
+        }
+        if (++windowLookups == WINDOW) {
+            if (windowHits * MIN_HIT_RATIO < WINDOW) {
+                bypassLeft = BYPASS_ROUNDS;
+            }
+            windowLookups = 0;
+            windowHits = 0;
+        }
+        return hit;
+    }
+
+    // Cache the prediction 'move' made from the summed counts 'aggregated'.
+    void store(uint64_t key, Move move, const int64_t aggregated[MOVES], bool valid) {
+        if (entries.empty()) {
+            entries.resize(std::size_t(1) << SLOT_BITS);
+        }
+        Entry& entry = entries[slotOf(key)];
+        const uint32_t* rounds = roundsOf(key);
+        entry.key = key;
+        for (int m = 0; m < MOVES; ++m) {
+            entry.rounds[m] = rounds[m];
+            entry.lead[m] = valid ? static_cast<uint32_t>(aggregated[static_cast<int>(move)] - aggregated[m]) : 0;
+        }
+        entry.move = move;
+        entry.valid = valid;
+    }
+
+    // A round was counted for 'humanMove' after 'key', a context of at least
+    // the shortest order's rounds.
+    void recordRound(uint64_t key, Move humanMove) {
+        roundsOf(key)[static_cast<int>(humanMove)]++;
+    }
+
+    // Drop every entry, for when the model is replaced or its counters were
+    // halved. The bypass state is kept; it describes the opponent, not the model.
+    void clear() {
+        for (Entry& entry : entries) {
+            entry = Entry();
+        }
+    }
+
+    const Stats& getStats() const {
+        return stats;
+    }
+};
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef PROFILE_STORE_H
+#define PROFILE_STORE_H
+
+#include "FrequencyFileReader.h"
+#include "FrequencyModel.h"
+#include "ModelSaver.h"
+#include <cstddef>
+#include <filesystem>
+#include <iostream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+// Per-player SmartStrategy models ("profiles").
+//
+// Each player's model is kept in its own file, <directory>/<player>.freq.txt,
+// in the freq.txt format (or the compact format, see setFileFormat). A strategy checks a profile out while it plays
+// against that player and checks it back in afterwards. Checked-in profiles
+// stay in memory in least-recently-used order until their total size goes
+// over the memory cap. The coldest profiles are then spilled to their files
+// by a background ModelSaver and dropped. A profile that is not resident is
+// loaded from its file on demand.
+//
+// A profile can be checked out by one strategy at a time. The store is not
+// thread safe; share it between strategies of one thread.
+class ProfileStore {
+public:
+    struct Stats {
+        long long checkouts = 0;
+        long long hits = 0;       // checkouts served from memory
+        long long loads = 0;      // checkouts read from a profile file
+        long long created = 0;    // checkouts of players with no profile yet
+        long long writes = 0;     // profiles written to their files (evictions and flushes)
+        long long evictions = 0;  // profiles dropped from memory
+        std::size_t peakResidentBytes = 0;
+    };
+
+private:
+    struct Entry {
+        FrequencyModel model;
+        std::size_t bytes = 0;
+        bool dirty = false;  // changed since it was last written
+        std::list<std::string>::iterator position;
+    };
+
+    std::string directory;
+    std::size_t memoryCap;
+    std::unordered_map<std::string, Entry> resident;  // checked-in profiles
+    std::list<std::string> lru;                       // most recently used first
+    std::unordered_set<std::string> checkedOut;
+    std::size_t residentBytes = 0;
+    ModelFileFormat fileFormat = ModelFileFormat::Text;
+    Stats stats;
+    ModelSaver saver;
+
+    void submitSpill(const std::string& playerId, Entry& entry) {
+        saver.submit(entry.model.snapshot(), profilePath(playerId), fileFormat);
+        entry.dirty = false;
+        stats.writes++;
+    }
+
+    // Drop least recently used profiles until the resident set fits the cap.
+    void enforceCap() {
+        while (residentBytes > memoryCap && !lru.empty()) {
+            const std::string playerId = lru.back();
+            auto it = resident.find(playerId);
+            if (it->second.dirty) {
+                submitSpill(playerId, it->second);
+            }
+            residentBytes -= it->second.bytes;
+            lru.pop_back();
+            resident.erase(it);
+            stats.evictions++;
+        }
+    }
+
+public:
+    // memoryCapBytes bounds the memory of checked-in profiles.
+    ProfileStore(const std::string& profileDirectory, std::size_t memoryCapBytes)
+        : directory(profileDirectory), memoryCap(memoryCapBytes) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error) {
+            std::cerr << "Failed to create profile directory " << directory << ": " << error.message() << std::endl;
+        }
+    }
+
+    ProfileStore(const ProfileStore&) = delete;
+    ProfileStore& operator=(const ProfileStore&) = delete;
+
+    ~ProfileStore() {
+        flush();
+    }
+
+    // Player ids become file names, so only letters, digits, '-' and '_' are allowed.
+    static bool isValidPlayerId(const std::string& playerId) {
+        if (playerId.empty() || playerId.size() > 64) {
+            return false;
+        }
+        for (char c : playerId) {
+            bool allowed = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                           c == '-' || c == '_';
+            if (!allowed) return false;
+        }
+        return true;
+    }
+
+    std::string profilePath(const std::string& playerId) const {
+        return (std::filesystem::path(directory) / (playerId + ".freq.txt")).string();
+    }
+
+    // Move the player's model into 'model'. Fails if the id is invalid or the
+    // profile is already checked out.
+    bool checkOut(const std::string& playerId, FrequencyModel& model) {
+        if (!isValidPlayerId(playerId)) {
+            std::cerr << "Invalid player id: " << playerId << std::endl;
+            return false;
+        }
+        if (checkedOut.count(playerId) > 0) {
+            std::cerr << "Profile " << playerId << " is already in use." << std::endl;
+            return false;
+        }
+        stats.checkouts++;
+        auto it = resident.find(playerId);
+        if (it != resident.end()) {
+            model = std::move(it->second.model);
+            residentBytes -= it->second.bytes;
+            lru.erase(it->second.position);
+            resident.erase(it);
+            stats.hits++;
+        } else {
+            // The file may still be queued for writing from an earlier eviction.
+            saver.waitFor(profilePath(playerId));
+            model.clear();
+            FrequencyFileReader::Status status = FrequencyFileReader::load(profilePath(playerId), model);
+            if (status == FrequencyFileReader::Status::Ok) {
+                stats.loads++;
+            } else {
+                if (status == FrequencyFileReader::Status::Invalid) {
+                    std::cerr << "Invalid profile file for " << playerId << ". Starting fresh." << std::endl;
+                }
+                model.clear();
+                stats.created++;
+            }
+        }
+        checkedOut.insert(playerId);
+        return true;
+    }
+
+    // Return a checked-out model. It stays in memory, marked as changed,
+    // until it is evicted or flushed.
+    void checkIn(const std::string& playerId, FrequencyModel model) {
+        if (checkedOut.erase(playerId) == 0) {
+            std::cerr << "Profile " << playerId << " was not checked out." << std::endl;
+            return;
+        }
+        lru.push_front(playerId);
+        Entry& entry = resident[playerId];
+        entry.bytes = model.memoryUsage();
+        entry.model = std::move(model);
+        entry.dirty = true;
+        entry.position = lru.begin();
+        residentBytes += entry.bytes;
+        enforceCap();
+        if (residentBytes > stats.peakResidentBytes) {
+            stats.peakResidentBytes = residentBytes;
+        }
+    }
+
+    // Write a checked-out model to its profile file in the background.
+    void save(const std::string& playerId, FrequencyModel& model) {
+        saver.submit(model.snapshot(), profilePath(playerId), fileFormat);
+    }
+
+    // Wait for the profile writes already submitted.
+    void waitIdle() {
+        saver.waitIdle();
+    }
+
+    // Write every changed resident profile and wait until all writes are done.
+    void flush() {
+        for (auto& item : resident) {
+            if (item.second.dirty) {
+                submitSpill(item.first, item.second);
+            }
+        }
+        saver.waitIdle();
+    }
+
+    void setMemoryCap(std::size_t memoryCapBytes) {
+        memoryCap = memoryCapBytes;
+        enforceCap();
+    }
+
+    // Format of the profile files written from now on. Either format loads.
+    void setFileFormat(ModelFileFormat format) {
+        fileFormat = format;
+    }
+
+    std::size_t getMemoryCap() const {
+        return memoryCap;
+    }
+
+    std::size_t getResidentBytes() const {
+        return residentBytes;
+    }
+
+    std::size_t getResidentCount() const {
+        return resident.size();
+    }
+
+    const Stats& getStats() const {
+        return stats;
+    }
+};
+
+#endif
@@ -4,28 +4,35 @@
 #include "Strategy.h"
 #include <cstdlib>
 #include <ctime>
+#include <random>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
-#include <cctype>
+#include <string>
 
 class RandomStrategy : public Strategy {
 private:
     std::ofstream outputFile;
+    std::mt19937 rng;
     int roundNumber;
     int humanWins;
     int computerWins;
     int ties;
 
 public:
-    RandomStrategy() {
-        // Seed the random number generator
-        std::srand(static_cast<unsigned int>(std::time(nullptr)));
-        
+    RandomStrategy() : RandomStrategy(static_cast<unsigned int>(std::time(nullptr))) {}
+
+    // Seeded constructor so scripted runs are reproducible.
+    explicit RandomStrategy(unsigned int seed) : RandomStrategy(seed, "output-random.txt") {}
+
+    // An empty logFile disables the per-round log, as for SmartStrategy.
+    RandomStrategy(unsigned int seed, const std::string& logFile) : rng(seed) {
         // Open output file in the same directory as freq.txt (build folder)
-        outputFile.open("output-random.txt");
-        if (!outputFile.is_open()) {
-            std::cerr << "Failed to open output-random.txt for writing." << std::endl;
+        if (!logFile.empty()) {
+            outputFile.open(logFile);
+            if (!outputFile.is_open()) {
+                std::cerr << "Failed to open " << logFile << " for writing." << std::endl;
+            }
         }
         
         // Initialize counters
@@ -42,19 +49,8 @@ public:
     }
     
     Move makeMove(const std::vector<std::pair<Move, Move>>& history) override {
-        // Generate a random number between 0 and 2
-        int randomNum = std::rand() % 3;
-        
-        switch (randomNum) {
-            case 0:
-                return Move::ROCK;
-            case 1:
-                return Move::PAPER;
-            case 2:
-                return Move::SCISSORS;
-            default:
-                return Move::ROCK; // Should never happen
-        }
+        // Each move with the same probability
+        return static_cast<Move>(std::uniform_int_distribution<int>(0, ClassicRules::COUNT - 1)(rng));
     }
     
     void updateFrequencies(const std::vector<std::pair<Move, Move>>& history) override {
@@ -72,33 +68,23 @@ public:
             
             // Determine winner
             int result = determineWinner(humanMove, computerMove);
-            std::string winner;
             
             if (result > 0) {
-                winner = "HUMAN";
                 humanWins++;
             } else if (result < 0) {
-                winner = "COMPUTER";
                 computerWins++;
             } else {
-                winner = "TIE";
                 ties++;
             }
             
             // Output round information to file
             if (outputFile.is_open()) {
-                outputFile << "Round " << roundNumber << std::endl;
+                outputFile << "Round " << roundNumber << '\n';
                 outputFile << "  HUMAN's choice? " << (humanMove == Move::ROCK ? "r" : 
-                                                     (humanMove == Move::PAPER ? "p" : "s")) << std::endl;
-                // Convert move strings to uppercase
-                std::string humanMoveStr = moveToString(humanMove);
-                std::string computerMoveStr = moveToString(computerMove);
-                for (char& c : humanMoveStr) c = std::toupper(c);
-                for (char& c : computerMoveStr) c = std::toupper(c);
-                
-                outputFile << "  HUMAN chose " << humanMoveStr << std::endl;
-                outputFile << "  COMPUTER chose " << computerMoveStr << std::endl;
-                outputFile << "  The winner is: " << winner << std::endl << std::endl;
+                                                     (humanMove == Move::PAPER ? "p" : "s")) << '\n';
+                outputFile << "  HUMAN chose " << moveNameUpper(humanMove) << '\n';
+                outputFile << "  COMPUTER chose " << moveNameUpper(computerMove) << '\n';
+                outputFile << "  The winner is: " << winnerName(result) << '\n' << '\n';
             }
         }
     }
@@ -110,14 +96,14 @@ public:
         if (outputFile.is_open()) {
             int totalRounds = humanWins + computerWins + ties;
             
-            outputFile << "Match stats" << std::endl;
-            outputFile << "-----------" << std::endl;
+            outputFile << "Match stats" << '\n';
+            outputFile << "-----------" << '\n';
             outputFile << "   Human wins: " << std::setw(5) << humanWins << "  " 
-                      << std::setw(3) << (totalRounds > 0 ? (humanWins * 100 / totalRounds) : 0) << "%" << std::endl;
+                      << std::setw(3) << (totalRounds > 0 ? (humanWins * 100 / totalRounds) : 0) << "%" << '\n';
             outputFile << "Computer wins: " << std::setw(5) << computerWins << "  " 
-                      << std::setw(3) << (totalRounds > 0 ? (computerWins * 100 / totalRounds) : 0) << "%" << std::endl;
+                      << std::setw(3) << (totalRounds > 0 ? (computerWins * 100 / totalRounds) : 0) << "%" << '\n';
             outputFile << "         Ties: " << std::setw(5) << ties << "  " 
-                      << std::setw(3) << (totalRounds > 0 ? (ties * 100 / totalRounds) : 0) << "%" << std::endl;
+                      << std::setw(3) << (totalRounds > 0 ? (ties * 100 / totalRounds) : 0) << "%" << '\n';
         }
     }
     
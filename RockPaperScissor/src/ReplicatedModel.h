@@ -0,0 +1,202 @@
+#ifndef REPLICATED_MODEL_H
+#define REPLICATED_MODEL_H
+
+#include "FrequencyModel.h"
+#include "Move.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// A frequency model learned by several worker threads at once, for
+// simulations that play many games in parallel.
+//
+// Each worker plays on a replica of its own: a copy of the global model plus
+// everything the worker has learned since. Updates never touch shared state,
+// so workers do not contend; each increment is also appended to the
+// replica's log, which costs no lookup. At the end of an epoch, while every
+// worker is stopped (at a std::barrier, say), the logs are replayed into the
+// global model and each replica is handed a fresh copy of it, which the
+// worker adopts on its next take(). Replaying increments in order gives the
+// counters exactly the saturation they would have had in one model.
+//
+// Broadcasting is cheap: the copies share the global model's arena chunks
+// copy-on-write (FrequencyModel::fork), so a worker copies only the chunks it
+// writes to, into memory allocated on its own thread. Replaying can be split
+// over the workers by sequence length, since tables of different lengths are
+// independent: beginMerge(), then mergePart() on each worker, then endMerge().
+// merge() does all three on one thread.
+//
+// Between merges a replica does not see what the other workers learned. That
+// staleness is measured: how many rounds a replica had not seen when its
+// epoch was merged, and how long epochs last.
+class ReplicatedModel {
+public:
+    struct Stats {
+        long long epochs = 0;
+        long long rounds = 0;        // rounds merged
+        long long increments = 0;    // counter increments merged
+        long long lagRounds = 0;     // rounds a replica had not seen at a merge, summed
+        long long maxLagRounds = 0;  // the most for one replica and epoch
+        double epochSeconds = 0;     // from one merge to the next, summed
+        double mergeSeconds = 0;     // from beginMerge() to the end of endMerge(), summed
+    };
+
+    // One worker's view. take(), record() and endRound() are for the
+    // worker's thread.
+    class Replica {
+    private:
+        friend class ReplicatedModel;
+
+        struct Update {
+            uint64_t key;
+            int32_t seqLen;
+            int32_t move;
+        };
+
+        std::vector<Update> log;  // increments since the last merge
+        long long logRounds = 0;
+        FrequencyModel incoming;  // the next model to adopt; after take(), the one it replaced
+        uint64_t incomingEpoch = 0;
+        uint64_t adoptedEpoch = 0;
+
+    public:
+        // Swap in the global model of the latest merge, if not taken yet.
+        // Returns whether 'model' was replaced. What the worker learned
+        // before that merge is already in the new model.
+        bool take(FrequencyModel& model) {
+            if (incomingEpoch == adoptedEpoch) {
+                return false;
+            }
+            std::swap(model, incoming);
+            adoptedEpoch = incomingEpoch;
+            return true;
+        }
+
+        // Log one increment the worker made to its model.
+        void record(int seqLen, uint64_t key, Move move) {
+            log.push_back({key, seqLen, static_cast<int32_t>(move)});
+        }
+
+        void endRound() {
+            logRounds++;
+        }
+
+        // Epoch of the global model the worker last took.
+        uint64_t getAdoptedEpoch() const {
+            return adoptedEpoch;
+        }
+    };
+
+private:
+    FrequencyModel global;
+    std::vector<std::unique_ptr<Replica>> replicas;
+    uint64_t epoch = 0;
+    Stats stats;
+    std::chrono::steady_clock::time_point epochStart = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point mergeStart;
+
+    void broadcast() {
+        epoch++;
+        for (auto& replica : replicas) {
+            replica->incoming = global.fork();
+            replica->incomingEpoch = epoch;
+        }
+    }
+
+public:
+    // Start 'replicaCount' replicas from 'initial'.
+    ReplicatedModel(FrequencyModel initial, std::size_t replicaCount) : global(std::move(initial)) {
+        for (std::size_t i = 0; i < std::max<std::size_t>(replicaCount, 1); ++i) {
+            replicas.push_back(std::make_unique<Replica>());
+        }
+        broadcast();
+    }
+
+    ReplicatedModel(const ReplicatedModel&) = delete;
+    ReplicatedModel& operator=(const ReplicatedModel&) = delete;
+
+    Replica& replica(std::size_t i) {
+        return *replicas[i];
+    }
+
+    std::size_t replicaCount() const {
+        return replicas.size();
+    }
+
+    // End an epoch on this thread. No worker may use its replica meanwhile.
+    void merge() {
+        beginMerge();
+        mergePart(0, 1);
+        endMerge();
+    }
+
+    // First step of a merge, on one thread while every worker is stopped.
+    void beginMerge() {
+        mergeStart = std::chrono::steady_clock::now();
+        stats.epochSeconds += std::chrono::duration<double>(mergeStart - epochStart).count();
+        long long epochRounds = 0;
+        for (auto& replica : replicas) {
+            // Models replaced at the last take() still share chunks with the
+            // global one; free them so the replay does not copy those chunks.
+            replica->incoming = FrequencyModel();
+            epochRounds += replica->logRounds;
+        }
+        for (auto& replica : replicas) {
+            long long unseen = epochRounds - replica->logRounds;
+            stats.lagRounds += unseen;
+            stats.maxLagRounds = std::max(stats.maxLagRounds, unseen);
+            stats.increments += static_cast<long long>(replica->log.size());
+            // Create the tables up front so the parts never touch shared state.
+            for (const Replica::Update& update : replica->log) {
+                if (global.contextCount(update.seqLen) == 0) {
+                    global.reserve(update.seqLen, 0);
+                }
+            }
+        }
+        stats.rounds += epochRounds;
+    }
+
+    // Replay the increments of the sequence lengths that are 'part' modulo
+    // 'parts'. The parts of one merge may run on different threads at once.
+    void mergePart(std::size_t part, std::size_t parts) {
+        for (auto& replica : replicas) {
+            for (const Replica::Update& update : replica->log) {
+                if (static_cast<std::size_t>(update.seqLen) % parts == part) {
+                    global.increment(update.seqLen, update.key, static_cast<Move>(update.move));
+                }
+            }
+        }
+    }
+
+    // Last step, on one thread once every part is done: start the next epoch
+    // and hand the replicas the merged model.
+    void endMerge() {
+        for (auto& replica : replicas) {
+            replica->log.clear();
+            replica->logRounds = 0;
+        }
+        stats.epochs++;
+        broadcast();
+        epochStart = std::chrono::steady_clock::now();
+        stats.mergeSeconds += std::chrono::duration<double>(epochStart - mergeStart).count();
+    }
+
+    // The model as of the last merge. Only stable while the workers are stopped.
+    const FrequencyModel& getGlobal() const {
+        return global;
+    }
+
+    uint64_t getEpoch() const {
+        return epoch;
+    }
+
+    const Stats& getStats() const {
+        return stats;
+    }
+};
+
+#endif
@@ -0,0 +1,230 @@
+#ifndef ROUND_SCORING_H
+#define ROUND_SCORING_H
+
+#include "Move.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RPS_SCORING_SSE2 1
+#endif
+
+// Scoring of recorded rounds in bulk, for offline analysis.
+//
+// Rounds are packed one byte each as roundCode(human, computer) (0..8). The
+// outcome of every code is a bit in a 9-bit mask, so the scalar path is a
+// shift and an add per round. The SIMD path classifies 16 (SSE2) or 32
+// (AVX2, when the build enables it) codes at once and keeps byte-wide
+// counters that are folded into 64-bit totals every 255 vectors. Codes
+// above 8 are not counted in any outcome.
+struct RoundTally {
+    uint64_t humanWins = 0;
+    uint64_t computerWins = 0;
+    uint64_t ties = 0;
+
+    uint64_t rounds() const {
+        return humanWins + computerWins + ties;
+    }
+
+    RoundTally& operator+=(const RoundTally& other) {
+        humanWins += other.humanWins;
+        computerWins += other.computerWins;
+        ties += other.ties;
+        return *this;
+    }
+
+    bool operator==(const RoundTally& other) const {
+        return humanWins == other.humanWins && computerWins == other.computerWins && ties == other.ties;
+    }
+};
+
+class RoundScoring {
+public:
+    static constexpr unsigned int HUMAN_WIN_CODES = roundCodesWithOutcome(1);
+    static constexpr unsigned int COMPUTER_WIN_CODES = roundCodesWithOutcome(-1);
+    static constexpr unsigned int TIE_CODES = roundCodesWithOutcome(0);
+
+    // The kernels match nine round codes, three per outcome.
+    static_assert(ClassicRules::ROUND_CODES == 9, "the scoring kernels are written for Rock-Paper-Scissors");
+
+private:
+#if defined(__AVX2__)
+    static constexpr std::size_t WIDTH = 32;
+    using Vector = __m256i;
+
+    // vpshufb table (per 128-bit lane) with 0xff at the outcome's codes.
+    struct OutcomeMatcher {
+        Vector table;
+    };
+
+    static OutcomeMatcher makeMatcher(unsigned int outcomeCodes) {
+        alignas(32) int8_t table[32] = {};
+        for (int code = 0; code < 9; ++code) {
+            table[code] = table[code + 16] = ((outcomeCodes >> code) & 1) ? -1 : 0;
+        }
+        return {_mm256_load_si256(reinterpret_cast<const Vector*>(table))};
+    }
+
+    // Per byte: 0xff where the code has the outcome. Codes are clamped to 15,
+    // whose table entry is 0, so larger ones match nothing.
+    static Vector match(const OutcomeMatcher& matcher, Vector codes) {
+        return _mm256_shuffle_epi8(matcher.table, _mm256_min_epu8(codes, _mm256_set1_epi8(15)));
+    }
+
+    // Per byte: 0xff where the code is a round code (0..8).
+    static Vector matchValid(Vector codes) {
+        return _mm256_cmpeq_epi8(_mm256_min_epu8(codes, _mm256_set1_epi8(8)), codes);
+    }
+
+    static Vector load(const uint8_t* codes) {
+        return _mm256_loadu_si256(reinterpret_cast<const Vector*>(codes));
+    }
+
+    static Vector zero() {
+        return _mm256_setzero_si256();
+    }
+
+    static Vector subtract(Vector a, Vector b) {
+        return _mm256_sub_epi8(a, b);
+    }
+
+    static uint64_t sumBytes(Vector counters) {
+        Vector sums = _mm256_sad_epu8(counters, _mm256_setzero_si256());
+        return static_cast<uint64_t>(_mm256_extract_epi64(sums, 0)) +
+               static_cast<uint64_t>(_mm256_extract_epi64(sums, 1)) +
+               static_cast<uint64_t>(_mm256_extract_epi64(sums, 2)) +
+               static_cast<uint64_t>(_mm256_extract_epi64(sums, 3));
+    }
+#elif defined(RPS_SCORING_SSE2)
+    static constexpr std::size_t WIDTH = 16;
+    using Vector = __m128i;
+
+    // The three codes of an outcome, each broadcast to every byte.
+    struct OutcomeMatcher {
+        Vector codes[3];
+    };
+
+    static OutcomeMatcher makeMatcher(unsigned int outcomeCodes) {
+        OutcomeMatcher matcher;
+        int found = 0;
+        for (int code = 0; code < 9 && found < 3; ++code) {
+            if ((outcomeCodes >> code) & 1) {
+                matcher.codes[found++] = _mm_set1_epi8(static_cast<char>(code));
+            }
+        }
+        return matcher;
+    }
+
+    // Per byte: 0xff where the code has the outcome.
+    static Vector match(const OutcomeMatcher& matcher, Vector codes) {
+        return _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(codes, matcher.codes[0]), _mm_cmpeq_epi8(codes, matcher.codes[1])),
+                            _mm_cmpeq_epi8(codes, matcher.codes[2]));
+    }
+
+    static Vector matchValid(Vector codes) {
+        return _mm_cmpeq_epi8(_mm_min_epu8(codes, _mm_set1_epi8(8)), codes);
+    }
+
+    static Vector load(const uint8_t* codes) {
+        return _mm_loadu_si128(reinterpret_cast<const Vector*>(codes));
+    }
+
+    static Vector zero() {
+        return _mm_setzero_si128();
+    }
+
+    static Vector subtract(Vector a, Vector b) {
+        return _mm_sub_epi8(a, b);
+    }
+
+    static uint64_t sumBytes(Vector counters) {
+        Vector sums = _mm_sad_epu8(counters, _mm_setzero_si128());
+        return static_cast<uint64_t>(_mm_cvtsi128_si32(sums)) +
+               static_cast<uint64_t>(_mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+    }
+#endif
+
+public:
+    // Branchless scalar scoring; also scores the tail the vector loop leaves.
+    static RoundTally scoreScalar(const uint8_t* codes, std::size_t count) {
+        RoundTally tally;
+        for (std::size_t i = 0; i < count; ++i) {
+            unsigned int code = codes[i] < 9 ? codes[i] : 31;  // 31 is in no mask
+            tally.humanWins += (HUMAN_WIN_CODES >> code) & 1;
+            tally.computerWins += (COMPUTER_WIN_CODES >> code) & 1;
+            tally.ties += (TIE_CODES >> code) & 1;
+        }
+        return tally;
+    }
+
+    static RoundTally score(const uint8_t* codes, std::size_t count) {
+        RoundTally tally;
+        std::size_t i = 0;
+#if defined(__AVX2__) || defined(RPS_SCORING_SSE2)
+        // Computer wins are the valid codes that are neither of the others.
+        const OutcomeMatcher winMatcher = makeMatcher(HUMAN_WIN_CODES);
+        const OutcomeMatcher tieMatcher = makeMatcher(TIE_CODES);
+        while (count - i >= WIDTH) {
+            // A match is -1 per byte, so subtracting it counts up; the byte
+            // counters are folded before they can pass 255.
+            std::size_t vectors = std::min<std::size_t>((count - i) / WIDTH, 255);
+            Vector wins = zero();
+            Vector ties = zero();
+            Vector valid = zero();
+            for (std::size_t v = 0; v < vectors; ++v, i += WIDTH) {
+                Vector block = load(codes + i);
+                wins = subtract(wins, match(winMatcher, block));
+                ties = subtract(ties, match(tieMatcher, block));
+                valid = subtract(valid, matchValid(block));
+            }
+            uint64_t blockWins = sumBytes(wins);
+            uint64_t blockTies = sumBytes(ties);
+            tally.humanWins += blockWins;
+            tally.ties += blockTies;
+            tally.computerWins += sumBytes(valid) - blockWins - blockTies;
+        }
+#endif
+        tally += scoreScalar(codes + i, count - i);
+        return tally;
+    }
+
+    // Name of the score() implementation compiled in.
+    static const char* kernelName() {
+#if defined(__AVX2__)
+        return "avx2";
+#elif defined(RPS_SCORING_SSE2)
+        return "sse2";
+#else
+        return "scalar";
+#endif
+    }
+
+    // Tally of every consecutive block of blockSize rounds (the last one may
+    // be shorter), e.g. per game or per session.
+    static std::vector<RoundTally> scoreBlocks(const uint8_t* codes, std::size_t count, std::size_t blockSize) {
+        std::vector<RoundTally> tallies;
+        if (blockSize == 0) {
+            return tallies;
+        }
+        tallies.reserve((count + blockSize - 1) / blockSize);
+        for (std::size_t start = 0; start < count; start += blockSize) {
+            tallies.push_back(score(codes + start, std::min(blockSize, count - start)));
+        }
+        return tallies;
+    }
+
+    // Append a history to 'codes', one roundCode byte per round.
+    static void packRounds(const std::vector<std::pair<Move, Move>>& history, std::vector<uint8_t>& codes) {
+        codes.reserve(codes.size() + history.size());
+        for (const auto& round : history) {
+            codes.push_back(static_cast<uint8_t>(roundCode(round.first, round.second)));
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef SCRIPTED_PLAYER_H
+#define SCRIPTED_PLAYER_H
+
+#include "Player.h"
+#include <istream>
+#include <vector>
+#include <cstddef>
+
+// Non-interactive player that streams its moves from a file or pipe.
+// Input is read in large chunks and decoded without any prompt output, so a
+// single console process can be driven through millions of rounds.
+// Accepted characters are R/P/S (any case); whitespace is ignored and '#'
+// starts a comment that runs to the end of the line. Any other character is
+// skipped and counted.
+class ScriptedPlayer : public Player {
+private:
+    static constexpr std::size_t CHUNK_SIZE = 1 << 16;
+
+    std::istream& input;
+    std::vector<char> buffer;
+    std::size_t pos;
+    std::size_t end;
+    bool inComment;
+    bool exhausted;
+    long long movesRead;
+    long long skippedChars;
+
+    // Refill the buffer with the next chunk of input. Returns false at EOF.
+    bool refill() {
+        if (!input) {
+            return false;
+        }
+        input.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        pos = 0;
+        end = static_cast<std::size_t>(input.gcount());
+        return end > 0;
+    }
+
+    // Scan forward to the next move character without consuming it.
+    bool advanceToMove() {
+        while (true) {
+            if (pos == end && !refill()) {
+                return false;
+            }
+            char c = buffer[pos];
+            if (inComment) {
+                if (c == '\n') inComment = false;
+                ++pos;
+                continue;
+            }
+            if (ClassicRules::fromChar(c) >= 0) {
+                return true;
+            }
+            switch (c) {
+                case '#':
+                    inComment = true;
+                    break;
+                case ' ': case '\t': case '\n': case '\r': case ',':
+                    break;
+                default:
+                    skippedChars++;
+                    break;
+            }
+            ++pos;
+        }
+    }
+
+public:
+    explicit ScriptedPlayer(std::istream& in)
+        : input(in), buffer(CHUNK_SIZE), pos(0), end(0),
+          inComment(false), exhausted(false), movesRead(0), skippedChars(0) {}
+
+    Move makeMove() override {
+        if (!advanceToMove()) {
+            // Callers are expected to check isExhausted() first; keep the
+            // game well-defined if they don't.
+            exhausted = true;
+            return Move::ROCK;
+        }
+        movesRead++;
+        return charToMove(buffer[pos++]);
+    }
+
+    void recordResult(Move, Move) override {
+        // Scripted moves do not depend on the outcome
+    }
+
+    bool isExhausted() override {
+        if (!exhausted && !advanceToMove()) {
+            exhausted = true;
+        }
+        return exhausted;
+    }
+
+    long long getMovesRead() const {
+        return movesRead;
+    }
+
+    long long getSkippedChars() const {
+        return skippedChars;
+    }
+};
+
+#endif
@@ -0,0 +1,311 @@
+#ifndef SHADOW_EVALUATOR_H
+#define SHADOW_EVALUATOR_H
+
+#include "ComputerPlayer.h"
+#include "GameAnalytics.h"
+#include "Move.h"
+#include "Strategy.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Runs shadow strategies next to the live one to see how they would have
+// done, without affecting play.
+//
+// Every shadow sees the live history (the human's moves and the live
+// computer's moves) and learns from it. The move it would have played is
+// scored against the human's actual move in a GameAnalytics of its own, so a
+// shadow gets the same statistics as the live game; a GameAnalytics of the
+// live strategy over the same rounds sits next to them for comparison.
+//
+// The round path only appends one byte per round to a batch. Full batches
+// are evaluated on a worker thread, started on the first batch (or, with
+// setBackground(false), on the caller's thread when the batch fills). A
+// batch that would take the backlog past maxBacklogRounds is dropped and
+// counted instead of making the game wait; the shadows do not see its rounds.
+class ShadowEvaluator {
+private:
+    struct Shadow {
+        std::string name;
+        std::unique_ptr<Strategy> strategy;
+        GameAnalytics analytics;
+        uint64_t agreements = 0;  // rounds where it chose the live move
+
+        Shadow(std::string label, std::unique_ptr<Strategy> s, int windowRounds)
+            : name(std::move(label)), strategy(std::move(s)), analytics(windowRounds) {}
+    };
+
+    struct Batch {
+        std::vector<uint8_t> codes;
+        std::size_t rounds = 0;
+    };
+
+    // One byte per round: roundCode + ROUND_CODES * (live prediction + 1),
+    // so 0..35.
+    static constexpr int ROUND_CODES = ClassicRules::ROUND_CODES;
+    static constexpr uint8_t GAME_END = 0xff;
+    static_assert(ROUND_CODES * (ClassicRules::COUNT + 1) <= GAME_END, "a round's code fits below GAME_END");
+
+    const int windowRounds;
+    const std::size_t batchRounds;
+    const std::size_t maxBacklogRounds;
+    bool background = true;
+    std::string liveName = "live";
+
+    // Worker side: only touched while evaluating, or after flush().
+    std::vector<std::unique_ptr<Shadow>> shadows;
+    GameAnalytics live;
+    std::vector<std::pair<Move, Move>> history;
+    uint64_t evaluatedRounds = 0;
+
+    // Caller side.
+    Batch batch;
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable idle;
+    std::deque<Batch> queue;
+    std::vector<std::vector<uint8_t>> spare;  // drained buffers for reuse
+    std::size_t queuedRounds = 0;
+    uint64_t droppedRounds = 0;
+    bool busy = false;
+    bool stopping = false;
+    std::thread worker;
+
+    void evaluate(const std::vector<uint8_t>& codes) {
+        for (uint8_t code : codes) {
+            if (code == GAME_END) {
+                live.endGame();
+                for (auto& shadow : shadows) {
+                    shadow->analytics.endGame();
+                }
+                continue;
+            }
+            Move human = static_cast<Move>(code % ROUND_CODES / ClassicRules::COUNT);
+            Move computer = static_cast<Move>(code % ClassicRules::COUNT);
+            live.observe(human, computer, code / ROUND_CODES - 1);
+            for (auto& shadow : shadows) {
+                Move move = shadow->strategy->makeMove(history);
+                Move predicted;
+                bool hasPrediction = strategyPrediction(*shadow->strategy, predicted);
+                shadow->analytics.observe(human, move, hasPrediction ? static_cast<int>(predicted) : -1);
+                if (move == computer) {
+                    shadow->agreements++;
+                }
+            }
+            // Shadows learn from what actually happened, not from their own moves.
+            history.emplace_back(human, computer);
+            for (auto& shadow : shadows) {
+                shadow->strategy->updateFrequencies(history);
+            }
+            evaluatedRounds++;
+        }
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            workAvailable.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            Batch job = std::move(queue.front());
+            queue.pop_front();
+            busy = true;
+            lock.unlock();
+
+            evaluate(job.codes);
+
+            lock.lock();
+            queuedRounds -= job.rounds;
+            job.codes.clear();
+            if (spare.size() < 4) {
+                spare.push_back(std::move(job.codes));
+            }
+            busy = false;
+            idle.notify_all();
+        }
+    }
+
+    // Pass the current batch on to be evaluated and start a new one.
+    void handOff() {
+        if (batch.codes.empty()) {
+            return;
+        }
+        if (!background) {
+            evaluate(batch.codes);
+            batch.codes.clear();
+            batch.rounds = 0;
+            return;
+        }
+        std::vector<uint8_t> next;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queuedRounds + batch.rounds > maxBacklogRounds) {
+                // Too far behind: drop the rounds but keep the game boundaries.
+                droppedRounds += batch.rounds;
+                batch.codes.erase(std::remove_if(batch.codes.begin(), batch.codes.end(),
+                                                 [](uint8_t code) { return code != GAME_END; }),
+                                  batch.codes.end());
+                batch.rounds = 0;
+            }
+            if (!batch.codes.empty()) {
+                queuedRounds += batch.rounds;
+                queue.push_back(std::move(batch));
+                if (!worker.joinable()) {
+                    worker = std::thread(&ShadowEvaluator::run, this);
+                }
+            }
+            if (!spare.empty()) {
+                next = std::move(spare.back());
+                spare.pop_back();
+            }
+        }
+        workAvailable.notify_one();
+        batch.codes = std::move(next);
+        batch.codes.clear();
+        batch.codes.reserve(batchRounds + 16);
+        batch.rounds = 0;
+    }
+
+public:
+    explicit ShadowEvaluator(int window = 100, std::size_t roundsPerBatch = 256,
+                             std::size_t backlogRounds = std::size_t(1) << 20)
+        : windowRounds(window),
+          batchRounds(roundsPerBatch > 0 ? roundsPerBatch : 1),
+          maxBacklogRounds(std::max(backlogRounds, batchRounds)),
+          live(window) {
+        batch.codes.reserve(batchRounds + 16);
+    }
+
+    ShadowEvaluator(const ShadowEvaluator&) = delete;
+    ShadowEvaluator& operator=(const ShadowEvaluator&) = delete;
+
+    // Evaluates what is still queued, including the batch being filled,
+    // then stops the worker.
+    ~ShadowEvaluator() {
+        handOff();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        workAvailable.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    // Add a shadow before the first round is recorded. The name defaults to
+    // the strategy's own.
+    void addShadow(std::unique_ptr<Strategy> strategy, const std::string& name = "") {
+        std::string label = name.empty() ? strategy->getName() : name;
+        shadows.push_back(std::make_unique<Shadow>(label, std::move(strategy), windowRounds));
+    }
+
+    // Evaluate batches on the caller's thread instead of a worker.
+    void setBackground(bool enabled) {
+        flush();
+        background = enabled;
+    }
+
+    void setLiveName(const std::string& name) {
+        liveName = name;
+    }
+
+    // A live round: the human's move, the live computer's move and the human
+    // move the live strategy predicted (-1 for none). Cheap enough for the
+    // round path.
+    void record(Move human, Move computer, int predicted = -1) {
+        if (shadows.empty()) {
+            return;
+        }
+        int prediction = predicted >= 0 && predicted < ClassicRules::COUNT ? predicted + 1 : 0;
+        batch.codes.push_back(static_cast<uint8_t>(roundCode(human, computer) + ROUND_CODES * prediction));
+        if (++batch.rounds >= batchRounds) {
+            handOff();
+        }
+    }
+
+    void endGame() {
+        if (!shadows.empty()) {
+            batch.codes.push_back(GAME_END);
+        }
+    }
+
+    // Evaluate everything recorded so far and wait for it; the results below
+    // are only stable after this.
+    void flush() {
+        handOff();
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return queue.empty() && !busy; });
+    }
+
+    std::size_t getShadowCount() const {
+        return shadows.size();
+    }
+
+    const std::string& getShadowName(std::size_t i) const {
+        return shadows[i]->name;
+    }
+
+    const GameAnalytics& getShadowAnalytics(std::size_t i) const {
+        return shadows[i]->analytics;
+    }
+
+    uint64_t getAgreements(std::size_t i) const {
+        return shadows[i]->agreements;
+    }
+
+    // The live strategy over the same rounds as the shadows.
+    const GameAnalytics& getLiveAnalytics() const {
+        return live;
+    }
+
+    uint64_t getEvaluatedRounds() const {
+        return evaluatedRounds;
+    }
+
+    uint64_t getDroppedRounds() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return droppedRounds;
+    }
+
+    // One line per strategy, live first. Call flush() first.
+    void report(std::ostream& out) {
+        using Outcome = GameAnalytics::Outcome;
+        std::ios::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        out << std::fixed << std::setprecision(1);
+        out << "Shadow strategies: " << evaluatedRounds << " rounds evaluated, " << getDroppedRounds()
+            << " dropped" << '\n';
+        out << "  Strategy        computer%  human%   tie%  agree%  accuracy%" << '\n';
+        auto row = [&](const std::string& name, const GameAnalytics& stats, double agree) {
+            double rounds = stats.getRounds() > 0 ? static_cast<double>(stats.getRounds()) : 1.0;
+            out << "  " << std::left << std::setw(14) << name << std::right
+                << std::setw(11) << stats.getOutcomeCount(Outcome::ComputerWin) * 100.0 / rounds
+                << std::setw(8) << stats.getOutcomeCount(Outcome::HumanWin) * 100.0 / rounds
+                << std::setw(7) << stats.getOutcomeCount(Outcome::Tie) * 100.0 / rounds
+                << std::setw(8) << agree
+                << std::setw(11) << stats.getPredictionAccuracy() * 100 << '\n';
+        };
+        row(liveName, live, 100.0);
+        for (const auto& shadow : shadows) {
+            double rounds = shadow->analytics.getRounds() > 0 ? static_cast<double>(shadow->analytics.getRounds()) : 1.0;
+            row(shadow->name, shadow->analytics, shadow->agreements * 100.0 / rounds);
+        }
+        out.flags(flags);
+        out.precision(precision);
+    }
+};
+
+#endif
@@ -0,0 +1,495 @@
+#ifndef SHARED_MEMORY_MODEL_H
+#define SHARED_MEMORY_MODEL_H
+
+#include "FrequencyFileWriter.h"
+#include "FrequencyModel.h"
+#include "SharedModelFile.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RPS_HAS_SHM 1
+#endif
+
+// The smart strategy's frequency tables in a named POSIX shared-memory
+// segment, read and updated in place by every process on the machine that
+// opens the same name. There is one model instead of one private copy per
+// process, and each process predicts from what all of them have learned.
+//
+// The layout is fixed when the segment is created: a header, then one
+// open-addressing table for each sequence length in [minSeqLen, maxSeqLen].
+// A table has at most 'slotsPerTable' slots, and no more than the contexts
+// of its length can fill (81 for length 3, 729 for 4, ...), so the short
+// lengths do not take as much room as the long ones. A slot holds the context key (plus one, so that
+// zero means empty), three 32-bit counters and the move mask, all atomics,
+// so an update is a compare-and-swap to claim a slot the first time a
+// context is seen and a compare-and-swap on one counter after that. A
+// claimed slot counts as seen only once its mask is set, which each update
+// does after its count, so a reader never takes a key whose counts are not
+// there yet. Contexts are never removed. A table takes new contexts until it is MAX_LOAD_PERCENT full;
+// later updates of unknown contexts are dropped and counted.
+//
+// Counters saturate at 2^32 - 1 instead of halving, since halving all
+// three counters of a context cannot be done atomically with the others'
+// increments.
+//
+// The first process to open a name creates the segment and fills it from
+// the model file, if one is given; the others wait until it is ready. The
+// segment outlives the processes until remove() unlinks it (on Linux it
+// shows up as /dev/shm/<name>). save() writes the whole model to a file.
+class SharedMemoryModel {
+public:
+    static constexpr int MAX_LOAD_PERCENT = 75;
+    static constexpr int MOVES = ClassicRules::COUNT;
+
+private:
+    static constexpr uint64_t MAGIC = 0x31484d53535052ULL;  // "RPSSMH1"
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint32_t READY = 1;
+    static constexpr int READY_TIMEOUT_MS = 10000;
+
+    struct Slot {
+        std::atomic<uint64_t> key;         // context key + 1, 0 while empty
+        std::atomic<uint32_t> counts[MOVES];  // indexed by Move
+        std::atomic<uint8_t> mask;         // bit m set when move m has an entry
+    };
+
+    struct Header {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t slotSize;  // sizeof(Slot), so another build's layout is refused
+        uint32_t minSeqLen;
+        uint32_t maxSeqLen;
+        uint64_t slotsPerTable;  // of the longest tables; see tableSlots()
+        std::atomic<uint32_t> state;  // READY once created and loaded
+        std::atomic<uint64_t> contexts[FrequencyModel::MAX_SEQ_LEN + 1];
+        std::atomic<uint64_t> dropped;  // updates of new contexts that found their table full
+    };
+
+    // Lock-free atomics are address-free, so they work across processes.
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "64-bit atomics must be lock-free");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "32-bit atomics must be lock-free");
+    static_assert(std::atomic<uint8_t>::is_always_lock_free, "8-bit atomics must be lock-free");
+
+    Header* header = nullptr;
+    Slot* slots = nullptr;
+    // Per sequence length: first slot of its table, and its slot count.
+    std::size_t tableStart[FrequencyModel::MAX_SEQ_LEN + 1] = {};
+    std::size_t tableSize[FrequencyModel::MAX_SEQ_LEN + 1] = {};
+    std::size_t bytes = 0;
+    bool created = false;
+
+    SharedMemoryModel() = default;
+
+    static std::size_t hashKey(uint64_t key) {
+        key ^= key >> 29;
+        key *= 0xbf58476d1ce4e5b9ULL;
+        key ^= key >> 32;
+        return static_cast<std::size_t>(key);
+    }
+
+    // Slots of the table for seqLen: a power of two that holds every
+    // context of that length within MAX_LOAD_PERCENT, or slotsPerTable if
+    // that is smaller.
+    static uint64_t tableSlots(int seqLen, uint64_t slotsPerTable) {
+        uint64_t contexts = 1;
+        for (int round = 1; round < seqLen && contexts <= slotsPerTable; ++round) {
+            contexts *= ClassicRules::ROUND_CODES;
+        }
+        uint64_t needed = contexts * 100 / MAX_LOAD_PERCENT + 1;
+        uint64_t slotCount = 64;
+        while (slotCount < needed && slotCount < slotsPerTable) {
+            slotCount *= 2;
+        }
+        return slotCount;
+    }
+
+    static std::size_t segmentBytes(int minSeqLen, int maxSeqLen, uint64_t slotsPerTable) {
+        std::size_t total = 0;
+        for (int seqLen = minSeqLen; seqLen <= maxSeqLen; ++seqLen) {
+            total += static_cast<std::size_t>(tableSlots(seqLen, slotsPerTable));
+        }
+        return sizeof(Header) + total * sizeof(Slot);
+    }
+
+    // Fill tableStart and tableSize from the header.
+    void layOutTables() {
+        std::size_t start = 0;
+        for (int seqLen = static_cast<int>(header->minSeqLen); seqLen <= static_cast<int>(header->maxSeqLen); ++seqLen) {
+            tableStart[seqLen] = start;
+            tableSize[seqLen] = static_cast<std::size_t>(tableSlots(seqLen, header->slotsPerTable));
+            start += tableSize[seqLen];
+        }
+    }
+
+    bool hasTable(int seqLen) const {
+        return seqLen >= static_cast<int>(header->minSeqLen) && seqLen <= static_cast<int>(header->maxSeqLen);
+    }
+
+    Slot* table(int seqLen) const {
+        return slots + tableStart[seqLen];
+    }
+
+    const Slot* findSlot(int seqLen, uint64_t key) const {
+        if (!hasTable(seqLen)) {
+            return nullptr;
+        }
+        const Slot* base = table(seqLen);
+        std::size_t mask = tableSize[seqLen] - 1;
+        uint64_t stored = key + 1;
+        for (std::size_t slot = hashKey(key) & mask;; slot = (slot + 1) & mask) {
+            uint64_t current = base[slot].key.load(std::memory_order_acquire);
+            if (current == stored) {
+                return &base[slot];
+            }
+            if (current == 0) {
+                return nullptr;
+            }
+        }
+    }
+
+    // The slot of a context, claiming an empty one if it is new; null when
+    // the table has no room for it.
+    Slot* findOrInsert(int seqLen, uint64_t key) {
+        if (!hasTable(seqLen)) {
+            return nullptr;
+        }
+        Slot* base = table(seqLen);
+        std::size_t mask = tableSize[seqLen] - 1;
+        uint64_t stored = key + 1;
+        for (std::size_t slot = hashKey(key) & mask;; slot = (slot + 1) & mask) {
+            uint64_t current = base[slot].key.load(std::memory_order_acquire);
+            if (current == stored) {
+                return &base[slot];
+            }
+            if (current != 0) {
+                continue;
+            }
+            // Reserve room first, so the table never fills past the limit and
+            // every probe ends at an empty slot.
+            std::atomic<uint64_t>& contexts = header->contexts[seqLen];
+            if (contexts.fetch_add(1, std::memory_order_relaxed) >=
+                tableSize[seqLen] * MAX_LOAD_PERCENT / 100) {
+                contexts.fetch_sub(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            if (base[slot].key.compare_exchange_strong(current, stored, std::memory_order_acq_rel)) {
+                return &base[slot];
+            }
+            contexts.fetch_sub(1, std::memory_order_relaxed);
+            if (current == stored) {
+                return &base[slot];  // another process added the same context
+            }
+        }
+    }
+
+#ifdef RPS_HAS_SHM
+    // Map the segment behind 'fd', which another process created: wait
+    // for its size and then for it to be ready, and check the layout.
+    bool attach(int fd, const std::string& name) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(READY_TIMEOUT_MS);
+        struct stat status;
+        while (true) {
+            if (::fstat(fd, &status) != 0) {
+                std::cerr << "Failed to open shared model " << name << "." << std::endl;
+                return false;
+            }
+            if (static_cast<std::size_t>(status.st_size) >= sizeof(Header)) {
+                break;
+            }
+            if (std::chrono::steady_clock::now() > deadline) {
+                std::cerr << "Shared model " << name << " was never initialized; remove it and retry." << std::endl;
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        bytes = static_cast<std::size_t>(status.st_size);
+        void* mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            std::cerr << "Failed to map shared model " << name << "." << std::endl;
+            bytes = 0;
+            return false;
+        }
+        header = static_cast<Header*>(mapping);
+        slots = reinterpret_cast<Slot*>(header + 1);
+        while (header->state.load(std::memory_order_acquire) != READY) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                std::cerr << "Shared model " << name << " was never initialized; remove it and retry." << std::endl;
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (header->magic != MAGIC || header->version != VERSION || header->slotSize != sizeof(Slot) ||
+            header->minSeqLen < 2 || header->maxSeqLen > static_cast<uint32_t>(FrequencyModel::MAX_SEQ_LEN) ||
+            header->minSeqLen > header->maxSeqLen ||
+            segmentBytes(header->minSeqLen, header->maxSeqLen, header->slotsPerTable) != bytes) {
+            std::cerr << "Shared model " << name << " has a different layout." << std::endl;
+            return false;
+        }
+        layOutTables();
+        return true;
+    }
+#endif
+
+public:
+    SharedMemoryModel(const SharedMemoryModel&) = delete;
+    SharedMemoryModel& operator=(const SharedMemoryModel&) = delete;
+
+    ~SharedMemoryModel() {
+#ifdef RPS_HAS_SHM
+        if (header) {
+            ::munmap(header, bytes);
+        }
+#endif
+    }
+
+    // Open the segment 'name', creating it if no process has. A new segment
+    // gets tables for sequence lengths minSeqLen..maxSeqLen of at most
+    // slotsPerTable slots (rounded up to a power of two) and is loaded from
+    // 'modelPath' unless that is empty; an existing one keeps its layout.
+    // Null, with the reason on std::cerr, if it cannot be opened.
+    static std::unique_ptr<SharedMemoryModel> open(const std::string& name, const std::string& modelPath,
+                                                   int minSeqLen = 3, int maxSeqLen = 7,
+                                                   std::size_t slotsPerTable = std::size_t(1) << 18) {
+#ifdef RPS_HAS_SHM
+        if (minSeqLen < 2 || maxSeqLen > FrequencyModel::MAX_SEQ_LEN || minSeqLen > maxSeqLen) {
+            std::cerr << "Invalid sequence lengths for a shared model." << std::endl;
+            return nullptr;
+        }
+        uint64_t slotCount = 64;
+        while (slotCount < slotsPerTable) {
+            slotCount *= 2;
+        }
+        std::unique_ptr<SharedMemoryModel> model(new SharedMemoryModel());
+        const std::string path = segmentName(name);
+        int fd = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0 && errno == EEXIST) {
+            fd = ::shm_open(path.c_str(), O_RDWR, 0600);
+            if (fd < 0) {
+                std::cerr << "Failed to open shared model " << path << "." << std::endl;
+                return nullptr;
+            }
+            bool attached = model->attach(fd, path);
+            ::close(fd);
+            return attached ? std::move(model) : nullptr;
+        }
+        if (fd < 0) {
+            std::cerr << "Failed to create shared model " << path << "." << std::endl;
+            return nullptr;
+        }
+        model->bytes = segmentBytes(minSeqLen, maxSeqLen, slotCount);
+        void* mapping = MAP_FAILED;
+        if (::ftruncate(fd, static_cast<off_t>(model->bytes)) == 0) {
+            mapping = ::mmap(nullptr, model->bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            std::cerr << "Failed to size shared model " << path << "." << std::endl;
+            ::shm_unlink(path.c_str());
+            model->bytes = 0;
+            return nullptr;
+        }
+        // A new segment is zero-filled: every slot is empty and every count 0.
+        model->created = true;
+        model->header = static_cast<Header*>(mapping);
+        model->slots = reinterpret_cast<Slot*>(model->header + 1);
+        Header& header = *model->header;
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.slotSize = sizeof(Slot);
+        header.minSeqLen = static_cast<uint32_t>(minSeqLen);
+        header.maxSeqLen = static_cast<uint32_t>(maxSeqLen);
+        header.slotsPerTable = slotCount;
+        model->layOutTables();
+        if (!modelPath.empty()) {
+            FrequencyModel32 initial;
+            FrequencyFileReader::Status status = SharedModelFile::load(modelPath, initial);
+            if (status == FrequencyFileReader::Status::Invalid) {
+                std::cerr << "Invalid frequency file format." << std::endl;
+            }
+            model->import(initial);
+        }
+        header.state.store(READY, std::memory_order_release);
+        return model;
+#else
+        (void)name;
+        (void)modelPath;
+        (void)minSeqLen;
+        (void)maxSeqLen;
+        (void)slotsPerTable;
+        std::cerr << "Shared-memory models are not supported on this platform." << std::endl;
+        return nullptr;
+#endif
+    }
+
+    // Unlink the segment 'name'. Processes that have it open keep using it;
+    // the next open() creates a new one.
+    static bool remove(const std::string& name) {
+#ifdef RPS_HAS_SHM
+        return ::shm_unlink(segmentName(name).c_str()) == 0;
+#else
+        (void)name;
+        return false;
+#endif
+    }
+
+    // POSIX segment names start with a single '/'.
+    static std::string segmentName(const std::string& name) {
+        return (!name.empty() && name[0] == '/') ? name : "/" + name;
+    }
+
+    // Counts of one context, or false if no process has counted it yet.
+    bool find(int seqLen, uint64_t key, uint32_t counts[MOVES], int& mask) const {
+        const Slot* slot = findSlot(seqLen, key);
+        if (!slot) {
+            return false;
+        }
+        // A claimed slot whose first count is not yet published is a miss.
+        mask = slot->mask.load(std::memory_order_acquire);
+        if (mask == 0) {
+            return false;
+        }
+        for (int m = 0; m < MOVES; ++m) {
+            counts[m] = slot->counts[m].load(std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Count 'move' after the context. False if the context is new and its
+    // table is full, or the sequence length has no table; the update is
+    // then dropped.
+    bool increment(int seqLen, uint64_t key, Move move) {
+        Slot* slot = findOrInsert(seqLen, key);
+        if (!slot) {
+            header->dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        int m = static_cast<int>(move);
+        std::atomic<uint32_t>& count = slot->counts[m];
+        uint32_t current = count.load(std::memory_order_relaxed);
+        while (current != UINT32_MAX &&
+               !count.compare_exchange_weak(current, current + 1, std::memory_order_relaxed)) {
+        }
+        // Published after the count, so a reader that sees the bit sees it.
+        if (!(slot->mask.load(std::memory_order_relaxed) & (1 << m))) {
+            slot->mask.fetch_or(static_cast<uint8_t>(1 << m), std::memory_order_release);
+        }
+        return true;
+    }
+
+    // Add every context of 'model' to the counts here.
+    template <typename Model>
+    void import(const Model& model) {
+        static_assert(Model::MOVES == MOVES, "shared models hold Rock-Paper-Scissors models only");
+        for (int seqLen : model.seqLengths()) {
+            model.forEachContext(seqLen, [&](const typename Model::Context& context) {
+                Slot* slot = findOrInsert(seqLen, context.key());
+                if (!slot) {
+                    header->dropped.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                for (int m = 0; m < MOVES; ++m) {
+                    uint64_t count = slot->counts[m].load(std::memory_order_relaxed) +
+                                     static_cast<uint64_t>(std::max<int64_t>(context.counts[m], 0));
+                    slot->counts[m].store(static_cast<uint32_t>(std::min<uint64_t>(count, UINT32_MAX)),
+                                          std::memory_order_relaxed);
+                }
+                slot->mask.fetch_or(context.mask, std::memory_order_release);
+            });
+        }
+    }
+
+    // Copy the model as it is now into 'model' (cleared first). Counts that
+    // other processes add meanwhile may or may not be included.
+    void exportTo(FrequencyModel32& model) const {
+        model.clear();
+        for (int seqLen = static_cast<int>(header->minSeqLen); seqLen <= static_cast<int>(header->maxSeqLen); ++seqLen) {
+            const Slot* base = table(seqLen);
+            for (std::size_t slot = 0; slot < tableSize[seqLen]; ++slot) {
+                uint64_t stored = base[slot].key.load(std::memory_order_acquire);
+                int mask = base[slot].mask.load(std::memory_order_acquire);
+                if (stored == 0 || mask == 0) {
+                    continue;
+                }
+                int64_t counts[MOVES];
+                for (int m = 0; m < MOVES; ++m) {
+                    counts[m] = base[slot].counts[m].load(std::memory_order_relaxed);
+                }
+                model.setCounts(seqLen, stored - 1, counts, mask);
+            }
+        }
+    }
+
+    // Replace the model file at 'path' with the whole shared model, under
+    // the model file's exclusive lock.
+    bool save(const std::string& path, ModelFileFormat format = ModelFileFormat::Text) const {
+        FrequencyModel32 model;
+        exportTo(model);
+        ModelFileLock lock(path, true);
+        return FrequencyFileWriter::write(model, path, format);
+    }
+
+    std::size_t contextCount(int seqLen) const {
+        return hasTable(seqLen) ? static_cast<std::size_t>(header->contexts[seqLen].load(std::memory_order_relaxed)) : 0;
+    }
+
+    int getMinSeqLen() const {
+        return static_cast<int>(header->minSeqLen);
+    }
+
+    int getMaxSeqLen() const {
+        return static_cast<int>(header->maxSeqLen);
+    }
+
+    // Updates dropped because their table was full, by all processes.
+    long long getDroppedUpdates() const {
+        return static_cast<long long>(header->dropped.load(std::memory_order_relaxed));
+    }
+
+    // Size of the segment; pages no process has touched take no memory.
+    std::size_t getSegmentBytes() const {
+        return bytes;
+    }
+
+    // Bytes of the segment in memory, the pages some process has touched;
+    // the whole segment where that cannot be found out.
+    std::size_t getResidentBytes() const {
+#ifdef RPS_HAS_SHM
+        std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        std::vector<unsigned char> resident((bytes + page - 1) / page);
+#if defined(__APPLE__)
+        int status = ::mincore(header, bytes, reinterpret_cast<char*>(resident.data()));
+#else
+        int status = ::mincore(header, bytes, resident.data());
+#endif
+        if (status == 0) {
+            std::size_t pages = 0;
+            for (unsigned char flags : resident) {
+                pages += flags & 1;
+            }
+            return pages * page;
+        }
+#endif
+        return bytes;
+    }
+
+    // Whether this process created the segment (and loaded the model file into it).
+    bool isCreator() const {
+        return created;
+    }
+};
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef SHARED_MODEL_FILE_H
+#define SHARED_MODEL_FILE_H
+
+#include "FrequencyFileReader.h"
+#include "FrequencyFileWriter.h"
+#include "FrequencyModel.h"
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#define RPS_HAS_FLOCK 1
+#endif
+
+// Advisory lock on a model file, held until destroyed: exclusive for a
+// process merging into the file, shared for one loading it. The lock is taken
+// on '<path>.lock', not on the model file itself, because writers rename a
+// new file over the model and a lock on the old one would exclude nobody.
+// Where flock is not available, or the lock file cannot be created, nothing
+// is locked and isLocked() is false.
+class ModelFileLock {
+private:
+    int fd = -1;
+
+public:
+    ModelFileLock(const std::string& modelPath, bool exclusive) {
+#ifdef RPS_HAS_FLOCK
+        fd = ::open((modelPath + ".lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return;
+        }
+        while (::flock(fd, exclusive ? LOCK_EX : LOCK_SH) != 0) {
+            if (errno != EINTR) {
+                ::close(fd);
+                fd = -1;
+                return;
+            }
+        }
+#else
+        (void)modelPath;
+        (void)exclusive;
+#endif
+    }
+
+    ModelFileLock(const ModelFileLock&) = delete;
+    ModelFileLock& operator=(const ModelFileLock&) = delete;
+
+    ~ModelFileLock() {
+#ifdef RPS_HAS_FLOCK
+        if (fd >= 0) {
+            ::close(fd);  // releases the lock
+        }
+#endif
+    }
+
+    bool isLocked() const {
+        return fd >= 0;
+    }
+};
+
+// A model file shared by several processes, such as freq.txt when a few
+// rps_console and rps_gui instances run in one directory.
+//
+// Instead of writing its whole model, which would drop whatever the others
+// saved since it loaded the file, a process saves what it has learned since
+// its last load or save: for each context, the change from 'base' (a
+// snapshot taken then) to 'current'. Under the exclusive lock, the file is
+// read, the changes are added to its counts and the result is written back.
+// Counts above the counter maximum are scaled down as when loading, and a
+// count the process lowered by halving a saturated context lowers the file's
+// count by as much.
+// With no other writer the file ends up exactly equal to 'current'. A file
+// that does not parse is not overwritten blindly: it is renamed to
+// '<path>.corrupt' first, with a warning, and the save fails if that
+// cannot be done.
+//
+// The writer replaces the file by renaming, so a reader never sees half of
+// one; load() also takes the shared lock, so it does not read between the
+// two steps of the rename fallback.
+class SharedModelFile {
+public:
+    template <typename Model>
+    static FrequencyFileReader::Status load(const std::string& path, Model& model) {
+        ModelFileLock lock(path, false);
+        return FrequencyFileReader::load(path, model);
+    }
+
+    static bool save(const FrequencyModel::Snapshot& base, const FrequencyModel::Snapshot& current,
+                     const std::string& path, ModelFileFormat format = ModelFileFormat::Text) {
+        ModelFileLock lock(path, true);
+        FrequencyModel merged;
+        FrequencyFileReader::Status status = FrequencyFileReader::load(path, merged);
+        if (status == FrequencyFileReader::Status::Invalid) {
+            // Keep the damaged file for inspection rather than lose its counts.
+            const std::string corruptPath = path + ".corrupt";
+            std::remove(corruptPath.c_str());
+            if (std::rename(path.c_str(), corruptPath.c_str()) != 0) {
+                std::cerr << "Not saving over the damaged model file " << path << "." << std::endl;
+                return false;
+            }
+            std::cerr << "Model file " << path << " is damaged; moved it to " << corruptPath << "." << std::endl;
+        }
+        if (status != FrequencyFileReader::Status::Ok) {
+            // Nothing usable on disk to merge into: this model becomes the file.
+            return FrequencyFileWriter::write(current, path, format);
+        }
+        for (int seqLen : current.seqLengths()) {
+            current.forEachSince(base, seqLen, [&](const FrequencyModel::Context& now,
+                                                   const FrequencyModel::Context* before) {
+                int64_t delta[FrequencyModel::MOVES];
+                bool changed = before == nullptr || before->mask != now.mask;
+                for (int m = 0; m < FrequencyModel::MOVES; ++m) {
+                    delta[m] = static_cast<int64_t>(now.counts[m]) - (before ? before->counts[m] : 0);
+                    changed = changed || delta[m] != 0;
+                }
+                if (!changed) {
+                    return;
+                }
+                const FrequencyModel::Context* onDisk = merged.find(seqLen, now.key());
+                int64_t counts[FrequencyModel::MOVES];
+                for (int m = 0; m < FrequencyModel::MOVES; ++m) {
+                    counts[m] = (onDisk ? onDisk->counts[m] : 0) + delta[m];
+                }
+                merged.setCounts(seqLen, now.key(), counts, now.mask);
+            });
+        }
+        return FrequencyFileWriter::write(merged, path, format);
+    }
+};
+
+#endif
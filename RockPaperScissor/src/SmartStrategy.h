@@ -2,31 +2,126 @@
 #define SMART_STRATEGY_H
 
 #include "Strategy.h"
-#include <map>
+#include "ContextSketch.h"
+#include "FrequencyFileReader.h"
+#include "FrequencyFileWriter.h"
+#include "FrequencyModel.h"
+#include "ModelReloader.h"
+#include "ModelSaver.h"
+#include "PredictionCache.h"
+#include "ProfileStore.h"
+#include "ReplicatedModel.h"
+#include "SharedMemoryModel.h"
+#include "SharedModelFile.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
-#include <cctype>
 #include <vector>
 #include <cstdlib>
 #include <ctime>
+#include <random>
 
 // Updated SmartStrategy that records multiple sequence lengths simultaneously.
 class SmartStrategy : public Strategy {
+public:
+    // Longest sequence length setLongOrders accepts.
+    static constexpr int MAX_LONG_ORDER = 64;
+
+    // Moves per context, as the model and its key encoding count them.
+    static constexpr int MOVES = ClassicRules::COUNT;
+
+    // Online bookkeeping for one sequence length, used by adaptive order selection.
+    struct OrderStats {
+        long long lookups = 0;   // times this order was probed for a prediction
+        long long hits = 0;      // probes that found the context in the table
+        long long correct = 0;   // hits whose own prediction matched the human's move
+        double lastAccuracy = 0; // correct/hits over the last completed window
+        bool active = true;      // inactive orders are neither looked up nor updated
+        int probeRoundsLeft = 0; // > 0 while an inactive order is being re-probed
+        int windowLookups = 0;
+        int windowHits = 0;
+        int windowCorrect = 0;
+    };
+
 private:
+    // Adaptive order selection: an order is evaluated every ADAPTIVE_WINDOW lookups
+    // and kept only if it is hit often enough and beats every shorter active order
+    // by ADAPTIVE_MARGIN. Inactive orders are re-probed for PROBE_LENGTH rounds
+    // every PROBE_INTERVAL rounds.
+    static constexpr int ADAPTIVE_WINDOW = 128;
+    static constexpr double ADAPTIVE_MIN_HIT_RATE = 0.05;
+    static constexpr double ADAPTIVE_MARGIN = 0.02;
+    static constexpr int PROBE_INTERVAL = 1000;
+    static constexpr int PROBE_LENGTH = 200;
+
     // For each sequence length (N), we store a frequency table.
     // Each frequency table maps a key (constructed from the last (N-1) rounds)
-    // to a map that counts how many times each human move followed that sequence.
-    std::map<int, std::map<std::string, std::map<Move, int>>> frequenciesByLength;
+    // to the counts of how many times each human move followed that sequence.
+    // Storage is arena-backed, see FrequencyModel.
+    FrequencyModel frequenciesByLength;
     
     // List of sequence lengths to record (for example, 3, 4, 5, 6, 7)
     std::vector<int> seqLengths = {3, 4, 5, 6, 7};
+
+    // Aggregated predictions by the rounds the longest order looks at, kept
+    // up to date by updateFrequencies (see PredictionCache). Used while every
+    // order takes part and there is nothing to log per order.
+    PredictionCache predictionCache{seqLengths.front() - 1, static_cast<int>(seqLengths.size())};
+    bool predictionCacheEnabled = true;
     
+    // Sequence lengths above seqLengths, up to longOrderMax, are counted
+    // approximately in a fixed-size sketch while setLongOrders is on.
+    std::unique_ptr<ContextSketch> sketch;
+    int longOrderMin = 0;
+    int longOrderMax = 0;
+    std::vector<uint64_t> sketchContexts;
+
+    // Adaptive order selection state (parallel to seqLengths). Off by default.
+    bool adaptiveOrders = false;
+    std::vector<OrderStats> orderStats;
+    std::vector<int> pendingOrderPrediction; // each order's own prediction this round, or -1
+    int roundsSinceProbe = 0;
+
+    // Backing files. An empty path disables loading/saving the model or the log.
+    std::string modelPath;
+    std::string logPath;
+    ModelFileFormat modelFormat = ModelFileFormat::Text;
+
+    // Per-player profiles. While a player is set, frequenciesByLength is that
+    // player's model, checked out of the store, and modelPath is not used.
+    std::shared_ptr<ProfileStore> profiles;
+    std::string playerId;
+
     // Output file for detailed logging
     std::ofstream outputFile;
 
+    // Background model writer; null while saves are synchronous.
+    std::unique_ptr<ModelSaver> saver;
+    int autosaveInterval = 0;
+
+    // The model as last loaded from or saved to modelPath. Saves merge the
+    // changes since then into the file (see SharedModelFile).
+    FrequencyModel::Snapshot mergeBase;
+
+    // Watches modelPath for new versions while hot reload is on.
+    std::unique_ptr<ModelReloader> reloader;
+
+    // Set while this strategy is one worker of a ReplicatedModel.
+    ReplicatedModel::Replica* replica = nullptr;
+
+    // Set while the model is a segment shared with other processes; then
+    // frequenciesByLength is empty and unused.
+    std::shared_ptr<SharedMemoryModel> sharedModel;
+    int updatesSinceAutosave = 0;
+
+    // Per-instance generator so a seed fully determines the fallback moves.
+    std::mt19937 rng;
+
     // NEW: Flag and storage for the prediction.
     bool predictionValid;
     Move lastPredictedHumanMove = Move::ROCK; 
@@ -37,111 +132,266 @@ private:
     int computerWins;
     int ties;
     
-    // Convert a sequence of moves to a string key using a given number of rounds.
+    // Uniformly random move, used whenever there is nothing to predict from.
+    Move randomMove() {
+        return static_cast<Move>(std::uniform_int_distribution<int>(0, MOVES - 1)(rng));
+    }
+
+    // Convert a sequence of moves to a key using a given number of rounds.
     // Here, 'length' refers to the number of rounds considered (which is N-1).
-    std::string movesToKey(const std::vector<std::pair<Move, Move>>& history, int start, int length) {
-        std::string key;
-        for (int i = start; i < start + length; ++i) {
-            if (i < history.size()) {
-                // Append both human and computer moves as integers.
-                key += std::to_string(static_cast<int>(history[i].first));
-                key += std::to_string(static_cast<int>(history[i].second));
+    uint64_t movesToKey(const std::vector<std::pair<Move, Move>>& history, int start, int length) {
+        return FrequencyModel::makeKey(history, static_cast<size_t>(start), length);
+    }
+    
+    // Most frequent move of counts summed over orders; ties go to the lowest move.
+    static Move aggregateMove(const int64_t aggregated[MOVES], int aggregatedMask) {
+        Move predictedMove = Move::ROCK;
+        int64_t maxFreq = 0;
+        for (int m = 0; m < MOVES; ++m) {
+            if ((aggregatedMask & (1 << m)) && aggregated[m] > maxFreq) {
+                maxFreq = aggregated[m];
+                predictedMove = static_cast<Move>(m);
             }
         }
-        return key;
+        return predictedMove;
     }
     
     // For a given sequence length and key, predict the next human move using its frequency table.
     // If no data exists for that key, return a random move.
-    Move predictNextMoveForLength(int seqLen, const std::string& key) {
-        auto& freqMap = frequenciesByLength[seqLen];
-        if (freqMap.find(key) == freqMap.end() || freqMap[key].empty()) {
-            return Move(std::rand() % 3);
+    Move predictNextMoveForLength(int seqLen, uint64_t key) {
+        ContextCounts context;
+        if (!findContext(seqLen, key, context) || context.mask == 0) {
+            return randomMove();
         }
-        
-        Move predictedMove = Move::ROCK;
-        int maxFreq = 0;
-        for (const auto& pair : freqMap[key]) {
-            if (pair.second > maxFreq) {
-                maxFreq = pair.second;
-                predictedMove = pair.first;
+        return context.best;
+    }
+
+    // One context's counts, whichever model holds them.
+    struct ContextCounts {
+        int64_t counts[MOVES];
+        int mask;
+        Move best;
+    };
+
+    bool findContext(int seqLen, uint64_t key, ContextCounts& found) const {
+        if (sharedModel) {
+            uint32_t counts[MOVES];
+            if (!sharedModel->find(seqLen, key, counts, found.mask)) {
+                return false;
+            }
+            int best = 0;
+            for (int m = 0; m < MOVES; ++m) {
+                found.counts[m] = counts[m];
+                if (counts[m] > counts[best]) {
+                    best = m;
+                }
             }
+            found.best = static_cast<Move>(best);
+            return true;
         }
-        return predictedMove;
-    }
-    
-    // Choose a move that beats the predicted human move.
-    Move chooseCounterMove(Move predictedMove) {
-        switch (predictedMove) {
-            case Move::ROCK:
-                return Move::PAPER;
-            case Move::PAPER:
-                return Move::SCISSORS;
-            case Move::SCISSORS:
-                return Move::ROCK;
-            default:
-                return Move::ROCK; // Fallback
+        const FrequencyModel::Context* context = frequenciesByLength.find(seqLen, key);
+        if (!context) {
+            return false;
+        }
+        for (int m = 0; m < MOVES; ++m) {
+            found.counts[m] = context->counts[m];
         }
+        found.mask = context->mask;
+        found.best = context->bestMove();
+        return true;
     }
     
+    // Whether an order takes part in lookups and updates this round.
+    bool isOrderEnabled(size_t index) const {
+        return !adaptiveOrders || orderStats[index].active || orderStats[index].probeRoundsLeft > 0;
+    }
+
     // Aggregate predictions from all sequence lengths.
-    // We sum up the frequencies for each move across all available sequence lengths.
-    Move aggregatePredictions(const std::vector<std::pair<Move, Move>>& history) {
-        std::map<Move, int> aggregated;
+    // We sum up the frequencies for each move across all available sequence lengths,
+    // into 'aggregated'.
+    Move aggregatePredictions(const std::vector<std::pair<Move, Move>>& history, int64_t aggregated[MOVES]) {
+        std::fill(aggregated, aggregated + MOVES, 0);
+        int aggregatedMask = 0;
         bool anyData = false;
         
-        for (int seqLen : seqLengths) {
+        for (size_t i = 0; i < seqLengths.size(); ++i) {
+            int seqLen = seqLengths[i];
             // Need at least (seqLen - 1) rounds of history
-            if (history.size() < static_cast<size_t>(seqLen - 1)) {
+            if (history.size() < static_cast<size_t>(seqLen - 1) || !isOrderEnabled(i)) {
                 continue;
             }
             
             int start = history.size() - (seqLen - 1);
-            std::string key = movesToKey(history, start, seqLen - 1);
+            uint64_t key = movesToKey(history, start, seqLen - 1);
             
-            auto& freqMap = frequenciesByLength[seqLen];
-            if (freqMap.find(key) == freqMap.end()) {
+            ContextCounts context;
+            bool found = findContext(seqLen, key, context);
+            if (adaptiveOrders) {
+                orderStats[i].lookups++;
+                orderStats[i].windowLookups++;
+            }
+            if (!found) {
                 continue;
             }
             anyData = true;
-            for (const auto& pair : freqMap[key]) {
-                aggregated[pair.first] += pair.second;
+            for (int m = 0; m < MOVES; ++m) {
+                aggregated[m] += context.counts[m];
+            }
+            aggregatedMask |= context.mask;
+            if (adaptiveOrders) {
+                orderStats[i].hits++;
+                orderStats[i].windowHits++;
+                pendingOrderPrediction[i] = static_cast<int>(context.best);
             }
             
             // Log details for this sequence length
             if (outputFile.is_open()) {
-                outputFile << "SeqLen " << seqLen << " key: " << key << std::endl;
-                for (const auto& pair : freqMap[key]) {
-                    std::string moveStr = (pair.first == Move::ROCK ? "R" : 
-                                           (pair.first == Move::PAPER ? "P" : "S"));
-                    outputFile << "    " << moveStr << " : " << pair.second << std::endl;
+                char keyText[2 * FrequencyModel::MAX_SEQ_LEN];
+                FrequencyModel::writeKey(key, seqLen - 1, keyText);
+                outputFile << "SeqLen " << seqLen << " key: ";
+                outputFile.write(keyText, 2 * (seqLen - 1)) << '\n';
+                for (int m = 0; m < MOVES; ++m) {
+                    if (!(context.mask & (1 << m))) continue;
+                    outputFile << "    " << RockPaperScissors::LETTERS[m] << " : " << context.counts[m] << '\n';
                 }
             }
         }
         
-        if (!anyData || aggregated.empty()) {
+        if (sketch && history.size() >= static_cast<size_t>(longOrderMin - 1)) {
+            int rounds = std::min(static_cast<int>(history.size()), longOrderMax - 1);
+            ContextSketch::hashContexts(history, history.size(), rounds, sketchContexts.data());
+            for (int seqLen = longOrderMin; seqLen <= rounds + 1; ++seqLen) {
+                sketch->prefetch(sketchContexts[seqLen - 2]);
+            }
+            for (int seqLen = longOrderMin; seqLen <= rounds + 1; ++seqLen) {
+                uint32_t counts[MOVES];
+                if (!sketch->estimate(sketchContexts[seqLen - 2], counts)) {
+                    continue;
+                }
+                anyData = true;
+                for (int m = 0; m < MOVES; ++m) {
+                    aggregated[m] += counts[m];
+                    if (counts[m] > 0) {
+                        aggregatedMask |= 1 << m;
+                    }
+                }
+                if (outputFile.is_open()) {
+                    outputFile << "SeqLen " << seqLen << " (sketch) R : " << counts[0] << "  P : " << counts[1]
+                               << "  S : " << counts[2] << '\n';
+                }
+            }
+        }
+
+        if (!anyData || aggregatedMask == 0) {
             predictionValid = false;
-            return Move(std::rand() % 3);
+            return randomMove();
         }
         
         predictionValid = true;
-        Move predictedMove = Move::ROCK;
-        int maxFreq = 0;
-        for (const auto& entry : aggregated) {
-            if (entry.second > maxFreq) {
-                maxFreq = entry.second;
-                predictedMove = entry.first;
-            }
+        return aggregateMove(aggregated, aggregatedMask);
+    }
+
+    // Rounds in the combined context the prediction cache is keyed by.
+    int combinedRounds() const {
+        return seqLengths.back() - 1;
+    }
+
+    // Whether aggregatePredictions is exactly the sum over all of seqLengths,
+    // with 'rounds' of history, and does nothing else worth keeping.
+    bool canCachePrediction(size_t rounds) const {
+        return predictionCacheEnabled && !adaptiveOrders && !sketch && !sharedModel && !outputFile.is_open() &&
+               rounds >= static_cast<size_t>(combinedRounds());
+    }
+
+    // aggregatePredictions, answered from the prediction cache when it can be.
+    Move predictNextMove(const std::vector<std::pair<Move, Move>>& history) {
+        int64_t aggregated[MOVES];
+        if (!canCachePrediction(history.size()) || !predictionCache.beginPrediction()) {
+            return aggregatePredictions(history, aggregated);
+        }
+        uint64_t key = movesToKey(history, history.size() - combinedRounds(), combinedRounds());
+        Move cached;
+        bool valid;
+        if (predictionCache.lookup(key, cached, valid)) {
+            predictionValid = valid;
+            return valid ? cached : randomMove();
         }
+        Move predictedMove = aggregatePredictions(history, aggregated);
+        predictionCache.store(key, predictedMove, aggregated, predictionValid);
         return predictedMove;
     }
     
+    // Score each order's prediction from the last makeMove against the actual
+    // human move, and re-evaluate orders whose window is complete.
+    void scoreOrderPredictions(Move humanMove) {
+        for (size_t i = 0; i < seqLengths.size(); ++i) {
+            OrderStats& stats = orderStats[i];
+            if (pendingOrderPrediction[i] == static_cast<int>(humanMove)) {
+                stats.correct++;
+                stats.windowCorrect++;
+            }
+            pendingOrderPrediction[i] = -1;
+            if (stats.windowLookups < ADAPTIVE_WINDOW) {
+                continue;
+            }
+
+            double hitRate = static_cast<double>(stats.windowHits) / stats.windowLookups;
+            stats.lastAccuracy = stats.windowHits > 0
+                ? static_cast<double>(stats.windowCorrect) / stats.windowHits : 0.0;
+            double bestShorter = 0.0;
+            for (size_t j = 0; j < i; ++j) {
+                if (orderStats[j].active && orderStats[j].lastAccuracy > bestShorter) {
+                    bestShorter = orderStats[j].lastAccuracy;
+                }
+            }
+            // The shortest order is always kept as the fallback.
+            stats.active = (i == 0) ||
+                (hitRate >= ADAPTIVE_MIN_HIT_RATE && stats.lastAccuracy > bestShorter + ADAPTIVE_MARGIN);
+            stats.probeRoundsLeft = 0;
+            stats.windowLookups = 0;
+            stats.windowHits = 0;
+            stats.windowCorrect = 0;
+        }
+    }
+
+    // Count down running probes and periodically start probing inactive orders again.
+    void advanceProbes() {
+        bool startProbe = ++roundsSinceProbe >= PROBE_INTERVAL;
+        if (startProbe) {
+            roundsSinceProbe = 0;
+        }
+        for (OrderStats& stats : orderStats) {
+            if (stats.active) {
+                continue;
+            }
+            if (startProbe) {
+                stats.probeRoundsLeft = PROBE_LENGTH;
+                stats.windowLookups = 0;
+                stats.windowHits = 0;
+                stats.windowCorrect = 0;
+            } else if (stats.probeRoundsLeft > 0) {
+                stats.probeRoundsLeft--;
+            }
+        }
+    }
+
 public:
-    SmartStrategy() {
-        std::srand(static_cast<unsigned int>(std::time(nullptr)));
-        outputFile.open("output-smart.txt");
-        if (!outputFile.is_open()) {
-            std::cerr << "Failed to open output-smart.txt for writing." << std::endl;
+    SmartStrategy() : SmartStrategy(static_cast<unsigned int>(std::time(nullptr))) {}
+
+    // Seeded constructor so scripted runs are reproducible.
+    explicit SmartStrategy(unsigned int seed)
+        : SmartStrategy(seed, "freq.txt", "output-smart.txt") {}
+
+    // Fully specified constructor. Passing an empty modelPath gives a fresh,
+    // in-memory model that is never written back; an empty logPath disables
+    // the per-round log (benchmarks and tools use both).
+    SmartStrategy(unsigned int seed, const std::string& modelFile, const std::string& logFile)
+        : modelPath(modelFile), logPath(logFile), rng(seed) {
+        if (!logPath.empty()) {
+            outputFile.open(logPath);
+            if (!outputFile.is_open()) {
+                std::cerr << "Failed to open " << logPath << " for writing." << std::endl;
+            }
         }
         
         roundNumber = 0;
@@ -151,11 +401,13 @@ public:
         predictionValid = false;
         
         // Load frequencies from file
-        loadState();
+        if (!modelPath.empty()) {
+            loadState();
+        }
         if (outputFile.is_open()) {
-            outputFile << "Reading file freq.txt: " 
+            outputFile << "Reading file " << modelPath << ": " 
                        << "Records across " << seqLengths.size() << " sequence lengths." 
-                       << std::endl << std::endl;
+                       << '\n' << '\n';
         }
     }
     
@@ -163,23 +415,37 @@ public:
         if (outputFile.is_open()) {
             outputFile.close();
         }
+        releasePlayer();
     }
     
     Move makeMove(const std::vector<std::pair<Move, Move>>& history) override {
         roundNumber++;
+        if (reloader && reloader->take(frequenciesByLength)) {
+            // The new model is the file's; saving after hot reload is turned
+            // off merges only what was learned on top of it.
+            mergeBase = frequenciesByLength.snapshot();
+            predictionCache.clear();
+            if (outputFile.is_open()) {
+                outputFile << "Reloaded frequency file " << modelPath << '\n';
+            }
+        }
+        if (replica && replica->take(frequenciesByLength)) {
+            predictionCache.clear();
+            if (outputFile.is_open()) {
+                outputFile << "Merged replica model, epoch " << replica->getAdoptedEpoch() << '\n';
+            }
+        }
         
         if (!history.empty() && outputFile.is_open()) {
             const auto& lastMove = history.back();
             Move humanMove = lastMove.first;
-            outputFile << "Round " << roundNumber << std::endl;
+            outputFile << "Round " << roundNumber << '\n';
             outputFile << "  HUMAN's choice? " 
                        << (humanMove == Move::ROCK ? "r" : (humanMove == Move::PAPER ? "p" : "s"))
-                       << std::endl;
-            std::string humanMoveStr = moveToString(humanMove);
-            for (char& c : humanMoveStr) c = std::toupper(c);
-            outputFile << "  HUMAN chose " << humanMoveStr << std::endl;
+                       << '\n';
+            outputFile << "  HUMAN chose " << moveNameUpper(humanMove) << '\n';
         } else if (outputFile.is_open()) {
-            outputFile << "Round " << roundNumber << std::endl;
+            outputFile << "Round " << roundNumber << '\n';
         }
         
         // If insufficient history for any sequence length, choose random.
@@ -193,200 +459,426 @@ public:
         if (!sufficientHistory) {
             predictionValid = false;
             if (outputFile.is_open()) {
-                outputFile << "    Insufficient history to predict across any sequence length." << std::endl;
-                outputFile << "    Computer will choose randomly." << std::endl;
+                outputFile << "    Insufficient history to predict across any sequence length." << '\n';
+                outputFile << "    Computer will choose randomly." << '\n';
             }
-            int randomNum = std::rand() % 3;
-            Move computerMove = static_cast<Move>(randomNum);
+            Move computerMove = randomMove();
             
             // Log and determine winner if possible
             if (!history.empty() && outputFile.is_open()) {
-                std::string computerMoveStr = moveToString(computerMove);
-                for (char& c : computerMoveStr) c = std::toupper(c);
-                outputFile << "  COMPUTER chose " << computerMoveStr << std::endl;
+                outputFile << "  COMPUTER chose " << moveNameUpper(computerMove) << '\n';
                 const auto& lastMove = history.back();
                 Move humanMove = lastMove.first;
                 int result = determineWinner(humanMove, computerMove);
-                std::string winner = (result > 0 ? "HUMAN" : (result < 0 ? "COMPUTER" : "TIE"));
                 if (result > 0) humanWins++;
                 else if (result < 0) computerWins++;
                 else ties++;
-                outputFile << "  The winner is: " << winner << std::endl << std::endl;
+                outputFile << "  The winner is: " << winnerName(result) << '\n' << '\n';
             }
             return computerMove;
         }
         
         // Aggregate predictions from all sequence lengths.
-        Move predictedMove = aggregatePredictions(history);
+        Move predictedMove = predictNextMove(history);
         lastPredictedHumanMove = predictedMove;
         
         if (outputFile.is_open()) {
-            std::string predictedMoveStr = (predictedMove == Move::ROCK ? "ROCK" :
-                                             (predictedMove == Move::PAPER ? "PAPER" : "SCISSORS"));
-            outputFile << "    Aggregated predicted human choice: " << predictedMoveStr << std::endl;
+            outputFile << "    Aggregated predicted human choice: " << moveNameUpper(predictedMove) << '\n';
         }
         
         // Choose the move that beats the aggregated prediction.
-        Move computerMove = chooseCounterMove(predictedMove);
+        Move computerMove = counterMove(predictedMove);
         
         if (outputFile.is_open()) {
-            std::string computerMoveStr = moveToString(computerMove);
-            for (char& c : computerMoveStr) c = std::toupper(c);
-            outputFile << "  COMPUTER chose " << computerMoveStr << std::endl;
+            outputFile << "  COMPUTER chose " << moveNameUpper(computerMove) << '\n';
             const auto& lastMove = history.back();
             Move humanMove = lastMove.first;
             int result = determineWinner(humanMove, computerMove);
-            std::string winner = (result > 0 ? "HUMAN" : (result < 0 ? "COMPUTER" : "TIE"));
             if (result > 0) humanWins++;
             else if (result < 0) computerWins++;
             else ties++;
-            outputFile << "  The winner is: " << winner << std::endl << std::endl;
+            outputFile << "  The winner is: " << winnerName(result) << '\n' << '\n';
         }
         
         return computerMove;
     }
     
     void updateFrequencies(const std::vector<std::pair<Move, Move>>& history) override {
-        // Update each frequency table for every sequence length.
-        for (int seqLen : seqLengths) {
-            if (history.size() < static_cast<size_t>(seqLen)) {
-                continue; // Not enough rounds for this sequence length
+        if (adaptiveOrders && !history.empty()) {
+            scoreOrderPredictions(history.back().first);
+        }
+        
+        // Update each frequency table for every sequence length, summing the
+        // new counts for the prediction cache.
+        int64_t aggregated[MOVES] = {};
+        int aggregatedMask = 0;
+        uint64_t combinedKey = 0;  // the longest order's context
+        for (size_t i = 0; i < seqLengths.size(); ++i) {
+            int seqLen = seqLengths[i];
+            if (history.size() < static_cast<size_t>(seqLen) || !isOrderEnabled(i)) {
+                continue; // Not enough rounds for this sequence length, or order skipped
             }
             int start = history.size() - seqLen;
-            std::string key = movesToKey(history, start, seqLen - 1);
-            frequenciesByLength[seqLen][key][history.back().first]++;
+            uint64_t key = movesToKey(history, start, seqLen - 1);
+            if (sharedModel) {
+                sharedModel->increment(seqLen, key, history.back().first);
+                continue;
+            }
+            const FrequencyModel::Context& context = frequenciesByLength.increment(seqLen, key, history.back().first);
+            for (int m = 0; m < MOVES; ++m) {
+                aggregated[m] += context.counts[m];
+            }
+            aggregatedMask |= context.mask;
+            combinedKey = key;
+            if (i == 0) {
+                // The shortest order is counted whenever any order is.
+                predictionCache.recordRound(key, history.back().first);
+            }
+            // Halving may have lowered counts the cache relies on. Also true
+            // when the counter simply reached this value, which is rare.
+            if (context.counts[static_cast<int>(history.back().first)] == FrequencyModel::COUNTER_MAX / 2 + 1) {
+                predictionCache.clear();
+            }
+            if (replica) {
+                replica->record(seqLen, key, history.back().first);
+            }
+        }
+        if (replica) {
+            replica->endRound();
+        }
+        // Every order was counted after the combined context just played, so
+        // its new prediction is known without another lookup.
+        if (canCachePrediction(history.size() - 1) && !predictionCache.isBypassed()) {
+            predictionCache.store(combinedKey, aggregateMove(aggregated, aggregatedMask), aggregated, true);
+        }
+        if (sketch && history.size() >= static_cast<size_t>(longOrderMin)) {
+            // Contexts of the rounds before the one just played.
+            int rounds = std::min(static_cast<int>(history.size()) - 1, longOrderMax - 1);
+            ContextSketch::hashContexts(history, history.size() - 1, rounds, sketchContexts.data());
+            for (int seqLen = longOrderMin; seqLen <= rounds + 1; ++seqLen) {
+                sketch->prefetch(sketchContexts[seqLen - 2]);
+            }
+            for (int seqLen = longOrderMin; seqLen <= rounds + 1; ++seqLen) {
+                sketch->add(sketchContexts[seqLen - 2], history.back().first);
+            }
+        }
+        
+        if (adaptiveOrders) {
+            advanceProbes();
+        }
+        
+        if (autosaveInterval > 0 && !reloader && !replica && !sharedModel && ++updatesSinceAutosave >= autosaveInterval) {
+            updatesSinceAutosave = 0;
+            if (!playerId.empty()) {
+                profiles->save(playerId, frequenciesByLength);
+            } else if (!modelPath.empty()) {
+                FrequencyModel::Snapshot current = frequenciesByLength.snapshot();
+                saver->submitMerge(mergeBase, current, modelPath, modelFormat);
+                mergeBase = std::move(current);
+            }
         }
     }
     
     void saveState() override {
         if (outputFile.is_open()) {
             int totalRounds = humanWins + computerWins + ties;
-            outputFile << "Match stats" << std::endl;
-            outputFile << "-----------" << std::endl;
+            outputFile << "Match stats" << '\n';
+            outputFile << "-----------" << '\n';
             outputFile << "   Human wins: " << std::setw(5) << humanWins << "  " 
-                       << std::setw(3) << (totalRounds > 0 ? (humanWins * 100 / totalRounds) : 0) << "%" << std::endl;
+                       << std::setw(3) << (totalRounds > 0 ? (humanWins * 100 / totalRounds) : 0) << "%" << '\n';
             outputFile << "Computer wins: " << std::setw(5) << computerWins << "  " 
-                       << std::setw(3) << (totalRounds > 0 ? (computerWins * 100 / totalRounds) : 0) << "%" << std::endl;
+                       << std::setw(3) << (totalRounds > 0 ? (computerWins * 100 / totalRounds) : 0) << "%" << '\n';
             outputFile << "         Ties: " << std::setw(5) << ties << "  " 
-                       << std::setw(3) << (totalRounds > 0 ? (ties * 100 / totalRounds) : 0) << "%" << std::endl;
-            outputFile << std::endl;
+                       << std::setw(3) << (totalRounds > 0 ? (ties * 100 / totalRounds) : 0) << "%" << '\n';
+            outputFile << '\n';
         }
         
-        // Save all frequency tables to file "freq.txt"
-        std::ofstream file("freq.txt");
-        if (!file.is_open()) {
-            std::cerr << "Failed to open file for saving strategy data." << std::endl;
+        if (!playerId.empty()) {
+            profiles->save(playerId, frequenciesByLength);
             return;
         }
-        
-        // Write a legend
-        file << "# Legend:" << std::endl;
-        file << "# Each block corresponds to a sequence length (N) frequency table." << std::endl;
-        file << "# For a given sequence length N, keys are constructed from the last (N-1) rounds," << std::endl;
-        file << "# and the following lines show the frequencies for each human move that followed that sequence." << std::endl;
-        file << std::endl;
-        
-        // Write frequency data for each sequence length
-        file << frequenciesByLength.size() << std::endl;
-        for (const auto& lengthEntry : frequenciesByLength) {
-            int seqLen = lengthEntry.first;
-            file << "# Sequence length: " << seqLen << std::endl;
-            file << lengthEntry.second.size() << std::endl;
-            for (const auto& entry : lengthEntry.second) {
-                std::string key = entry.first;
-                file << key << " " << entry.second.size() << " # Key for N=" << seqLen << std::endl;
-                for (const auto& moveFreq : entry.second) {
-                    file << static_cast<int>(moveFreq.first) << " " << moveFreq.second << " # " 
-                         << (moveFreq.first == Move::ROCK ? "R" : (moveFreq.first == Move::PAPER ? "P" : "S")) << std::endl;
-                }
+        // The shared model already has every process's rounds; the file
+        // becomes a copy of it.
+        if (sharedModel) {
+            if (!modelPath.empty() && sharedModel->save(modelPath, modelFormat) && outputFile.is_open()) {
+                outputFile << "Writing frequency file " << modelPath << " from the shared model" << '\n';
             }
+            return;
         }
         
-        file.close();
+        // Save all frequency tables to the model file ("freq.txt" by default).
+        // A hot-reloaded model file belongs to whoever retrains it, a
+        // replicated model to the owner of the ReplicatedModel.
+        if (modelPath.empty() || reloader || replica) {
+            return;
+        }
+        // Other processes may have saved since this one loaded the file, so
+        // only what was learned since is merged into it.
+        FrequencyModel::Snapshot current = frequenciesByLength.snapshot();
+        if (saver) {
+            saver->submitMerge(mergeBase, current, modelPath, modelFormat);
+        } else if (!SharedModelFile::save(mergeBase, current, modelPath, modelFormat)) {
+            return;
+        }
+        mergeBase = std::move(current);
         
         if (outputFile.is_open()) {
-            outputFile << "Writing frequency file freq.txt: Frequency data for " 
-                       << frequenciesByLength.size() << " sequence lengths." << std::endl;
+            outputFile << "Writing frequency file " << modelPath << ": Frequency data for " 
+                       << frequenciesByLength.seqLengths().size() << " sequence lengths." << '\n';
         }
     }
     
+    // Write the frequency tables to 'path' in the model file format
+    // (freq.txt text unless setModelFileFormat chose the compact one),
+    // replacing the file; saveState() merges into it instead.
+    bool saveModel(const std::string& path) const {
+        return FrequencyFileWriter::write(frequenciesByLength, path, modelFormat);
+    }
+    
     void loadState() override {
-        std::ifstream file("freq.txt");
-        if (!file.is_open()) {
-            std::cerr << "No previous strategy data found. Starting fresh." << std::endl;
+        if (modelPath.empty() || sharedModel) {
             return;
         }
-        
         frequenciesByLength.clear();
-        std::string line;
-        int numBlocks = 0;
-        bool foundNumBlocks = false;
-        
-        // Skip comments to find the number of sequence blocks
-        while (std::getline(file, line)) {
-            if (line.empty() || line[0] == '#') continue;
-            std::istringstream iss(line);
-            iss >> numBlocks;
-            foundNumBlocks = true;
-            break;
-        }
-        
-        if (!foundNumBlocks) {
+        predictionCache.clear();
+        FrequencyFileReader::Status status = SharedModelFile::load(modelPath, frequenciesByLength);
+        mergeBase = frequenciesByLength.snapshot();
+        if (status == FrequencyFileReader::Status::NotFound) {
+            std::cerr << "No previous strategy data found. Starting fresh." << std::endl;
+        } else if (status == FrequencyFileReader::Status::Invalid) {
             std::cerr << "Invalid frequency file format." << std::endl;
-            return;
         }
-        
-        // For each block, read its frequency table
-        for (int b = 0; b < numBlocks; ++b) {
-            int seqLen = 0;
-            // Skip comments until we get the sequence length header
-            while (std::getline(file, line)) {
-                if (!line.empty() && line[0] == '#') {
-                    if (line.find("Sequence length:") != std::string::npos) {
-                        std::istringstream iss(line.substr(line.find(":") + 1));
-                        iss >> seqLen;
-                        break;
-                    }
-                }
-            }
-            if (seqLen == 0) continue;
-            
-            int numEntries = 0;
-            while (std::getline(file, line)) {
-                if (line.empty() || line[0] == '#') continue;
-                std::istringstream iss(line);
-                iss >> numEntries;
-                break;
-            }
-            
-            for (int i = 0; i < numEntries; ++i) {
-                std::string key;
-                int numMoves = 0;
-                while (std::getline(file, line)) {
-                    if (line.empty() || line[0] == '#') continue;
-                    std::istringstream iss(line);
-                    iss >> key >> numMoves;
-                    break;
-                }
-                for (int j = 0; j < numMoves; ++j) {
-                    int moveInt, freq;
-                    while (std::getline(file, line)) {
-                        if (line.empty() || line[0] == '#') continue;
-                        std::istringstream iss(line);
-                        iss >> moveInt >> freq;
-                        frequenciesByLength[seqLen][key][static_cast<Move>(moveInt)] = freq;
-                        break;
-                    }
-                }
-            }
-        }
-        file.close();
     }
     
     std::string getName() const override {
         return "Smart";
     }
 
+    // Enable adaptive order selection: sequence lengths that do not improve on
+    // shorter ones for this opponent stop being looked up and updated, and are
+    // re-probed periodically. Off by default, which keeps every order in use.
+    void setAdaptiveOrders(bool enabled) {
+        adaptiveOrders = enabled;
+        orderStats.assign(seqLengths.size(), OrderStats());
+        pendingOrderPrediction.assign(seqLengths.size(), -1);
+        roundsSinceProbe = 0;
+    }
+
+    bool isAdaptiveOrders() const {
+        return adaptiveOrders;
+    }
+
+    // Answer predictions from the prediction cache where it applies (on by
+    // default). The moves are the same either way; off is for comparison.
+    void setPredictionCache(bool enabled) {
+        predictionCacheEnabled = enabled;
+        predictionCache.clear();
+    }
+
+    const PredictionCache::Stats& getPredictionCacheStats() const {
+        return predictionCache.getStats();
+    }
+
+    // Also predict from every sequence length after the exact ones up to
+    // 'maxOrder' (at most MAX_LONG_ORDER), counted in a Count-Min sketch of
+    // about 'sketchBytes' bytes (see ContextSketch). Their estimated counts are
+    // added to the exact ones. The sketch is not saved with the model and is
+    // not part of adaptive order selection. A maxOrder no longer than the
+    // exact orders turns it off.
+    void setLongOrders(int maxOrder, std::size_t sketchBytes = std::size_t(1) << 20) {
+        longOrderMin = seqLengths.back() + 1;
+        longOrderMax = std::min(maxOrder, MAX_LONG_ORDER);
+        if (longOrderMax < longOrderMin) {
+            sketch.reset();
+            longOrderMax = 0;
+            return;
+        }
+        sketch = std::make_unique<ContextSketch>(sketchBytes);
+        sketchContexts.assign(static_cast<size_t>(longOrderMax), 0);
+    }
+
+    // Longest sequence length in use, counting the sketched ones.
+    int getMaxOrder() const {
+        return sketch ? longOrderMax : seqLengths.back();
+    }
+
+    const ContextSketch* getSketch() const {
+        return sketch.get();
+    }
+
+    // Save the model on a background thread from a copy-on-write snapshot,
+    // so saveState() returns as soon as the snapshot is taken. Turning it off
+    // waits for the saves already queued.
+    void setBackgroundSave(bool enabled) {
+        if (!enabled) {
+            autosaveInterval = 0;
+            saver.reset();
+        } else if (!saver) {
+            saver = std::make_unique<ModelSaver>();
+        }
+    }
+
+    bool isBackgroundSave() const {
+        return saver != nullptr;
+    }
+
+    // Format used when saving the model file; loading accepts either.
+    void setModelFileFormat(ModelFileFormat format) {
+        modelFormat = format;
+    }
+
+    ModelFileFormat getModelFileFormat() const {
+        return modelFormat;
+    }
+
+    // Also save the model in the background every 'rounds' rounds (0 disables it).
+    void setAutosaveInterval(int rounds) {
+        if (rounds > 0) {
+            setBackgroundSave(true);
+        }
+        autosaveInterval = rounds > 0 ? rounds : 0;
+        updatesSinceAutosave = 0;
+    }
+
+    // Watch the model file and switch to each new version of it, checking
+    // every 'pollInterval' (see ModelReloader). The game never waits for a
+    // load; rounds learned since the last version are replaced with it. The
+    // model file is then treated as read-only: saveState() and autosave no
+    // longer write it. Has no effect without a model file, with a player set or
+    // with a shared model.
+    void setHotReload(bool enabled, std::chrono::milliseconds pollInterval = std::chrono::milliseconds(1000)) {
+        reloader.reset();
+        if (enabled && !modelPath.empty() && playerId.empty() && !sharedModel) {
+            reloader = std::make_unique<ModelReloader>(modelPath, pollInterval);
+        }
+    }
+
+    bool isHotReload() const {
+        return reloader != nullptr;
+    }
+
+    ModelReloader* getReloader() const {
+        return reloader.get();
+    }
+
+    // Learn as one worker of a ReplicatedModel: the model is replaced by the
+    // replica's on the next move and after every merge, and updates are also
+    // logged in the replica. The model file is not written. Pass
+    // null to stop; the model then stays as it is. Ignored with a player set or
+    // a shared model.
+    void setReplica(ReplicatedModel::Replica* workerReplica) {
+        replica = playerId.empty() && !sharedModel ? workerReplica : nullptr;
+    }
+
+    ReplicatedModel::Replica* getReplica() const {
+        return replica;
+    }
+
+    // Predict from and learn into a model shared with other processes (see
+    // SharedMemoryModel) instead of a private one, which is discarded. The
+    // prediction cache and autosave are not used, and saveState() writes the
+    // whole shared model to the model file. Pass null to go back to an empty
+    // private model. Refused, with false, while a player is set or with hot
+    // reload or a replica, which each replace the model themselves.
+    bool setSharedModel(std::shared_ptr<SharedMemoryModel> model) {
+        if (!playerId.empty() || reloader || replica) {
+            std::cerr << "A shared model cannot be used with player profiles, hot reload or replicas." << std::endl;
+            return false;
+        }
+        sharedModel = std::move(model);
+        frequenciesByLength.clear();
+        mergeBase = FrequencyModel::Snapshot();
+        predictionCache.clear();
+        return true;
+    }
+
+    const SharedMemoryModel* getSharedModel() const {
+        return sharedModel.get();
+    }
+
+    // Learn per player: models are checked out of 'store' by player id (see
+    // setPlayer). The store must be set before the first setPlayer call.
+    void setProfileStore(std::shared_ptr<ProfileStore> store) {
+        releasePlayer();
+        profiles = std::move(store);
+    }
+
+    // Switch to the given player's profile, returning the current one to the
+    // store. The model loaded from modelPath at construction is discarded.
+    // Adaptive order statistics start over, since they describe one opponent.
+    // Refused while a shared model is set.
+    bool setPlayer(const std::string& id) {
+        if (!profiles) {
+            std::cerr << "No profile store set." << std::endl;
+            return false;
+        }
+        if (sharedModel) {
+            std::cerr << "Player profiles cannot be used with a shared model." << std::endl;
+            return false;
+        }
+        releasePlayer();
+        reloader.reset();  // the profile replaces the model file
+        replica = nullptr;
+        mergeBase = FrequencyModel::Snapshot();
+        frequenciesByLength.clear();
+        predictionCache.clear();
+        if (!profiles->checkOut(id, frequenciesByLength)) {
+            return false;
+        }
+        playerId = id;
+        if (adaptiveOrders) {
+            setAdaptiveOrders(true);
+        }
+        return true;
+    }
+
+    // Return the current player's profile to the store.
+    void releasePlayer() {
+        if (!playerId.empty()) {
+            profiles->checkIn(playerId, std::move(frequenciesByLength));
+            frequenciesByLength = FrequencyModel();
+            predictionCache.clear();
+            playerId.clear();
+        }
+    }
+
+    const std::string& getPlayer() const {
+        return playerId;
+    }
+
+    // Block until every background save has reached the disk.
+    void waitForSaves() {
+        if (saver) {
+            saver->waitIdle();
+        }
+        if (profiles) {
+            profiles->waitIdle();
+        }
+    }
+
+    ModelSaver::Stats getSaveStats() const {
+        return saver ? saver->getStats() : ModelSaver::Stats();
+    }
+
+    // Per-order statistics, parallel to getSeqLengths(). Only collected in adaptive mode.
+    const std::vector<OrderStats>& getOrderStats() const {
+        return orderStats;
+    }
+
+    const std::vector<int>& getSeqLengths() const {
+        return seqLengths;
+    }
+
+    // Number of contexts stored for one sequence length.
+    size_t getContextCount(int seqLen) const {
+        return sharedModel ? sharedModel->contextCount(seqLen) : frequenciesByLength.contextCount(seqLen);
+    }
+
+    // Read-only access to the frequency tables, for tools and diagnostics.
+    const FrequencyModel& getModel() const {
+        return frequenciesByLength;
+    }
+
     // NEW: Getter for the last predicted human move.
     Move getLastPredictedHumanMove() const {
         return lastPredictedHumanMove;
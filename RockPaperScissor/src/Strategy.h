@@ -5,9 +5,15 @@
 #include <vector>
 #include <string>
 
-class Strategy {
+// A computer strategy for the moves of MoveSet. The game plays
+// Rock-Paper-Scissors through Strategy; strategies written for any move set
+// derive from BasicStrategy<MoveSet>.
+template <typename MoveSet>
+class BasicStrategy {
 public:
-    virtual ~Strategy() = default;
+    using Move = typename MoveSet::Move;
+
+    virtual ~BasicStrategy() = default;
     virtual Move makeMove(const std::vector<std::pair<Move, Move>>& history) = 0;
     virtual void updateFrequencies(const std::vector<std::pair<Move, Move>>& history) = 0;
     virtual void saveState() = 0;
@@ -15,4 +21,6 @@ public:
     virtual std::string getName() const = 0;
 };
 
+using Strategy = BasicStrategy<RockPaperScissors>;
+
 #endif
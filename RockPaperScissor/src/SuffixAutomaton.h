@@ -0,0 +1,119 @@
+#ifndef SUFFIX_AUTOMATON_H
+#define SUFFIX_AUTOMATON_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Suffix automaton of a growing sequence of symbols 0..ALPHABET-1, built
+// online (Blumer et al.): appending a symbol is amortized O(1) and adds at
+// most two states.
+//
+// Each state stands for the substrings that end at the same set of
+// positions, and its suffix link leads to the state of its longest suffix
+// that also ends elsewhere. So once a symbol is appended, the link of the
+// state for the whole sequence is the longest suffix that occurred before.
+// Each state remembers one position where its substrings ended, and the
+// symbol after that position is what followed the repetition. That
+// position is the last time the state was the longest repetition, or, for
+// a state that has not been yet, the one it was created with. Keeping the
+// true latest occurrence would mean walking the suffix links every round.
+template <int ALPHABET>
+class SuffixAutomaton {
+private:
+    static constexpr int32_t NONE = -1;
+
+    struct State {
+        int32_t length;  // of the longest substring in the state
+        int32_t link;    // NONE for the start state
+        int32_t end;     // a position where the state's substrings end
+        int32_t next[ALPHABET];
+    };
+
+    std::vector<State> states;
+    std::vector<uint8_t> symbols;
+    int32_t last = 0;           // state of the whole sequence
+    int32_t matchLength = 0;    // of the longest earlier repetition of a suffix
+    int32_t matchEnd = NONE;    // where that repetition ended
+
+    int32_t addState(int32_t length, int32_t link, int32_t end) {
+        State state;
+        state.length = length;
+        state.link = link;
+        state.end = end;
+        for (int32_t& target : state.next) {
+            target = NONE;
+        }
+        states.push_back(state);
+        return static_cast<int32_t>(states.size()) - 1;
+    }
+
+public:
+    SuffixAutomaton() {
+        addState(0, NONE, NONE);
+    }
+
+    void append(int symbol) {
+        int32_t position = static_cast<int32_t>(symbols.size());
+        symbols.push_back(static_cast<uint8_t>(symbol));
+        int32_t current = addState(states[last].length + 1, NONE, position);
+        int32_t p = last;
+        while (p != NONE && states[p].next[symbol] == NONE) {
+            states[p].next[symbol] = current;
+            p = states[p].link;
+        }
+        if (p == NONE) {
+            states[current].link = 0;
+        } else {
+            int32_t q = states[p].next[symbol];
+            if (states[p].length + 1 == states[q].length) {
+                states[current].link = q;
+            } else {
+                // q's shorter substrings now also end here: split them off.
+                State clone = states[q];
+                clone.length = states[p].length + 1;
+                states.push_back(clone);
+                int32_t cloneId = static_cast<int32_t>(states.size()) - 1;
+                while (p != NONE && states[p].next[symbol] == q) {
+                    states[p].next[symbol] = cloneId;
+                    p = states[p].link;
+                }
+                states[q].link = cloneId;
+                states[current].link = cloneId;
+            }
+        }
+        last = current;
+
+        int32_t repeat = states[current].link;
+        matchLength = states[repeat].length;
+        matchEnd = repeat == 0 ? NONE : states[repeat].end;
+        if (repeat != 0) {
+            states[repeat].end = position;
+        }
+    }
+
+    // Length of the longest suffix of the sequence that occurred before, 0 if none.
+    int getMatchLength() const {
+        return matchLength;
+    }
+
+    // The symbol that followed that earlier occurrence, or -1 without one.
+    int predictNext() const {
+        return matchEnd == NONE ? -1 : symbols[static_cast<std::size_t>(matchEnd) + 1];
+    }
+
+    std::size_t size() const {
+        return symbols.size();
+    }
+
+    std::size_t getStateCount() const {
+        return states.size();
+    }
+
+    // Bytes held (states and symbols including spare capacity).
+    std::size_t getMemoryUsage() const {
+        return states.capacity() * sizeof(State) + symbols.capacity();
+    }
+};
+
+#endif
@@ -3,10 +3,16 @@
 #include "ComputerPlayer.h"
 #include "RandomStrategy.h"
 #include "SmartStrategy.h"
+#include "ContextTreeStrategy.h"
+#include "LongestMatchStrategy.h"
+#include "ScriptedPlayer.h"
 #include <iostream>
+#include <fstream>
 #include <memory>
 #include <string>
 #include <limits>
+#include <ctime>
+#include <vector>
 
 
 void getChoice(int& choice) {
@@ -24,7 +30,318 @@ void getChoice(int& choice) {
      }
 }
 
-int main() {
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--script <file|-> [--strategy random|smart|tree|match] [--rounds N] [--seed S]" << std::endl;
+    std::cerr << "        [--output verbose|batch|quiet] [--progress N] [--adaptive] [--max-order N]" << std::endl;
+    std::cerr << "        [--autosave N] [--model-format text|compact] [--analytics [--window N]]" << std::endl;
+    std::cerr << "        [--shadow random|smart|tree|match[,...]] [--reload-model MS] [--long-orders N]" << std::endl;
+    std::cerr << "        [--player ID [--profile-dir DIR] [--profile-cap MiB]] [--shared-model NAME]" << std::endl;
+    std::cerr << "        [--strategy-log FILE]]" << std::endl;
+    std::cerr << "       " << program << " --remove-shared-model NAME" << std::endl;
+    std::cerr << "  Without --script the game is played interactively." << std::endl;
+    std::cerr << "  --script    read the human moves (R/P/S) from a file, or from stdin with '-'" << std::endl;
+    std::cerr << "  --strategy  computer strategy for scripted games (default: smart);" << std::endl;
+    std::cerr << "              tree is the variable-order context tree, match plays against what" << std::endl;
+    std::cerr << "              followed the longest earlier repetition of the game's history" << std::endl;
+    std::cerr << "  --rounds    number of rounds to play (default: until the script ends)" << std::endl;
+    std::cerr << "  --seed      seed for the computer's random choices (default: current time)" << std::endl;
+    std::cerr << "  --output    per-round output: verbose (flushed per line), batch (buffered, default)," << std::endl;
+    std::cerr << "              or quiet (summary only)" << std::endl;
+    std::cerr << "  --progress  print the running score every N rounds" << std::endl;
+    std::cerr << "  --max-order longest sequence length used by the tree strategy (default: 16)" << std::endl;
+    std::cerr << "  --adaptive  smart strategy skips sequence lengths that do not help against this opponent" << std::endl;
+    std::cerr << "  --long-orders  smart strategy also predicts from sequence lengths 8 to N (at most 64)," << std::endl;
+    std::cerr << "              counted approximately in a fixed 1 MiB sketch that is not saved" << std::endl;
+    std::cerr << "  --autosave  smart strategy saves its model every N rounds on a background thread" << std::endl;
+    std::cerr << "  --reload-model  smart strategy checks freq.txt every MS milliseconds and switches to" << std::endl;
+    std::cerr << "              each new version without stopping the game; it no longer saves freq.txt" << std::endl;
+    std::cerr << "  --model-format  file format the smart strategy saves its model in (default: text);" << std::endl;
+    std::cerr << "              compact is a binary format about ten times smaller. Either one loads." << std::endl;
+    std::cerr << "  --analytics print streaming statistics after the game: windowed rates, streaks," << std::endl;
+    std::cerr << "              move entropy, n-gram predictability and strategy accuracy" << std::endl;
+    std::cerr << "  --window    rounds per rolling window for --analytics (default: 100)" << std::endl;
+    std::cerr << "  --shadow    also run these strategies on the same game without affecting it, and" << std::endl;
+    std::cerr << "              report how they would have done (smart shadows start from an empty model)" << std::endl;
+    std::cerr << "  --player    smart strategy uses this player's own model, kept in" << std::endl;
+    std::cerr << "              <profile-dir>/<ID>.freq.txt (default dir: profiles), instead of freq.txt" << std::endl;
+    std::cerr << "  --profile-cap  memory cap in MiB for resident player profiles (default: 64)" << std::endl;
+    std::cerr << "  --shared-model  smart strategy learns into the shared-memory segment NAME, one model for" << std::endl;
+    std::cerr << "              every process that names it; the first one loads freq.txt into it, and each" << std::endl;
+    std::cerr << "              writes all of it back to freq.txt when its game ends (not with --player," << std::endl;
+    std::cerr << "              --reload-model or --autosave)" << std::endl;
+    std::cerr << "  --strategy-log  random or smart strategy writes its per-round log to FILE (default:" << std::endl;
+    std::cerr << "              output-<strategy>.txt with --output verbose, none with batch or quiet)" << std::endl;
+    std::cerr << "  --remove-shared-model  unlink the segment NAME and exit; processes that have it open" << std::endl;
+    std::cerr << "              keep using it, and the next --shared-model NAME creates a new one" << std::endl;
+}
+
+// Report how the adaptive smart strategy used each sequence length.
+void printOrderStats(const SmartStrategy& smart) {
+    const auto& seqLengths = smart.getSeqLengths();
+    const auto& stats = smart.getOrderStats();
+    std::cout << "\nSequence length usage:" << std::endl;
+    for (size_t i = 0; i < seqLengths.size(); ++i) {
+        const auto& s = stats[i];
+        std::cout << "  N=" << seqLengths[i]
+                  << "  lookups: " << s.lookups
+                  << "  hit rate: " << (s.lookups > 0 ? s.hits * 100 / s.lookups : 0) << "%"
+                  << "  accuracy: " << (s.hits > 0 ? s.correct * 100 / s.hits : 0) << "%"
+                  << "  contexts: " << smart.getContextCount(seqLengths[i])
+                  << (s.active ? "" : "  (inactive)") << std::endl;
+    }
+}
+
+// Command-line settings of a scripted game.
+struct ScriptOptions {
+    std::string scriptPath;
+    std::string strategyName = "smart";
+    int rounds = 0;
+    unsigned int seed = static_cast<unsigned int>(std::time(nullptr));
+    OutputMode outputMode = OutputMode::Batch;
+    int progressInterval = 0;
+    bool adaptiveOrders = false;
+    int maxOrder = 16;
+    int autosaveInterval = 0;
+    int reloadIntervalMs = 0;
+    int longOrders = 0;
+    ModelFileFormat modelFormat = ModelFileFormat::Text;
+    bool analytics = false;
+    int analyticsWindow = 100;
+    std::vector<std::string> shadowStrategies;
+    std::string playerId;
+    std::string profileDirectory = "profiles";
+    long long profileCapMiB = 64;
+    std::string sharedModelName;
+    std::string strategyLog;  // per-round strategy log; empty for none
+};
+
+// Non-interactive game: moves are streamed from the script and the strategy,
+// rounds and seed all come from the command line.
+int runScripted(const ScriptOptions& options) {
+    std::ifstream scriptFile;
+    std::istream* input = &std::cin;
+    if (options.scriptPath != "-") {
+        scriptFile.open(options.scriptPath, std::ios::binary);
+        if (!scriptFile.is_open()) {
+            std::cerr << "Failed to open script " << options.scriptPath << std::endl;
+            return 1;
+        }
+        input = &scriptFile;
+    }
+
+    std::unique_ptr<ComputerPlayer> computerPlayer;
+    SmartStrategy* smart = nullptr;
+    const std::string& strategyName = options.strategyName;
+    // The per-round log follows the console output: only verbose games keep it.
+    auto logPath = [&](const char* defaultLog) {
+        if (!options.strategyLog.empty()) {
+            return options.strategyLog;
+        }
+        return std::string(options.outputMode == OutputMode::Verbose ? defaultLog : "");
+    };
+    if (strategyName == "random" || strategyName == "1") {
+        computerPlayer = std::make_unique<ComputerPlayer>(
+            std::make_unique<RandomStrategy>(options.seed, logPath("output-random.txt")));
+    } else if (strategyName == "smart" || strategyName == "2") {
+        // With a player id the model comes from the player's profile, not freq.txt.
+        auto smartStrategy = std::make_unique<SmartStrategy>(
+            options.seed, options.playerId.empty() ? "freq.txt" : "", logPath("output-smart.txt"));
+        smartStrategy->setAdaptiveOrders(options.adaptiveOrders);
+        if (!options.sharedModelName.empty()) {
+            // The shared model replaces the private one that these would save or swap.
+            if (!options.playerId.empty() || options.reloadIntervalMs > 0 || options.autosaveInterval > 0) {
+                std::cerr << "--shared-model cannot be combined with --player, --reload-model or --autosave" << std::endl;
+                return 1;
+            }
+            std::shared_ptr<SharedMemoryModel> shared = SharedMemoryModel::open(options.sharedModelName, "freq.txt");
+            if (!shared || !smartStrategy->setSharedModel(std::move(shared))) {
+                return 1;
+            }
+        }
+        if (options.longOrders > 0) {
+            smartStrategy->setLongOrders(options.longOrders);
+        }
+        smartStrategy->setAutosaveInterval(options.autosaveInterval);
+        if (options.reloadIntervalMs > 0) {
+            smartStrategy->setHotReload(true, std::chrono::milliseconds(options.reloadIntervalMs));
+        }
+        smartStrategy->setModelFileFormat(options.modelFormat);
+        if (!options.playerId.empty()) {
+            auto store = std::make_shared<ProfileStore>(
+                options.profileDirectory, static_cast<size_t>(options.profileCapMiB) << 20);
+            store->setFileFormat(options.modelFormat);
+            smartStrategy->setProfileStore(store);
+            if (!smartStrategy->setPlayer(options.playerId)) {
+                return 1;
+            }
+        }
+        smart = smartStrategy.get();
+        computerPlayer = std::make_unique<ComputerPlayer>(std::move(smartStrategy));
+    } else if (strategyName == "tree") {
+        computerPlayer = std::make_unique<ComputerPlayer>(
+            std::make_unique<ContextTreeStrategy>(options.seed, 3, options.maxOrder));
+    } else if (strategyName == "match") {
+        computerPlayer = std::make_unique<ComputerPlayer>(std::make_unique<LongestMatchStrategy>(options.seed));
+    } else {
+        std::cerr << "Unknown strategy: " << strategyName << std::endl;
+        return 1;
+    }
+
+    auto scriptedPlayer = std::make_unique<ScriptedPlayer>(*input);
+    ScriptedPlayer* script = scriptedPlayer.get();
+
+    Game game(std::move(scriptedPlayer), std::move(computerPlayer), options.rounds);
+    game.setOutputMode(options.outputMode);
+    game.setProgressInterval(options.progressInterval);
+    GameAnalytics analytics(options.analyticsWindow);
+    if (options.analytics) {
+        game.setAnalytics(&analytics);
+    }
+    ShadowEvaluator shadows(options.analyticsWindow);
+    for (const std::string& name : options.shadowStrategies) {
+        if (name == "random") {
+            shadows.addShadow(std::make_unique<RandomStrategy>(options.seed, ""));
+        } else if (name == "smart") {
+            shadows.addShadow(std::make_unique<SmartStrategy>(options.seed, "", ""));
+        } else if (name == "match") {
+            shadows.addShadow(std::make_unique<LongestMatchStrategy>(options.seed));
+        } else {
+            shadows.addShadow(std::make_unique<ContextTreeStrategy>(options.seed, 3, options.maxOrder));
+        }
+    }
+    if (!options.shadowStrategies.empty()) {
+        game.setShadows(&shadows);
+    }
+    game.play();
+
+    if (options.analytics) {
+        std::cout << '\n';
+        analytics.report(std::cout);
+    }
+    if (!options.shadowStrategies.empty()) {
+        shadows.flush();
+        std::cout << '\n';
+        shadows.report(std::cout);
+    }
+    if (smart && smart->isAdaptiveOrders()) {
+        printOrderStats(*smart);
+    }
+    if (script->getSkippedChars() > 0) {
+        std::cerr << "Skipped " << script->getSkippedChars() << " invalid characters in the script." << std::endl;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    ScriptOptions options;
+    bool scripted = false;
+    std::string removeSharedModelName;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--script" && hasValue) {
+                options.scriptPath = argv[++i];
+                scripted = true;
+            } else if (arg == "--strategy" && hasValue) {
+                options.strategyName = argv[++i];
+            } else if (arg == "--rounds" && hasValue) {
+                options.rounds = std::stoi(argv[++i]);
+            } else if (arg == "--seed" && hasValue) {
+                options.seed = static_cast<unsigned int>(std::stoul(argv[++i]));
+            } else if (arg == "--output" && hasValue) {
+                std::string mode = argv[++i];
+                if (mode == "verbose") {
+                    options.outputMode = OutputMode::Verbose;
+                } else if (mode == "batch") {
+                    options.outputMode = OutputMode::Batch;
+                } else if (mode == "quiet") {
+                    options.outputMode = OutputMode::Quiet;
+                } else {
+                    throw std::invalid_argument(mode);
+                }
+            } else if (arg == "--progress" && hasValue) {
+                options.progressInterval = std::stoi(argv[++i]);
+            } else if (arg == "--max-order" && hasValue) {
+                options.maxOrder = std::stoi(argv[++i]);
+            } else if (arg == "--adaptive") {
+                options.adaptiveOrders = true;
+            } else if (arg == "--long-orders" && hasValue) {
+                options.longOrders = std::stoi(argv[++i]);
+            } else if (arg == "--reload-model" && hasValue) {
+                options.reloadIntervalMs = std::stoi(argv[++i]);
+            } else if (arg == "--autosave" && hasValue) {
+                options.autosaveInterval = std::stoi(argv[++i]);
+            } else if (arg == "--model-format" && hasValue) {
+                std::string format = argv[++i];
+                if (format == "text") {
+                    options.modelFormat = ModelFileFormat::Text;
+                } else if (format == "compact") {
+                    options.modelFormat = ModelFileFormat::Compact;
+                } else {
+                    throw std::invalid_argument(format);
+                }
+            } else if (arg == "--analytics") {
+                options.analytics = true;
+            } else if (arg == "--window" && hasValue) {
+                options.analyticsWindow = std::stoi(argv[++i]);
+            } else if (arg == "--shadow" && hasValue) {
+                std::string list = argv[++i];
+                size_t start = 0;
+                while (start <= list.size()) {
+                    size_t comma = list.find(',', start);
+                    std::string name = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+                    if (name != "random" && name != "smart" && name != "tree" && name != "match") {
+                        throw std::invalid_argument(name);
+                    }
+                    options.shadowStrategies.push_back(name);
+                    if (comma == std::string::npos) break;
+                    start = comma + 1;
+                }
+            } else if (arg == "--player" && hasValue) {
+                options.playerId = argv[++i];
+            } else if (arg == "--profile-dir" && hasValue) {
+                options.profileDirectory = argv[++i];
+            } else if (arg == "--profile-cap" && hasValue) {
+                options.profileCapMiB = std::stoll(argv[++i]);
+            } else if (arg == "--shared-model" && hasValue) {
+                options.sharedModelName = argv[++i];
+            } else if (arg == "--strategy-log" && hasValue) {
+                options.strategyLog = argv[++i];
+            } else if (arg == "--remove-shared-model" && hasValue) {
+                removeSharedModelName = argv[++i];
+            } else {
+                printUsage(argv[0]);
+                return arg == "--help" ? 0 : 1;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value for " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    if (!removeSharedModelName.empty()) {
+        if (argc != 3) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (!SharedMemoryModel::remove(removeSharedModelName)) {
+            std::cerr << "Failed to remove shared model " << removeSharedModelName << "." << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (scripted) {
+        // Scripts can be large; avoid the C stdio synchronisation cost.
+        std::ios::sync_with_stdio(false);
+        return runScripted(options);
+    }
+    if (argc > 1) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
     std::cout << "Welcome to Rock-Paper-Scissors Game!" << std::endl;
 
     char continueGame = 'c';
@@ -0,0 +1,161 @@
+#ifndef BENCH_COMMANDS_H
+#define BENCH_COMMANDS_H
+
+#include "Move.h"
+#include "SmartStrategy.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define RPS_BENCH_HAS_FORK 1
+#endif
+
+// The rps_bench commands and what several of them share. Each command lives
+// in tools/bench_<command>.cpp; rps_bench.cpp parses the command line and
+// calls it. A command returns the process exit code.
+namespace bench {
+
+struct Options {
+    long long rounds = 200000;
+    unsigned int seed = 1;
+    int maxOrder = 16;
+    long long saveEvery = 10000;
+    int players = 2000;
+    long long sessions = 10000;
+    int sessionRounds = 100;
+    long long profileCapMiB = 8;
+    std::string scriptPath;
+    long long scoreMiB = 256;
+    long long games = 2000;
+    int gameRounds = 1000;
+    int window = 100;
+    int threads = 4;
+    long long epochRounds = 1000;
+    int longOrders = 32;
+    int processes = 4;
+    long long sharedSlots = 1 << 18;
+    int writers = 16;  // past where a shared model costs less than private ones
+};
+
+int benchStrategies(const Options& options);
+int benchVariants(const Options& options);
+int benchModel(const Options& options);
+int benchSave(const Options& options);
+int benchProfiles(const Options& options);
+int benchCounters(const Options& options);
+int benchScore(const Options& options);
+int benchAnalytics(const Options& options);
+int benchCore(const Options& options, const std::string& engine);  // engine: smart, tree or match
+int benchCoroutines(const Options& options);
+int benchShadow(const Options& options);
+int benchReload(const Options& options);
+int benchReplicas(const Options& options);
+int benchSketch(const Options& options);
+int benchAllocs(const Options& options);
+int benchProcesses(const Options& options);
+int benchSharedMemory(const Options& options);
+int benchPredict(const Options& options);
+
+// Run fn() in a child process where possible and wait for it.
+template <typename Fn>
+void runIsolated(Fn fn) {
+#ifdef RPS_BENCH_HAS_FORK
+    pid_t child = fork();
+    if (child == 0) {
+        fn();
+        _exit(0);
+    }
+    if (child > 0) {
+        int status = 0;
+        waitpid(child, &status, 0);
+        return;
+    }
+#endif
+    fn();
+}
+
+using History = std::vector<std::pair<Move, Move>>;
+
+// A game to replay: the human moves of a simulated opponent or of a script,
+// with the moves SmartStrategy answered them with.
+struct RecordedGame {
+    std::string name;
+    History history;
+};
+
+inline History recordGame(const Options& options, const std::function<Move(const History&)>& nextHumanMove,
+                          long long rounds) {
+    SmartStrategy smart(options.seed, "", "");
+    History history;
+    history.reserve(static_cast<size_t>(rounds));
+    for (long long round = 0; round < rounds; ++round) {
+        Move humanMove = nextHumanMove(history);
+        history.emplace_back(humanMove, smart.makeMove(history));
+        smart.updateFrequencies(history);
+    }
+    return history;
+}
+
+// R/P/S characters of a script file; everything else is skipped.
+inline bool readScriptMoves(const std::string& path, std::vector<Move>& moves) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    char c;
+    while (file.get(c)) {
+        if (c == 'R' || c == 'r') moves.push_back(Move::ROCK);
+        else if (c == 'P' || c == 'p') moves.push_back(Move::PAPER);
+        else if (c == 'S' || c == 's') moves.push_back(Move::SCISSORS);
+    }
+    return true;
+}
+
+inline std::string percent(long long part, long long whole) {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(2) << (whole > 0 ? part * 100.0 / whole : 0.0);
+    return text.str();
+}
+
+// Digest of a model's contents, independent of context order.
+inline uint64_t modelDigest(const FrequencyModel& model) {
+    uint64_t digest = 0;
+    for (int seqLen : model.seqLengths()) {
+        model.forEachContext(seqLen, [&](const FrequencyModel::Context& context) {
+            uint64_t x = context.key() * 131 + static_cast<uint64_t>(seqLen);
+            for (int m = 0; m < FrequencyModel::MOVES; ++m) {
+                x = x * 1000003 + context.counts[m];
+            }
+            x = x * 257 + context.mask;
+            x = (x ^ (x >> 31)) * 0x9e3779b97f4a7c15ULL;
+            digest += x ^ (x >> 29);
+        });
+    }
+    return digest;
+}
+
+// Observations in the order-3 table of a model: one per round after the
+// first two, of every process that saved into it.
+template <typename Model>
+long long order3Observations(const Model& model) {
+    long long total = 0;
+    model.forEachContext(3, [&total](const typename Model::Context& context) {
+        for (int m = 0; m < Model::MOVES; ++m) {
+            total += context.counts[m];
+        }
+    });
+    return total;
+}
+
+} // namespace bench
+
+#endif
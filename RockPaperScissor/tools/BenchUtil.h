@@ -0,0 +1,144 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include "Move.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+// Heap accounting for the benchmark tool. rps_bench.cpp replaces the global
+// operator new/delete and keeps these counters up to date.
+namespace bench {
+
+struct AllocStats {
+    std::atomic<long long> allocations{0};
+    std::atomic<long long> frees{0};
+    std::atomic<long long> liveBytes{0};
+};
+
+inline AllocStats& allocStats() {
+    static AllocStats stats;
+    return stats;
+}
+
+// Resident set size of this process in bytes, or -1 where it is not available.
+inline long long currentRssBytes() {
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    long long totalPages = 0, residentPages = 0;
+    if (statm >> totalPages >> residentPages) {
+        return residentPages * static_cast<long long>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return -1;
+}
+
+// Scoped stopwatch.
+class Timer {
+private:
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+public:
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// Simulated human opponents, all driven by a seeded generator.
+enum class OpponentKind {
+    Random,  // uniform random moves
+    Cycle,   // repeats a fixed pattern (R R P S)
+    Markov,  // usually plays what beats its own previous move
+    Lag,     // mostly replays its move from five rounds ago, shifted by one
+    Counter,  // mostly plays what beats the computer's previous move
+    LongCycle // repeats a fixed random sequence of LONG_CYCLE moves
+};
+
+// Far longer than any context SmartStrategy or the context tree keeps.
+constexpr std::size_t LONG_CYCLE = 100;
+
+inline const std::vector<std::pair<std::string, OpponentKind>>& opponentKinds() {
+    static const std::vector<std::pair<std::string, OpponentKind>> kinds = {
+        {"random", OpponentKind::Random},
+        {"cycle", OpponentKind::Cycle},
+        {"markov", OpponentKind::Markov},
+        {"lag", OpponentKind::Lag},
+        {"counter", OpponentKind::Counter},
+        {"longcycle", OpponentKind::LongCycle},
+    };
+    return kinds;
+}
+
+inline Move beats(Move move) {
+    return counterMove(move);
+}
+
+// Opponents play the moves of any move set; Opponent plays Rock-Paper-Scissors.
+template <typename MoveSet>
+class BasicOpponent {
+public:
+    using Rules = MoveRules<MoveSet>;
+    using Move = typename Rules::Move;
+
+private:
+    OpponentKind kind;
+    std::mt19937 rng;
+    std::vector<Move> cycle;  // LongCycle's sequence
+
+    Move randomMove() {
+        return static_cast<Move>(std::uniform_int_distribution<int>(0, Rules::COUNT - 1)(rng));
+    }
+
+    bool chance(double p) {
+        return std::uniform_real_distribution<double>(0.0, 1.0)(rng) < p;
+    }
+
+public:
+    BasicOpponent(OpponentKind k, unsigned int seed) : kind(k), rng(seed) {
+        if (kind == OpponentKind::LongCycle) {
+            for (std::size_t i = 0; i < LONG_CYCLE; ++i) {
+                cycle.push_back(randomMove());
+            }
+        }
+    }
+
+    Move next(const std::vector<std::pair<Move, Move>>& history) {
+        size_t n = history.size();
+        switch (kind) {
+            case OpponentKind::Cycle: {
+                // Rock, Rock, Paper, Scissors in every move set.
+                static const Move pattern[] = {static_cast<Move>(0), static_cast<Move>(0),
+                                               static_cast<Move>(1), static_cast<Move>(2)};
+                return pattern[n % 4];
+            }
+            case OpponentKind::Markov:
+                if (n == 0 || !chance(0.8)) return randomMove();
+                return Rules::counter(history[n - 1].first);
+            case OpponentKind::Lag:
+                if (n < 5 || !chance(0.9)) return randomMove();
+                return Rules::counter(history[n - 5].first);
+            case OpponentKind::Counter:
+                if (n == 0 || !chance(0.8)) return randomMove();
+                return Rules::counter(history[n - 1].second);
+            case OpponentKind::LongCycle:
+                return cycle[n % LONG_CYCLE];
+            case OpponentKind::Random:
+            default:
+                return randomMove();
+        }
+    }
+};
+
+using Opponent = BasicOpponent<RockPaperScissors>;
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,305 @@
+#ifndef DIFF_HARNESS_H
+#define DIFF_HARNESS_H
+
+#include "BenchUtil.h"
+#include "ContextTreeStrategy.h"
+#include "FrequencyFileReader.h"
+#include "FrequencyFileWriter.h"
+#include "FrequencyModel.h"
+#include "ReferenceSmartStrategy.h"
+#include "SmartStrategy.h"
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Differential harness: plays seeded generated histories against the
+// reference SmartStrategy (tools/ReferenceSmartStrategy.h) and a candidate
+// engine side by side, and fails on the first round where the computer
+// move, the prediction or its validity differ, or on the first history whose
+// final counter state differs. Both engines get the same seed, so their
+// random fallbacks must also agree. Time spent inside each engine is
+// accumulated separately to report the relative speed.
+namespace bench {
+
+struct DiffOptions {
+    long long histories = 20000;
+    long long maxHistoryLength = 200;
+    unsigned int seed = 1;
+    std::string engine = "smart";
+    int roundTripEvery = 500;  // also compare after a save/load round trip every N histories
+    long long longHistoryLength = 100000;  // rounds of the final long history (0 skips it)
+};
+
+// A candidate engine as seen by the harness.
+class DiffCandidate {
+public:
+    virtual ~DiffCandidate() = default;
+    virtual Strategy& strategy() = 0;
+    virtual bool isPredictionValid() const = 0;
+    virtual Move getLastPredictedHumanMove() const = 0;
+    // Compare the counters against the reference tables; describe the first
+    // difference in 'error' and return false if there is one.
+    virtual bool matchesCounters(const ReferenceSmartStrategy& reference, std::string& error) = 0;
+};
+
+class SmartCandidate : public DiffCandidate {
+private:
+    SmartStrategy smart;
+    bool roundTrip;
+
+    static bool compareModel(const FrequencyModel& model, const ReferenceSmartStrategy& reference,
+                             std::string& error) {
+        for (const auto& lengthEntry : reference.getTables()) {
+            int seqLen = lengthEntry.first;
+            if (model.contextCount(seqLen) != lengthEntry.second.size()) {
+                error = "N=" + std::to_string(seqLen) + ": " + std::to_string(model.contextCount(seqLen)) +
+                        " contexts, reference has " + std::to_string(lengthEntry.second.size());
+                return false;
+            }
+            for (const auto& entry : lengthEntry.second) {
+                uint64_t key = 0;
+                FrequencyModel::parseKey(entry.first.data(), entry.first.size(), seqLen - 1, key);
+                const FrequencyModel::Context* context = model.find(seqLen, key);
+                if (!context) {
+                    error = "N=" + std::to_string(seqLen) + " key " + entry.first + " missing";
+                    return false;
+                }
+                int mask = 0;
+                for (const auto& moveFreq : entry.second) {
+                    int m = static_cast<int>(moveFreq.first);
+                    mask |= 1 << m;
+                    if (context->counts[m] != moveFreq.second) {
+                        error = "N=" + std::to_string(seqLen) + " key " + entry.first + " move " +
+                                std::to_string(m) + ": " + std::to_string(context->counts[m]) +
+                                ", reference " + std::to_string(moveFreq.second);
+                        return false;
+                    }
+                }
+                if (context->mask != mask) {
+                    error = "N=" + std::to_string(seqLen) + " key " + entry.first + ": move entries differ";
+                    return false;
+                }
+            }
+        }
+        // Every candidate table must also exist in the reference.
+        for (int seqLen : model.seqLengths()) {
+            if (model.contextCount(seqLen) > 0 && reference.getTables().count(seqLen) == 0) {
+                error = "N=" + std::to_string(seqLen) + " has contexts the reference does not";
+                return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    SmartCandidate(unsigned int seed, bool checkRoundTrip)
+        : smart(seed, "", ""), roundTrip(checkRoundTrip) {}
+
+    Strategy& strategy() override { return smart; }
+    bool isPredictionValid() const override { return smart.isPredictionValid(); }
+    Move getLastPredictedHumanMove() const override { return smart.getLastPredictedHumanMove(); }
+
+    bool matchesCounters(const ReferenceSmartStrategy& reference, std::string& error) override {
+        if (!compareModel(smart.getModel(), reference, error)) {
+            return false;
+        }
+        if (!roundTrip) {
+            return true;
+        }
+        // The written file must load back to the same counters, with both
+        // the reference loader and the current one, and so must the compact file.
+        const std::string path = "rps_bench_diff_model.txt";
+        const std::string compactPath = "rps_bench_diff_model.bin";
+        smart.saveModel(path);
+        FrequencyFileWriter::write(smart.getModel(), compactPath, ModelFileFormat::Compact);
+        ReferenceSmartStrategy reloadedReference(0, path);
+        SmartStrategy reloaded(0, path, "");
+        FrequencyModel threaded;
+        FrequencyFileReader::load(path, threaded, 4);
+        FrequencyModel compact;
+        FrequencyFileReader::load(compactPath, compact);
+        std::remove(path.c_str());
+        std::remove(compactPath.c_str());
+        if (!compareModel(reloaded.getModel(), reference, error)) {
+            error = "after reload: " + error;
+            return false;
+        }
+        if (!compareModel(threaded, reference, error)) {
+            error = "after 4-thread reload: " + error;
+            return false;
+        }
+        if (!compareModel(compact, reference, error)) {
+            error = "after compact reload: " + error;
+            return false;
+        }
+        if (!compareModel(smart.getModel(), reloadedReference, error)) {
+            error = "after reference reload: " + error;
+            return false;
+        }
+        return true;
+    }
+};
+
+// ContextTreeStrategy restricted to SmartStrategy's orders and blend.
+class ContextTreeCandidate : public DiffCandidate {
+private:
+    ContextTreeStrategy tree;
+
+public:
+    explicit ContextTreeCandidate(unsigned int seed) : tree(seed, 3, 7) {}
+
+    Strategy& strategy() override { return tree; }
+    bool isPredictionValid() const override { return tree.isPredictionValid(); }
+    Move getLastPredictedHumanMove() const override { return tree.getLastPredictedHumanMove(); }
+
+    bool matchesCounters(const ReferenceSmartStrategy& reference, std::string& error) override {
+        for (const auto& lengthEntry : reference.getTables()) {
+            int seqLen = lengthEntry.first;
+            int64_t referenceTotal = 0;
+            for (const auto& entry : lengthEntry.second) {
+                // The tree is keyed from the most recent round backwards.
+                std::vector<int> codes;
+                for (size_t i = entry.first.size(); i >= 2; i -= 2) {
+                    codes.push_back((entry.first[i - 2] - '0') * 3 + (entry.first[i - 1] - '0'));
+                }
+                const int32_t* counts = tree.findContextCounts(codes);
+                for (const auto& moveFreq : entry.second) {
+                    int m = static_cast<int>(moveFreq.first);
+                    referenceTotal += moveFreq.second;
+                    if (!counts || counts[m] != moveFreq.second) {
+                        error = "N=" + std::to_string(seqLen) + " key " + entry.first + " move " +
+                                std::to_string(m) + " differs";
+                        return false;
+                    }
+                }
+            }
+            if (tree.totalCount(seqLen) != referenceTotal) {
+                error = "N=" + std::to_string(seqLen) + " holds counts the reference does not";
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+inline std::unique_ptr<DiffCandidate> makeDiffCandidate(const std::string& engine, unsigned int seed,
+                                                        bool checkRoundTrip) {
+    if (engine == "smart") {
+        return std::make_unique<SmartCandidate>(seed, checkRoundTrip);
+    }
+    if (engine == "tree") {
+        return std::make_unique<ContextTreeCandidate>(seed);
+    }
+    return nullptr;
+}
+
+inline std::string describeRound(const std::vector<std::pair<Move, Move>>& history) {
+    std::ostringstream text;
+    size_t from = history.size() > 8 ? history.size() - 8 : 0;
+    for (size_t i = from; i < history.size(); ++i) {
+        text << " " << static_cast<int>(history[i].first) << static_cast<int>(history[i].second);
+    }
+    return text.str();
+}
+
+inline int runDiffHarness(const DiffOptions& options) {
+    if (!makeDiffCandidate(options.engine, 0, false)) {
+        std::cerr << "Unknown engine: " << options.engine << " (expected smart or tree)" << std::endl;
+        return 1;
+    }
+
+    const auto& kinds = opponentKinds();
+    std::mt19937 lengthRng(options.seed);
+    std::uniform_int_distribution<long long> lengthDist(1, options.maxHistoryLength);
+    double referenceSeconds = 0;
+    double candidateSeconds = 0;
+    long long totalRounds = 0;
+    std::vector<std::pair<Move, Move>> history;
+
+    // Plays one history through both engines; false on the first difference.
+    auto playHistory = [&](long long h, const std::pair<std::string, OpponentKind>& kind, long long length,
+                           bool roundTrip) {
+        unsigned int seed = options.seed + static_cast<unsigned int>(h);
+        ReferenceSmartStrategy reference(seed);
+        std::unique_ptr<DiffCandidate> candidate = makeDiffCandidate(options.engine, seed, roundTrip);
+        Opponent opponent(kind.second, seed);
+        history.clear();
+
+        for (long long round = 0; round < length; ++round) {
+            Move humanMove = opponent.next(history);
+
+            Timer referenceTimer;
+            Move referenceMove = reference.makeMove(history);
+            referenceSeconds += referenceTimer.seconds();
+            Timer candidateTimer;
+            Move candidateMove = candidate->strategy().makeMove(history);
+            candidateSeconds += candidateTimer.seconds();
+
+            bool sameValidity = reference.isPredictionValid() == candidate->isPredictionValid();
+            bool samePrediction = reference.getLastPredictedHumanMove() == candidate->getLastPredictedHumanMove();
+            if (referenceMove != candidateMove || !sameValidity || !samePrediction) {
+                std::cerr << "MISMATCH in history " << h << " (" << kind.first << " opponent, seed " << seed
+                          << ") at round " << round + 1 << std::endl;
+                std::cerr << "  last rounds (human,computer):" << describeRound(history) << std::endl;
+                std::cerr << "  reference: move " << static_cast<int>(referenceMove)
+                          << ", prediction " << static_cast<int>(reference.getLastPredictedHumanMove())
+                          << (reference.isPredictionValid() ? " (valid)" : " (invalid)") << std::endl;
+                std::cerr << "  candidate: move " << static_cast<int>(candidateMove)
+                          << ", prediction " << static_cast<int>(candidate->getLastPredictedHumanMove())
+                          << (candidate->isPredictionValid() ? " (valid)" : " (invalid)") << std::endl;
+                return false;
+            }
+
+            history.emplace_back(humanMove, referenceMove);
+            referenceTimer = Timer();
+            reference.updateFrequencies(history);
+            referenceSeconds += referenceTimer.seconds();
+            candidateTimer = Timer();
+            candidate->strategy().updateFrequencies(history);
+            candidateSeconds += candidateTimer.seconds();
+        }
+        totalRounds += length;
+
+        std::string error;
+        if (!candidate->matchesCounters(reference, error)) {
+            std::cerr << "COUNTER MISMATCH in history " << h << " (" << kind.first << " opponent, seed "
+                      << seed << ", " << length << " rounds): " << error << std::endl;
+            return false;
+        }
+        return true;
+    };
+
+    for (long long h = 0; h < options.histories; ++h) {
+        bool roundTrip = options.roundTripEvery > 0 && h % options.roundTripEvery == 0;
+        if (!playHistory(h, kinds[h % kinds.size()], lengthDist(lengthRng), roundTrip)) {
+            return 1;
+        }
+    }
+    // One long random history, so the round trip also covers model files big
+    // enough for the multi-threaded loader.
+    if (options.longHistoryLength > 0 &&
+        !playHistory(options.histories, kinds[0], options.longHistoryLength, options.roundTripEvery > 0)) {
+        return 1;
+    }
+
+    std::cout << "Engine '" << options.engine << "' matches the reference on "
+              << options.histories + (options.longHistoryLength > 0 ? 1 : 0) << " histories (" << totalRounds
+              << " rounds)." << std::endl;
+    std::cout << std::fixed << std::setprecision(1)
+              << "  reference: " << referenceSeconds * 1e9 / totalRounds << " ns/round" << std::endl
+              << "  candidate: " << candidateSeconds * 1e9 / totalRounds << " ns/round" << std::endl
+              << std::setprecision(2)
+              << "  speedup:   " << (candidateSeconds > 0 ? referenceSeconds / candidateSeconds : 0) << "x"
+              << std::endl;
+    return 0;
+}
+
+} // namespace bench
+
+#endif
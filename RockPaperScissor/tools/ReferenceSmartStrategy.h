@@ -0,0 +1,208 @@
+#ifndef REFERENCE_SMART_STRATEGY_H
+#define REFERENCE_SMART_STRATEGY_H
+
+#include "Strategy.h"
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Frozen copy of the original map-based SmartStrategy model, kept as the
+// baseline for benchmarks and for checking optimized engines against.
+// Prediction and update logic are unchanged from the original; the per-round
+// log is left out and the model is only read or written on request.
+class ReferenceSmartStrategy : public Strategy {
+private:
+    std::map<int, std::map<std::string, std::map<Move, int>>> frequenciesByLength;
+    std::vector<int> seqLengths = {3, 4, 5, 6, 7};
+    std::string modelPath;
+    std::mt19937 rng;
+    bool predictionValid = false;
+    Move lastPredictedHumanMove = Move::ROCK;
+
+    Move randomMove() {
+        return static_cast<Move>(std::uniform_int_distribution<int>(0, 2)(rng));
+    }
+
+    std::string movesToKey(const std::vector<std::pair<Move, Move>>& history, size_t start, int length) {
+        std::string key;
+        for (size_t i = start; i < start + length; ++i) {
+            if (i < history.size()) {
+                key += std::to_string(static_cast<int>(history[i].first));
+                key += std::to_string(static_cast<int>(history[i].second));
+            }
+        }
+        return key;
+    }
+
+    Move chooseCounterMove(Move predictedMove) {
+        switch (predictedMove) {
+            case Move::ROCK:
+                return Move::PAPER;
+            case Move::PAPER:
+                return Move::SCISSORS;
+            default:
+                return Move::ROCK;
+        }
+    }
+
+    Move aggregatePredictions(const std::vector<std::pair<Move, Move>>& history) {
+        std::map<Move, int> aggregated;
+        bool anyData = false;
+        for (int seqLen : seqLengths) {
+            if (history.size() < static_cast<size_t>(seqLen - 1)) {
+                continue;
+            }
+            size_t start = history.size() - (seqLen - 1);
+            std::string key = movesToKey(history, start, seqLen - 1);
+            auto& freqMap = frequenciesByLength[seqLen];
+            if (freqMap.find(key) == freqMap.end()) {
+                continue;
+            }
+            anyData = true;
+            for (const auto& pair : freqMap[key]) {
+                aggregated[pair.first] += pair.second;
+            }
+        }
+        if (!anyData || aggregated.empty()) {
+            predictionValid = false;
+            return randomMove();
+        }
+        predictionValid = true;
+        Move predictedMove = Move::ROCK;
+        int maxFreq = 0;
+        for (const auto& entry : aggregated) {
+            if (entry.second > maxFreq) {
+                maxFreq = entry.second;
+                predictedMove = entry.first;
+            }
+        }
+        return predictedMove;
+    }
+
+public:
+    // An empty modelPath keeps the model in memory only.
+    explicit ReferenceSmartStrategy(unsigned int seed, const std::string& modelFile = "")
+        : modelPath(modelFile), rng(seed) {
+        loadState();
+    }
+
+    Move makeMove(const std::vector<std::pair<Move, Move>>& history) override {
+        bool sufficientHistory = false;
+        for (int seqLen : seqLengths) {
+            if (history.size() >= static_cast<size_t>(seqLen - 1)) {
+                sufficientHistory = true;
+                break;
+            }
+        }
+        if (!sufficientHistory) {
+            predictionValid = false;
+            return randomMove();
+        }
+        Move predictedMove = aggregatePredictions(history);
+        lastPredictedHumanMove = predictedMove;
+        return chooseCounterMove(predictedMove);
+    }
+
+    void updateFrequencies(const std::vector<std::pair<Move, Move>>& history) override {
+        for (int seqLen : seqLengths) {
+            if (history.size() < static_cast<size_t>(seqLen)) {
+                continue;
+            }
+            size_t start = history.size() - seqLen;
+            std::string key = movesToKey(history, start, seqLen - 1);
+            frequenciesByLength[seqLen][key][history.back().first]++;
+        }
+    }
+
+    void saveState() override {
+        if (modelPath.empty()) {
+            return;
+        }
+        std::ofstream file(modelPath);
+        file << "# Legend:" << '\n' << '\n';
+        file << frequenciesByLength.size() << '\n';
+        for (const auto& lengthEntry : frequenciesByLength) {
+            file << "# Sequence length: " << lengthEntry.first << '\n';
+            file << lengthEntry.second.size() << '\n';
+            for (const auto& entry : lengthEntry.second) {
+                file << entry.first << " " << entry.second.size() << " # Key for N=" << lengthEntry.first << '\n';
+                for (const auto& moveFreq : entry.second) {
+                    file << static_cast<int>(moveFreq.first) << " " << moveFreq.second << '\n';
+                }
+            }
+        }
+    }
+
+    void loadState() override {
+        if (modelPath.empty()) {
+            return;
+        }
+        std::ifstream file(modelPath);
+        if (!file.is_open()) {
+            return;
+        }
+        frequenciesByLength.clear();
+        std::string line;
+        int numBlocks = 0;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream(line) >> numBlocks;
+            break;
+        }
+        for (int b = 0; b < numBlocks; ++b) {
+            int seqLen = 0;
+            while (std::getline(file, line)) {
+                if (!line.empty() && line[0] == '#' && line.find("Sequence length:") != std::string::npos) {
+                    std::istringstream(line.substr(line.find(":") + 1)) >> seqLen;
+                    break;
+                }
+            }
+            if (seqLen == 0) continue;
+            int numEntries = 0;
+            while (std::getline(file, line)) {
+                if (line.empty() || line[0] == '#') continue;
+                std::istringstream(line) >> numEntries;
+                break;
+            }
+            for (int i = 0; i < numEntries; ++i) {
+                std::string key;
+                int numMoves = 0;
+                while (std::getline(file, line)) {
+                    if (line.empty() || line[0] == '#') continue;
+                    std::istringstream(line) >> key >> numMoves;
+                    break;
+                }
+                for (int j = 0; j < numMoves; ++j) {
+                    int moveInt = 0, freq = 0;
+                    while (std::getline(file, line)) {
+                        if (line.empty() || line[0] == '#') continue;
+                        std::istringstream(line) >> moveInt >> freq;
+                        frequenciesByLength[seqLen][key][static_cast<Move>(moveInt)] = freq;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    std::string getName() const override {
+        return "Reference";
+    }
+
+    Move getLastPredictedHumanMove() const {
+        return lastPredictedHumanMove;
+    }
+
+    bool isPredictionValid() const {
+        return predictionValid;
+    }
+
+    const std::map<int, std::map<std::string, std::map<Move, int>>>& getTables() const {
+        return frequenciesByLength;
+    }
+};
+
+#endif
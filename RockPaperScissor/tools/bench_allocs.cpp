@@ -0,0 +1,120 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "ComputerPlayer.h"
+#include "ContextTreeStrategy.h"
+#include "RandomStrategy.h"
+#include "SmartStrategy.h"
+#include "Strategy.h"
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// allocs: heap allocations on the round path of a game under way.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+struct AllocRun {
+    long long warmupAllocations = 0;
+    long long allocations = 0;  // during the measured rounds
+    double seconds = 0;
+};
+
+// Play 'warmup' rounds and then 'rounds' measured ones through a
+// ComputerPlayer, as Game::play does, counting each phase's allocations. The
+// history is reserved up front, as Game::play does for a game of known length.
+AllocRun runAllocs(std::unique_ptr<Strategy> strategy, bench::OpponentKind kind, long long warmup,
+                   long long rounds, unsigned int seed) {
+    ComputerPlayer computer(std::move(strategy));
+    computer.reserveHistory(static_cast<std::size_t>(warmup + rounds));
+    History seen;
+    seen.reserve(static_cast<std::size_t>(warmup + rounds));
+    bench::Opponent opponent(kind, seed);
+
+    auto& stats = bench::allocStats();
+    AllocRun run;
+    long long start = stats.allocations.load();
+    bench::Timer timer;
+    for (long long round = 0; round < warmup + rounds; ++round) {
+        if (round == warmup) {
+            run.warmupAllocations = stats.allocations.load() - start;
+            start = stats.allocations.load();
+            timer = bench::Timer();
+        }
+        Move humanMove = opponent.next(seen);
+        Move computerMove = computer.makeMove();
+        computer.recordResult(humanMove, computerMove);
+        seen.emplace_back(humanMove, computerMove);
+    }
+    run.allocations = stats.allocations.load() - start;
+    run.seconds = timer.seconds();
+    return run;
+}
+
+} // namespace
+
+// Allocations per round once the model has stopped growing. Against the
+// cycling opponent every context has been seen after the warm-up, so any
+// allocation there is a failure. Against the random one new contexts keep
+// arriving; what remains is the model's own growth.
+int benchAllocs(const Options& options) {
+    const long long warmup = 20000;
+    const std::string logFile = "bench-allocs-log.txt";
+    struct Engine {
+        std::string label;
+        std::function<std::unique_ptr<Strategy>()> make;
+    };
+    const std::vector<Engine> engines = {
+        {"smart", [&] { return std::make_unique<SmartStrategy>(options.seed, "", ""); }},
+        {"smart, round log", [&] { return std::make_unique<SmartStrategy>(options.seed, "", logFile); }},
+        {"smart, adaptive", [&] {
+            auto smart = std::make_unique<SmartStrategy>(options.seed, "", "");
+            smart->setAdaptiveOrders(true);
+            return smart;
+        }},
+        {"smart, orders 8.." + std::to_string(options.longOrders), [&] {
+            auto smart = std::make_unique<SmartStrategy>(options.seed, "", "");
+            smart->setLongOrders(options.longOrders);
+            return smart;
+        }},
+        {"tree", [&] { return std::make_unique<ContextTreeStrategy>(options.seed, 3, options.maxOrder); }},
+        {"random, round log", [&] { return std::make_unique<RandomStrategy>(options.seed, logFile); }},
+    };
+
+    std::cout << "Warm-up " << warmup << " rounds, then " << options.rounds << " measured rounds, seed "
+              << options.seed << std::endl;
+    std::cout << std::left << std::setw(22) << "strategy" << std::setw(10) << "opponent" << std::right
+              << std::setw(14) << "warm-up allocs" << std::setw(10) << "allocs" << std::setw(14)
+              << "per 1k rounds" << std::setw(10) << "ns/round" << std::endl;
+    int failures = 0;
+    for (const Engine& engine : engines) {
+        for (bench::OpponentKind kind : {bench::OpponentKind::Cycle, bench::OpponentKind::Random}) {
+            bool checked = kind == bench::OpponentKind::Cycle;
+            AllocRun run = runAllocs(engine.make(), kind, warmup, options.rounds, options.seed);
+            std::cout << std::left << std::setw(22) << engine.label << std::setw(10)
+                      << (checked ? "cycle" : "random") << std::right << std::setw(14) << run.warmupAllocations
+                      << std::setw(10) << run.allocations << std::setw(14) << std::fixed << std::setprecision(2)
+                      << run.allocations * 1000.0 / options.rounds << std::setw(10) << std::setprecision(0)
+                      << run.seconds * 1e9 / options.rounds;
+            if (checked && run.allocations != 0) {
+                std::cout << "  FAIL";
+                failures++;
+            }
+            std::cout << std::endl;
+        }
+    }
+    std::filesystem::remove(logFile);
+    std::cout << "cycle: every context is known after the warm-up, so the round path must not allocate;"
+              << " random: allocations are new contexts" << std::endl;
+    return failures > 0 ? 1 : 0;
+}
+
+} // namespace bench
@@ -0,0 +1,153 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "GameAnalytics.h"
+#include "RoundScoring.h"
+#include "SmartStrategy.h"
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// analytics: game analytics, sequential vs per player vs threads.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+// Recorded games: one roundCode byte and one prediction (-1 for none) per
+// round, with every game gameRounds long.
+struct Corpus {
+    std::vector<uint8_t> codes;
+    std::vector<int8_t> predictions;
+    int gameRounds = 0;
+
+    std::size_t games() const {
+        return gameRounds > 0 ? codes.size() / static_cast<std::size_t>(gameRounds) : 0;
+    }
+};
+
+// Games of the simulated opponents, in turn, against a fresh SmartStrategy.
+Corpus recordCorpus(const Options& options) {
+    Corpus corpus;
+    corpus.gameRounds = options.gameRounds;
+    std::size_t total = static_cast<std::size_t>(options.games) * static_cast<std::size_t>(options.gameRounds);
+    corpus.codes.reserve(total);
+    corpus.predictions.reserve(total);
+    const auto& kinds = bench::opponentKinds();
+    History history;
+    for (long long game = 0; game < options.games; ++game) {
+        unsigned int seed = options.seed + static_cast<unsigned int>(game);
+        bench::Opponent opponent(kinds[static_cast<std::size_t>(game) % kinds.size()].second, seed);
+        SmartStrategy smart(seed, "", "");
+        history.clear();
+        for (int round = 0; round < options.gameRounds; ++round) {
+            Move humanMove = opponent.next(history);
+            Move computerMove = smart.makeMove(history);
+            history.emplace_back(humanMove, computerMove);
+            smart.updateFrequencies(history);
+            corpus.codes.push_back(static_cast<uint8_t>(roundCode(humanMove, computerMove)));
+            corpus.predictions.push_back(static_cast<int8_t>(
+                smart.isPredictionValid() ? static_cast<int>(smart.getLastPredictedHumanMove()) : -1));
+        }
+    }
+    return corpus;
+}
+
+// Feed games [first, last) of the corpus to 'analytics', one endGame() each.
+void analyseGames(const Corpus& corpus, std::size_t first, std::size_t last, GameAnalytics& analytics) {
+    for (std::size_t game = first; game < last; ++game) {
+        std::size_t begin = game * static_cast<std::size_t>(corpus.gameRounds);
+        for (std::size_t i = begin; i < begin + static_cast<std::size_t>(corpus.gameRounds); ++i) {
+            analytics.observe(static_cast<Move>(corpus.codes[i] / 3), static_cast<Move>(corpus.codes[i] % 3),
+                              corpus.predictions[i]);
+        }
+        analytics.endGame();
+    }
+}
+
+std::string reportText(const GameAnalytics& analytics) {
+    std::ostringstream text;
+    analytics.report(text);
+    return text.str();
+}
+
+} // namespace
+
+// One pass of GameAnalytics over a recorded corpus: sequentially, per
+// player, and split across threads and merged. All three must agree.
+int benchAnalytics(const Options& options) {
+    Corpus corpus = recordCorpus(options);
+    const std::size_t games = corpus.games();
+    const double rounds = static_cast<double>(corpus.codes.size());
+    std::cout << games << " games of " << corpus.gameRounds << " rounds, " << options.players
+              << " players, window " << options.window << std::endl;
+
+    GameAnalytics sequential(options.window);
+    bench::Timer sequentialTimer;
+    analyseGames(corpus, 0, games, sequential);
+    double sequentialSeconds = sequentialTimer.seconds();
+
+    // Game g belongs to player g % players.
+    std::vector<GameAnalytics> players(static_cast<std::size_t>(options.players), GameAnalytics(options.window));
+    bench::Timer playerTimer;
+    for (std::size_t game = 0; game < games; ++game) {
+        analyseGames(corpus, game, game + 1, players[game % players.size()]);
+    }
+    GameAnalytics byPlayer(options.window);
+    std::size_t playerBytes = 0;
+    for (const GameAnalytics& player : players) {
+        byPlayer.merge(player);
+        playerBytes += player.memoryUsage();
+    }
+    double playerSeconds = playerTimer.seconds();
+
+    unsigned int threads = std::max(4u, std::thread::hardware_concurrency());
+    std::vector<GameAnalytics> partials(threads, GameAnalytics(options.window));
+    bench::Timer parallelTimer;
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            analyseGames(corpus, games * t / threads, games * (t + 1) / threads, partials[t]);
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    GameAnalytics parallel(options.window);
+    for (const GameAnalytics& partial : partials) {
+        parallel.merge(partial);
+    }
+    double parallelSeconds = parallelTimer.seconds();
+
+    std::cout << std::left << std::setw(22) << "pass" << std::right << std::setw(10) << "ms"
+              << std::setw(12) << "ns/round" << std::endl;
+    auto row = [&](const std::string& pass, double seconds) {
+        std::cout << std::left << std::setw(22) << pass << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << seconds * 1000 << std::setw(12) << seconds * 1e9 / rounds << std::endl;
+    };
+    row("sequential", sequentialSeconds);
+    row("per player + merge", playerSeconds);
+    row(std::to_string(threads) + " threads + merge", parallelSeconds);
+    std::cout << "Memory per player: " << playerBytes / players.size() << " bytes" << std::endl;
+    std::cout << '\n';
+    sequential.report(std::cout);
+
+    const std::string expected = reportText(sequential);
+    RoundTally tally = RoundScoring::score(corpus.codes.data(), corpus.codes.size());
+    bool countsMatch = tally.humanWins == sequential.getOutcomeCount(GameAnalytics::Outcome::HumanWin) &&
+                       tally.computerWins == sequential.getOutcomeCount(GameAnalytics::Outcome::ComputerWin) &&
+                       tally.ties == sequential.getOutcomeCount(GameAnalytics::Outcome::Tie);
+    if (reportText(byPlayer) != expected || reportText(parallel) != expected || !countsMatch) {
+        std::cerr << "merged analytics differ from the sequential pass" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace bench
@@ -0,0 +1,205 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "ComputerPlayer.h"
+#include "ContextTreeStrategy.h"
+#include "LongestMatchStrategy.h"
+#include "rps_core.h"
+#include "SmartStrategy.h"
+#include "Strategy.h"
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// core: the rps_core C ABI, one call per round vs batched calls, against the
+// strategies called directly.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+bool sameRound(const rps_round& a, const rps_round& b) {
+    return a.computer_move == b.computer_move && a.outcome == b.outcome &&
+           a.predicted_move == b.predicted_move && a.status == b.status;
+}
+
+// Human moves, round-major (moves[round * sessions + session]). Session i
+// plays an opponent that ignores the computer's moves, so every calling
+// pattern below replays exactly the same games.
+std::vector<int32_t> recordSessionMoves(std::size_t sessions, std::size_t rounds, unsigned int seed) {
+    static const bench::OpponentKind kinds[] = {bench::OpponentKind::Random, bench::OpponentKind::Cycle,
+                                                bench::OpponentKind::Markov, bench::OpponentKind::Lag};
+    std::vector<int32_t> moves(sessions * rounds);
+    std::vector<std::pair<Move, Move>> history;
+    for (std::size_t session = 0; session < sessions; ++session) {
+        bench::Opponent opponent(kinds[session % 4], seed + static_cast<unsigned int>(session));
+        history.clear();
+        for (std::size_t round = 0; round < rounds; ++round) {
+            Move move = opponent.next(history);
+            history.emplace_back(move, Move::ROCK);
+            moves[round * sessions + session] = static_cast<int32_t>(move);
+        }
+    }
+    return moves;
+}
+
+std::unique_ptr<Strategy> makeCoreReference(const std::string& engine, unsigned int seed, int maxOrder) {
+    if (engine == "tree") {
+        return std::make_unique<ContextTreeStrategy>(seed, 3, maxOrder);
+    }
+    if (engine == "match") {
+        return std::make_unique<LongestMatchStrategy>(seed);
+    }
+    return std::make_unique<SmartStrategy>(seed, "", "");
+}
+
+} // namespace
+
+int benchCore(const Options& options, const std::string& engine) {
+    if (engine != "smart" && engine != "tree" && engine != "match") {
+        std::cerr << "--engine must be smart, tree or match" << std::endl;
+        return 1;
+    }
+    const std::size_t sessions = static_cast<std::size_t>(options.players);
+    const std::size_t rounds = static_cast<std::size_t>(options.sessionRounds);
+    const double total = static_cast<double>(sessions * rounds);
+    std::cout << "rps_core ABI " << rps_core_abi_version() << ": " << sessions << " " << engine
+              << " sessions x " << rounds << " rounds" << std::endl;
+
+    std::vector<int32_t> moves = recordSessionMoves(sessions, rounds, options.seed);
+
+    rps_session_config config;
+    rps_session_config_init(&config);
+    config.strategy = engine == "tree" ? RPS_STRATEGY_TREE : (engine == "match" ? RPS_STRATEGY_MATCH : RPS_STRATEGY_SMART);
+    config.seed = options.seed;
+    config.max_order = options.maxOrder;
+
+    // Runs 'play' on freshly created sessions and returns its time.
+    auto run = [&](const std::function<int32_t(std::vector<rps_session*>&)>& play, int32_t& status) {
+        std::vector<rps_session*> handles(sessions);
+        status = rps_sessions_create(&config, sessions, handles.data());
+        if (status != RPS_OK) {
+            return 0.0;
+        }
+        bench::Timer timer;
+        status = play(handles);
+        double seconds = timer.seconds();
+        rps_sessions_destroy(handles.data(), sessions);
+        return seconds;
+    };
+
+    // Direct C++ calls, as rps_console makes them.
+    std::vector<rps_round> direct(sessions * rounds);
+    double directSeconds = 0;
+    {
+        std::vector<std::unique_ptr<Strategy>> strategies;
+        std::vector<std::vector<std::pair<Move, Move>>> histories(sessions);
+        for (std::size_t session = 0; session < sessions; ++session) {
+            strategies.push_back(makeCoreReference(engine, options.seed + static_cast<unsigned int>(session), options.maxOrder));
+        }
+        bench::Timer timer;
+        for (std::size_t round = 0; round < rounds; ++round) {
+            for (std::size_t session = 0; session < sessions; ++session) {
+                Strategy& strategy = *strategies[session];
+                auto& history = histories[session];
+                Move computerMove = strategy.makeMove(history);
+                Move predicted;
+                bool valid = strategyPrediction(strategy, predicted);
+                Move humanMove = static_cast<Move>(moves[round * sessions + session]);
+                history.emplace_back(humanMove, computerMove);
+                strategy.updateFrequencies(history);
+                direct[round * sessions + session] = {static_cast<int32_t>(computerMove),
+                                                      determineWinner(humanMove, computerMove),
+                                                      valid ? static_cast<int32_t>(predicted) : -1, RPS_OK};
+            }
+        }
+        directSeconds = timer.seconds();
+    }
+
+    // One rps_session_step per round.
+    std::vector<rps_round> single(sessions * rounds);
+    int32_t singleStatus = RPS_OK;
+    double singleSeconds = run([&](std::vector<rps_session*>& handles) {
+        for (std::size_t round = 0; round < rounds; ++round) {
+            for (std::size_t session = 0; session < sessions; ++session) {
+                std::size_t i = round * sessions + session;
+                int32_t status = rps_session_step(handles[session], moves[i], &single[i]);
+                if (status != RPS_OK) {
+                    return status;
+                }
+            }
+        }
+        return static_cast<int32_t>(RPS_OK);
+    }, singleStatus);
+
+    // One rps_sessions_step per round, across every session.
+    std::vector<rps_round> across(sessions * rounds);
+    int32_t acrossStatus = RPS_OK;
+    double acrossSeconds = run([&](std::vector<rps_session*>& handles) {
+        for (std::size_t round = 0; round < rounds; ++round) {
+            int32_t status = rps_sessions_step(handles.data(), &moves[round * sessions], sessions, &across[round * sessions]);
+            if (status != RPS_OK) {
+                return status;
+            }
+        }
+        return static_cast<int32_t>(RPS_OK);
+    }, acrossStatus);
+
+    // One rps_session_step_many per session, for all of its rounds.
+    std::vector<int32_t> sessionMajor(sessions * rounds);
+    for (std::size_t session = 0; session < sessions; ++session) {
+        for (std::size_t round = 0; round < rounds; ++round) {
+            sessionMajor[session * rounds + round] = moves[round * sessions + session];
+        }
+    }
+    std::vector<rps_round> many(sessions * rounds);
+    int32_t manyStatus = RPS_OK;
+    double manySeconds = run([&](std::vector<rps_session*>& handles) {
+        for (std::size_t session = 0; session < sessions; ++session) {
+            int32_t status = rps_session_step_many(handles[session], &sessionMajor[session * rounds], rounds,
+                                                   &many[session * rounds]);
+            if (status != RPS_OK) {
+                return status;
+            }
+        }
+        return static_cast<int32_t>(RPS_OK);
+    }, manyStatus);
+
+    for (int32_t status : {singleStatus, acrossStatus, manyStatus}) {
+        if (status != RPS_OK) {
+            std::cerr << "rps_core call failed: " << rps_status_string(status) << std::endl;
+            return 1;
+        }
+    }
+
+    auto row = [&](const char* name, double seconds, std::size_t calls) {
+        std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << seconds * 1e9 / total << " ns/round" << std::setw(12) << calls << " calls"
+                  << std::setw(12) << std::setprecision(2) << total / seconds / 1e6 << " M rounds/s" << std::endl;
+    };
+    row("direct C++", directSeconds, 0);
+    row("rps_session_step", singleSeconds, sessions * rounds);
+    row("rps_sessions_step", acrossSeconds, rounds);
+    row("rps_session_step_many", manySeconds, sessions);
+
+    for (std::size_t session = 0; session < sessions; ++session) {
+        for (std::size_t round = 0; round < rounds; ++round) {
+            std::size_t i = round * sessions + session;
+            if (!sameRound(direct[i], single[i]) || !sameRound(direct[i], across[i]) ||
+                !sameRound(direct[i], many[session * rounds + round])) {
+                std::cerr << "session " << session << " round " << round << " differs between calling patterns"
+                          << std::endl;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+} // namespace bench
@@ -0,0 +1,251 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "ComputerPlayer.h"
+#include "GameScheduler.h"
+#include "RandomStrategy.h"
+#include "Strategy.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// coroutines: many games on one thread with GameScheduler vs a thread per game.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+// The simulated human's move in a round of a game. It ignores the computer's
+// moves, so every runner below plays exactly the same games.
+Move simulatedMove(unsigned int seed, std::size_t game, std::size_t round) {
+    uint64_t x = (static_cast<uint64_t>(seed) << 48) ^ (static_cast<uint64_t>(game) << 24) ^ round;
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return static_cast<Move>((x ^ (x >> 31)) % 3);
+}
+
+struct GameScore {
+    int humanWins = 0;
+    int computerWins = 0;
+    int ties = 0;
+
+    void add(int result) {
+        if (result > 0) {
+            humanWins++;
+        } else if (result < 0) {
+            computerWins++;
+        } else {
+            ties++;
+        }
+    }
+
+    bool operator==(const GameScore& other) const {
+        return humanWins == other.humanWins && computerWins == other.computerWins && ties == other.ties;
+    }
+};
+
+// The random strategy keeps the per-round work small, so the runners differ
+// mostly in what it costs to wait for and resume a game.
+std::unique_ptr<Strategy> makeGameStrategy(unsigned int seed, std::size_t game) {
+    return std::make_unique<RandomStrategy>(seed + static_cast<unsigned int>(game), "");
+}
+
+// One thread per game, fed one move at a time through a one-slot mailbox.
+struct ThreadGame {
+    std::mutex mutex;
+    std::condition_variable changed;
+    int slot = -1;  // the next move, -1 while empty
+    GameScore score;
+};
+
+void playThreadGame(ThreadGame& game, std::unique_ptr<Strategy> strategy, std::size_t rounds) {
+    ComputerPlayer computer(std::move(strategy));
+    for (std::size_t round = 0; round < rounds; ++round) {
+        std::unique_lock<std::mutex> lock(game.mutex);
+        game.changed.wait(lock, [&] { return game.slot >= 0; });
+        Move humanMove = static_cast<Move>(game.slot);
+        game.slot = -1;
+        lock.unlock();
+        game.changed.notify_one();
+        Move computerMove = computer.makeMove();
+        game.score.add(determineWinner(humanMove, computerMove));
+        computer.recordResult(humanMove, computerMove);
+    }
+}
+
+} // namespace
+
+int benchCoroutines(const Options& options) {
+    const std::size_t games = static_cast<std::size_t>(options.games);
+    const std::size_t rounds = static_cast<std::size_t>(options.gameRounds);
+    const std::size_t threadGames = std::min<std::size_t>(games, 1000);
+    auto& stats = bench::allocStats();
+    std::cout << games << " games of " << rounds << " rounds (random strategy), " << threadGames
+              << " of them also with a thread per game" << std::endl;
+
+    // Direct calls, round by round across the games, with no waiting at all.
+    std::vector<GameScore> direct(games);
+    double directSeconds = 0;
+    {
+        std::vector<std::unique_ptr<ComputerPlayer>> players;
+        for (std::size_t game = 0; game < games; ++game) {
+            players.push_back(std::make_unique<ComputerPlayer>(makeGameStrategy(options.seed, game)));
+        }
+        bench::Timer timer;
+        for (std::size_t round = 0; round < rounds; ++round) {
+            for (std::size_t game = 0; game < games; ++game) {
+                Move humanMove = simulatedMove(options.seed, game, round);
+                Move computerMove = players[game]->makeMove();
+                direct[game].add(determineWinner(humanMove, computerMove));
+                players[game]->recordResult(humanMove, computerMove);
+            }
+        }
+        directSeconds = timer.seconds();
+    }
+
+    auto scoresOf = [&](const GameScheduler& scheduler) {
+        std::vector<GameScore> scores(scheduler.gameCount());
+        for (std::size_t game = 0; game < scores.size(); ++game) {
+            const GameScheduler::GameState& state = scheduler.game(game);
+            scores[game] = {state.humanScore, state.computerScore, state.ties};
+        }
+        return scores;
+    };
+
+    // Coroutines, moves delivered on the scheduler's thread.
+    std::vector<GameScore> delivered;
+    double deliverSeconds = 0;
+    double heapPerGame = 0;
+    double framePerGame = 0;
+    double releasedPerGame = 0;  // heap still held per game once all are released
+    bool releasedAll = true;
+    {
+        long long heapBefore = stats.liveBytes.load();
+        GameScheduler scheduler;
+        for (std::size_t game = 0; game < games; ++game) {
+            scheduler.spawn(makeGameStrategy(options.seed, game), static_cast<int>(rounds));
+        }
+        scheduler.runReady();  // every game is now suspended waiting for a move
+        heapPerGame = static_cast<double>(stats.liveBytes.load() - heapBefore) / games;
+        framePerGame = static_cast<double>(GameTask::frameBytes().load()) / games;
+        bench::Timer timer;
+        for (std::size_t round = 0; round < rounds; ++round) {
+            for (std::size_t game = 0; game < games; ++game) {
+                scheduler.deliver(game, simulatedMove(options.seed, game, round));
+            }
+            scheduler.runReady();
+        }
+        deliverSeconds = timer.seconds();
+        delivered = scoresOf(scheduler);
+        for (std::size_t game = 0; game < games; ++game) {
+            releasedAll = scheduler.release(game) && releasedAll;
+        }
+        releasedAll = releasedAll && scheduler.getHeldGames() == 0;
+        releasedPerGame = static_cast<double>(stats.liveBytes.load() - heapBefore) / games;
+    }
+
+    // Coroutines, moves posted from a producer thread a round at a time; it
+    // stays at most one round ahead of the games.
+    std::vector<GameScore> posted;
+    double postSeconds = 0;
+    {
+        GameScheduler scheduler;
+        for (std::size_t game = 0; game < games; ++game) {
+            scheduler.spawn(makeGameStrategy(options.seed, game), static_cast<int>(rounds));
+        }
+        bench::Timer timer;
+        std::thread producer([&] {
+            std::vector<std::pair<GameScheduler::GameId, Move>> batch(games);
+            for (std::size_t round = 0; round < rounds; ++round) {
+                while (scheduler.getRoundsPlayed() + static_cast<long long>(games) < static_cast<long long>(round * games)) {
+                    std::this_thread::yield();
+                }
+                for (std::size_t game = 0; game < games; ++game) {
+                    batch[game] = {game, simulatedMove(options.seed, game, round)};
+                }
+                scheduler.post(batch);
+            }
+        });
+        scheduler.run();
+        producer.join();
+        postSeconds = timer.seconds();
+        posted = scoresOf(scheduler);
+    }
+
+    // A thread per game, each blocked on its mailbox between rounds.
+    std::vector<GameScore> threaded(threadGames);
+    double threadSeconds = 0;
+    double rssPerThread = 0;
+    {
+        std::vector<std::unique_ptr<ThreadGame>> mailboxes;
+        std::vector<std::thread> threads;
+        long long rssBefore = bench::currentRssBytes();
+        for (std::size_t game = 0; game < threadGames; ++game) {
+            mailboxes.push_back(std::make_unique<ThreadGame>());
+            threads.emplace_back(playThreadGame, std::ref(*mailboxes.back()), makeGameStrategy(options.seed, game), rounds);
+        }
+        rssPerThread = static_cast<double>(bench::currentRssBytes() - rssBefore) / threadGames;
+        bench::Timer timer;
+        for (std::size_t round = 0; round < rounds; ++round) {
+            for (std::size_t game = 0; game < threadGames; ++game) {
+                ThreadGame& mailbox = *mailboxes[game];
+                std::unique_lock<std::mutex> lock(mailbox.mutex);
+                mailbox.changed.wait(lock, [&] { return mailbox.slot < 0; });
+                mailbox.slot = static_cast<int>(simulatedMove(options.seed, game, round));
+                lock.unlock();
+                mailbox.changed.notify_one();
+            }
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        threadSeconds = timer.seconds();
+        for (std::size_t game = 0; game < threadGames; ++game) {
+            threaded[game] = mailboxes[game]->score;
+        }
+    }
+
+    const double total = static_cast<double>(games * rounds);
+    auto row = [](const char* name, double nsPerRound, const std::string& memory) {
+        std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << nsPerRound << " ns/round   " << memory << std::endl;
+    };
+    row("direct calls", directSeconds * 1e9 / total, "");
+    row("coroutines, deliver()", deliverSeconds * 1e9 / total,
+        std::to_string(static_cast<long long>(heapPerGame)) + " heap bytes per waiting game (" +
+            std::to_string(static_cast<long long>(framePerGame)) + " frame), " +
+            std::to_string(static_cast<long long>(releasedPerGame)) + " once released");
+    row("coroutines, post() thread", postSeconds * 1e9 / total, "");
+    row("thread per game", threadSeconds * 1e9 / static_cast<double>(threadGames * rounds),
+        rssPerThread >= 0 ? std::to_string(static_cast<long long>(rssPerThread)) + " RSS bytes per waiting thread"
+                          : std::string());
+    std::cout << "suspend/resume per round: coroutine " << std::setprecision(1)
+              << (deliverSeconds - directSeconds) * 1e9 / total << " ns, thread "
+              << threadSeconds * 1e9 / static_cast<double>(threadGames * rounds) - directSeconds * 1e9 / total
+              << " ns" << std::endl;
+
+    if (!releasedAll) {
+        std::cerr << "finished games could not all be released" << std::endl;
+        return 1;
+    }
+    for (std::size_t game = 0; game < games; ++game) {
+        if (!(delivered[game] == direct[game]) || !(posted[game] == direct[game]) ||
+            (game < threadGames && !(threaded[game] == direct[game]))) {
+            std::cerr << "game " << game << " ended differently between runners" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+} // namespace bench
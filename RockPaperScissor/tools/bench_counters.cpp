@@ -0,0 +1,170 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "ReferenceSmartStrategy.h"
+#include "SmartStrategy.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// counters: accuracy vs memory and file size of 8-, 16- and 32-bit counters.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+struct CounterReplay {
+    long long predictions = 0;   // rounds with a prediction
+    long long correct = 0;       // predictions that named the human move
+    std::vector<int> predicted;  // per round: predicted move, or -1
+    std::size_t contexts = 0;
+    std::size_t memoryBytes = 0;
+    std::size_t textBytes = 0;
+    std::size_t compactBytes = 0;
+};
+
+// Replay a game through SmartStrategy's prediction rule (orders 3..7, counts
+// summed across orders, ties to the lowest move) on a model with the given
+// counter width, then write the model in both file formats.
+template <typename Model>
+CounterReplay replayCounters(const History& game, const std::string& scratchFile) {
+    static const int seqLengths[] = {3, 4, 5, 6, 7};
+    Model model;
+    CounterReplay replay;
+    replay.predicted.reserve(game.size());
+    History history;
+    history.reserve(game.size());
+    for (const auto& round : game) {
+        int64_t aggregated[3] = {0, 0, 0};
+        int mask = 0;
+        for (int seqLen : seqLengths) {
+            if (history.size() < static_cast<size_t>(seqLen - 1)) continue;
+            uint64_t key = Model::makeKey(history, history.size() - (seqLen - 1), seqLen - 1);
+            if (const typename Model::Context* context = model.find(seqLen, key)) {
+                for (int m = 0; m < 3; ++m) aggregated[m] += context->counts[m];
+                mask |= context->mask;
+            }
+        }
+        int prediction = -1;
+        if (mask != 0) {
+            int64_t maxFreq = 0;
+            prediction = 0;
+            for (int m = 0; m < 3; ++m) {
+                if ((mask & (1 << m)) && aggregated[m] > maxFreq) {
+                    maxFreq = aggregated[m];
+                    prediction = m;
+                }
+            }
+            replay.predictions++;
+            if (prediction == static_cast<int>(round.first)) replay.correct++;
+        }
+        replay.predicted.push_back(prediction);
+
+        history.push_back(round);
+        for (int seqLen : seqLengths) {
+            if (history.size() < static_cast<size_t>(seqLen)) continue;
+            uint64_t key = Model::makeKey(history, history.size() - seqLen, seqLen - 1);
+            model.increment(seqLen, key, round.first);
+        }
+    }
+    for (int seqLen : seqLengths) {
+        replay.contexts += model.contextCount(seqLen);
+    }
+    replay.memoryBytes = model.memoryUsage();
+    FrequencyFileWriter::write(model, scratchFile, ModelFileFormat::Text);
+    replay.textBytes = static_cast<std::size_t>(std::filesystem::file_size(scratchFile));
+    FrequencyFileWriter::write(model, scratchFile, ModelFileFormat::Compact);
+    replay.compactBytes = static_cast<std::size_t>(std::filesystem::file_size(scratchFile));
+    std::remove(scratchFile.c_str());
+    return replay;
+}
+
+// Heap held by the original std::map model after the same game.
+long long referenceModelBytes(const History& game) {
+    auto& stats = bench::allocStats();
+    long long before = stats.liveBytes.load();
+    ReferenceSmartStrategy reference(0, "");
+    History history;
+    history.reserve(game.size());
+    for (const auto& round : game) {
+        history.push_back(round);
+        reference.updateFrequencies(history);
+    }
+    return stats.liveBytes.load() - before - static_cast<long long>(history.capacity() * sizeof(history[0]));
+}
+
+void printCounterRow(const std::string& game, const std::string& counters, const std::string& contextBytes,
+                     double heapPerContext, double textPerContext, const std::string& compactPerContext,
+                     const std::string& accuracy, const std::string& agreement) {
+    std::cout << std::left << std::setw(10) << game << std::setw(10) << counters << std::right
+              << std::setw(9) << contextBytes
+              << std::setw(10) << std::fixed << std::setprecision(1) << heapPerContext
+              << std::setw(10) << textPerContext
+              << std::setw(10) << compactPerContext
+              << std::setw(8) << accuracy
+              << std::setw(8) << agreement << std::endl;
+}
+
+} // namespace
+
+// Accuracy against memory and file size for 8-, 16- and 32-bit counters, on
+// games recorded from the simulated opponents (and the script, if given).
+// agree% is how often a width predicts the same move as 32-bit counters.
+int benchCounters(const Options& options) {
+    std::vector<RecordedGame> games;
+    for (const auto& entry : bench::opponentKinds()) {
+        bench::Opponent opponent(entry.second, options.seed);
+        games.push_back({entry.first, recordGame(options, [&opponent](const History& history) {
+            return opponent.next(history);
+        }, options.rounds)});
+    }
+    if (!options.scriptPath.empty()) {
+        std::vector<Move> moves;
+        if (!readScriptMoves(options.scriptPath, moves)) {
+            std::cerr << "Failed to open script " << options.scriptPath << std::endl;
+            return 1;
+        }
+        games.push_back({"script", recordGame(options, [&moves](const History& history) {
+            return moves[history.size()];
+        }, static_cast<long long>(moves.size()))});
+    }
+
+    std::cout << "Rounds per simulated game: " << options.rounds << ", seed " << options.seed << std::endl;
+    std::cout << "Per context: struct bytes, model heap bytes, text and compact file bytes" << std::endl;
+    std::cout << std::left << std::setw(10) << "game" << std::setw(10) << "counters" << std::right
+              << std::setw(9) << "struct" << std::setw(10) << "heap" << std::setw(10) << "text"
+              << std::setw(10) << "compact" << std::setw(8) << "acc%" << std::setw(8) << "agree%" << std::endl;
+    const std::string scratch = "rps_bench_counters.tmp";
+    for (const RecordedGame& game : games) {
+        CounterReplay wide = replayCounters<FrequencyModel32>(game.history, scratch);
+        double contexts = static_cast<double>(std::max<std::size_t>(wide.contexts, 1));
+        printCounterRow(game.name, "std::map", "-", referenceModelBytes(game.history) / contexts,
+                        wide.textBytes / contexts, "-", "-", "-");
+
+        auto report = [&](const std::string& label, std::size_t contextBytes, const CounterReplay& replay) {
+            long long agreeing = 0;
+            for (std::size_t i = 0; i < replay.predicted.size(); ++i) {
+                if (replay.predicted[i] == wide.predicted[i]) agreeing++;
+            }
+            std::ostringstream compact;
+            compact << std::fixed << std::setprecision(1) << replay.compactBytes / contexts;
+            printCounterRow(game.name, label, std::to_string(contextBytes), replay.memoryBytes / contexts,
+                            replay.textBytes / contexts, compact.str(),
+                            percent(replay.correct, replay.predictions),
+                            percent(agreeing, static_cast<long long>(replay.predicted.size())));
+        };
+        report("int32", sizeof(FrequencyModel32::Context), wide);
+        report("uint16", sizeof(FrequencyModel::Context), replayCounters<FrequencyModel>(game.history, scratch));
+        report("uint8", sizeof(FrequencyModel8::Context), replayCounters<FrequencyModel8>(game.history, scratch));
+    }
+    return 0;
+}
+
+} // namespace bench
@@ -0,0 +1,168 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "ReferenceSmartStrategy.h"
+#include "SmartStrategy.h"
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// model: allocations, heap and RSS of the map-based vs the arena model.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+struct ModelCost {
+    double seconds = 0;
+    long long allocations = 0;
+    long long liveBytes = 0;
+    long long rssBytes = 0;
+    bool rssKnown = false;
+};
+
+struct ModelReport {
+    ModelCost build;
+    ModelCost load;
+    ModelCost teardown;
+};
+
+// Run fn() and record its time, allocation count and heap/RSS growth.
+template <typename Fn>
+ModelCost measure(Fn fn) {
+    auto& stats = bench::allocStats();
+    ModelCost cost;
+    long long rssBefore = bench::currentRssBytes();
+    long long allocsBefore = stats.allocations.load();
+    long long bytesBefore = stats.liveBytes.load();
+    bench::Timer timer;
+    fn();
+    cost.seconds = timer.seconds();
+    cost.allocations = stats.allocations.load() - allocsBefore;
+    cost.liveBytes = stats.liveBytes.load() - bytesBefore;
+    cost.rssKnown = rssBefore >= 0;
+    cost.rssBytes = cost.rssKnown ? bench::currentRssBytes() - rssBefore : 0;
+    return cost;
+}
+
+// Either build a model by play, or load one from 'modelFile' and tear it
+// down. StrategyT(seed, path) must load the file when path is non-empty.
+template <typename StrategyT>
+ModelReport profileModel(const Options& options, const std::string& modelFile, bool loadPhase) {
+    ModelReport report;
+    if (loadPhase) {
+        std::unique_ptr<StrategyT> loaded;
+        report.load = measure([&] { loaded = std::make_unique<StrategyT>(options.seed, modelFile); });
+        report.teardown = measure([&] { loaded.reset(); });
+        return report;
+    }
+
+    std::vector<std::pair<Move, Move>> history;
+    history.reserve(static_cast<size_t>(options.rounds));
+    bench::Opponent opponent(bench::OpponentKind::Random, options.seed);
+    std::vector<Move> humanMoves;
+    for (long long round = 0; round < options.rounds; ++round) {
+        humanMoves.push_back(opponent.next(history));
+    }
+
+    std::unique_ptr<StrategyT> built;
+    report.build = measure([&] {
+        built = std::make_unique<StrategyT>(options.seed, "");
+        for (Move humanMove : humanMoves) {
+            Move computerMove = built->makeMove(history);
+            history.emplace_back(humanMove, computerMove);
+            built->updateFrequencies(history);
+        }
+    });
+    return report;
+}
+
+// Run profileModel in a child process where possible, so each layout and
+// phase starts from a fresh heap and the RSS numbers are not polluted by
+// earlier runs.
+template <typename StrategyT>
+ModelReport profileModelIsolated(const Options& options, const std::string& modelFile, bool loadPhase) {
+#ifdef RPS_BENCH_HAS_FORK
+    int fds[2];
+    if (pipe(fds) == 0) {
+        pid_t child = fork();
+        if (child == 0) {
+            close(fds[0]);
+            ModelReport report = profileModel<StrategyT>(options, modelFile, loadPhase);
+            ssize_t written = write(fds[1], &report, sizeof(report));
+            _exit(written == static_cast<ssize_t>(sizeof(report)) ? 0 : 1);
+        }
+        close(fds[1]);
+        ModelReport report;
+        ssize_t got = read(fds[0], &report, sizeof(report));
+        close(fds[0]);
+        int status = 0;
+        waitpid(child, &status, 0);
+        if (got == static_cast<ssize_t>(sizeof(report))) {
+            return report;
+        }
+    }
+#endif
+    return profileModel<StrategyT>(options, modelFile, loadPhase);
+}
+
+// SmartStrategy in the (seed, modelPath) shape profileModel expects.
+class ArenaSmartStrategy : public SmartStrategy {
+public:
+    ArenaSmartStrategy(unsigned int seed, const std::string& modelFile) : SmartStrategy(seed, modelFile, "") {}
+};
+
+// Write a model played against a random opponent to 'modelFile'.
+void writeModelFile(const Options& options, const std::string& modelFile) {
+    SmartStrategy writer(options.seed, "", "");
+    std::vector<std::pair<Move, Move>> history;
+    bench::Opponent opponent(bench::OpponentKind::Random, options.seed);
+    for (long long round = 0; round < options.rounds; ++round) {
+        Move humanMove = opponent.next(history);
+        history.emplace_back(humanMove, writer.makeMove(history));
+        writer.updateFrequencies(history);
+    }
+    writer.saveModel(modelFile);
+}
+
+void printCost(const std::string& layout, const std::string& phase, const ModelCost& cost) {
+    std::cout << std::left << std::setw(11) << layout << std::setw(10) << phase << std::right
+              << std::setw(11) << std::fixed << std::setprecision(2) << cost.seconds * 1000
+              << std::setw(12) << cost.allocations
+              << std::setw(12) << cost.liveBytes / 1024
+              << std::setw(12) << (cost.rssKnown ? std::to_string(cost.rssBytes / 1024) : "n/a") << std::endl;
+}
+
+} // namespace
+
+// Allocation count, heap and RSS of the original map-of-maps model against
+// the arena-backed FrequencyModel, for building, loading and tearing down.
+int benchModel(const Options& options) {
+    const std::string modelFile = "rps_bench_model.txt";
+    // Produce a freq.txt-format file with the current writer. This also runs
+    // in a child so the parent heap stays small for the measurements.
+    runIsolated([&] { writeModelFile(options, modelFile); });
+
+
+    std::cout << "Random opponent, " << options.rounds << " rounds" << std::endl;
+    std::cout << std::left << std::setw(11) << "layout" << std::setw(10) << "phase" << std::right
+              << std::setw(11) << "ms" << std::setw(12) << "allocs"
+              << std::setw(12) << "heap KiB" << std::setw(12) << "RSS KiB" << std::endl;
+    printCost("std::map", "build", profileModelIsolated<ReferenceSmartStrategy>(options, modelFile, false).build);
+    printCost("arena", "build", profileModelIsolated<ArenaSmartStrategy>(options, modelFile, false).build);
+    ModelReport maps = profileModelIsolated<ReferenceSmartStrategy>(options, modelFile, true);
+    ModelReport arena = profileModelIsolated<ArenaSmartStrategy>(options, modelFile, true);
+    printCost("std::map", "load", maps.load);
+    printCost("arena", "load", arena.load);
+    printCost("std::map", "teardown", maps.teardown);
+    printCost("arena", "teardown", arena.teardown);
+    std::remove(modelFile.c_str());
+    return 0;
+}
+
+} // namespace bench
@@ -0,0 +1,131 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "SmartStrategy.h"
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// predict: SmartStrategy's prediction cache against recomputing every move.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+struct PredictRun {
+    double moveSeconds = 0;    // in makeMove
+    double updateSeconds = 0;  // in updateFrequencies
+    long long computerWins = 0;
+    std::vector<Move> moves;
+    std::vector<Move> predictions;
+    PredictionCache::Stats cache;
+    long long staleBest = 0;  // contexts whose cached best move is not their argmax
+};
+
+// Recomputed argmax of one context, as the strategy did before contexts
+// cached it.
+template <typename Context>
+Move recomputedBestMove(const Context& context) {
+    Move best = Move::ROCK;
+    long long maxFreq = 0;
+    for (int m = 0; m < 3; ++m) {
+        if ((context.mask & (1 << m)) && context.counts[m] > maxFreq) {
+            maxFreq = context.counts[m];
+            best = static_cast<Move>(m);
+        }
+    }
+    return best;
+}
+
+template <typename Model>
+long long countStaleBest(const Model& model) {
+    long long stale = 0;
+    for (int seqLen : model.seqLengths()) {
+        model.forEachContext(seqLen, [&stale](const typename Model::Context& context) {
+            stale += context.bestMove() != recomputedBestMove(context);
+        });
+    }
+    return stale;
+}
+
+// Play one opponent against the smart strategy with or without its
+// prediction cache, timing makeMove and updateFrequencies apart. The same
+// contexts are also counted in an 8-bit model, whose counters halve often,
+// to check the best moves kept across halving.
+PredictRun runPredict(bench::OpponentKind kind, const Options& options, bool cached) {
+    SmartStrategy smart(options.seed, "", "");
+    smart.setPredictionCache(cached);
+    FrequencyModel8 narrow;
+    std::vector<std::pair<Move, Move>> history;
+    history.reserve(static_cast<size_t>(options.rounds));
+    bench::Opponent opponent(kind, options.seed);
+
+    PredictRun run;
+    run.moves.reserve(static_cast<size_t>(options.rounds));
+    run.predictions.reserve(static_cast<size_t>(options.rounds));
+    for (long long round = 0; round < options.rounds; ++round) {
+        Move humanMove = opponent.next(history);
+        bench::Timer moveTimer;
+        Move computerMove = smart.makeMove(history);
+        run.moveSeconds += moveTimer.seconds();
+        run.moves.push_back(computerMove);
+        run.predictions.push_back(smart.isPredictionValid() ? smart.getLastPredictedHumanMove()
+                                                            : static_cast<Move>(3));
+        if (determineWinner(humanMove, computerMove) < 0) {
+            run.computerWins++;
+        }
+        history.emplace_back(humanMove, computerMove);
+        bench::Timer updateTimer;
+        smart.updateFrequencies(history);
+        run.updateSeconds += updateTimer.seconds();
+        for (int seqLen : smart.getSeqLengths()) {
+            if (history.size() >= static_cast<size_t>(seqLen)) {
+                uint64_t key = FrequencyModel::makeKey(history, history.size() - seqLen, seqLen - 1);
+                narrow.increment(seqLen, key, humanMove);
+            }
+        }
+    }
+    run.cache = smart.getPredictionCacheStats();
+    run.staleBest = countStaleBest(smart.getModel()) + countStaleBest(narrow);
+    return run;
+}
+
+} // namespace
+
+// The cache must not change a single move or prediction; it fails if one
+// differs, or if a context's cached best move is not its argmax.
+int benchPredict(const Options& options) {
+    std::cout << "Rounds per run: " << options.rounds << ", seed " << options.seed << std::endl;
+    std::cout << std::left << std::setw(10) << "opponent" << std::setw(7) << "cache" << std::right
+              << std::setw(10) << "ns/move" << std::setw(11) << "ns/update" << std::setw(8) << "hit%"
+              << std::setw(10) << "cpu win%" << std::endl;
+    int failures = 0;
+    for (const auto& entry : bench::opponentKinds()) {
+        PredictRun runs[2] = {runPredict(entry.second, options, false), runPredict(entry.second, options, true)};
+        for (int cached = 0; cached < 2; ++cached) {
+            const PredictRun& run = runs[cached];
+            double hits = run.cache.hits * 100.0 / options.rounds;
+            std::cout << std::left << std::setw(10) << entry.first << std::setw(7) << (cached ? "on" : "off")
+                      << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(10) << run.moveSeconds * 1e9 / options.rounds
+                      << std::setw(11) << run.updateSeconds * 1e9 / options.rounds
+                      << std::setw(8) << hits
+                      << std::setw(10) << run.computerWins * 100.0 / options.rounds;
+            bool failed = run.staleBest != 0 ||
+                          (cached && (run.moves != runs[0].moves || run.predictions != runs[0].predictions));
+            if (failed) {
+                std::cout << "  FAIL";
+                failures++;
+            }
+            std::cout << std::endl;
+        }
+    }
+    std::cout << "hit%: moves predicted from the cache; it is bypassed for a while when few lookups hit."
+              << " Both runs must make the same moves" << std::endl;
+    return failures > 0 ? 1 : 0;
+}
+
+} // namespace bench
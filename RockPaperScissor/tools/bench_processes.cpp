@@ -0,0 +1,156 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "SharedModelFile.h"
+#include "SmartStrategy.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// processes: several processes learning into one model file.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+// One process: load the model file, play options.rounds rounds against a
+// random opponent and save every options.saveEvery rounds and at the end,
+// either merging (saveState) or replacing the file with the whole model
+// (saveModel, under the same lock, so the last writer wins). Both save on
+// the round path, so their times compare.
+void playSharedModel(const Options& options, const std::string& modelFile, unsigned int seed, bool merge) {
+    SmartStrategy smart(seed, modelFile, "");
+    std::vector<std::pair<Move, Move>> history;
+    history.reserve(static_cast<std::size_t>(options.rounds));
+    bench::Opponent opponent(bench::OpponentKind::Random, seed);
+    for (long long round = 1; round <= options.rounds; ++round) {
+        Move humanMove = opponent.next(history);
+        history.emplace_back(humanMove, smart.makeMove(history));
+        smart.updateFrequencies(history);
+        if (round % options.saveEvery == 0 || round == options.rounds) {
+            if (merge) {
+                smart.saveState();
+            } else {
+                ModelFileLock lock(modelFile, true);
+                smart.saveModel(modelFile);
+            }
+        }
+    }
+}
+
+struct ProcessRun {
+    double seconds = 0;
+    long long kept = 0;           // order-3 observations in the final file
+    long long loads = 0;          // loads by the reader while the processes ran
+    long long invalidLoads = 0;   // loads that failed to parse
+    long long shrinkingLoads = 0; // loads with fewer observations than the one before
+};
+
+// Run 'processes' writer processes on a fresh model file while this process
+// loads it every few milliseconds, as a concurrent reader.
+ProcessRun runProcesses(const Options& options, const std::string& modelFile, int processes, bool merge) {
+    std::filesystem::remove(modelFile);
+    ProcessRun run;
+    bench::Timer timer;
+#ifdef RPS_BENCH_HAS_FORK
+    // Fork before the reader starts: a child would inherit a lock the reader
+    // holds, and flock locks belong to the open file, not the process.
+    std::vector<pid_t> children;
+    for (int p = 0; p < processes; ++p) {
+        pid_t child = fork();
+        if (child == 0) {
+            playSharedModel(options, modelFile, options.seed + static_cast<unsigned int>(p), merge);
+            _exit(0);
+        }
+        if (child > 0) {
+            children.push_back(child);
+        }
+    }
+#endif
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+        long long previous = 0;
+        while (!done.load()) {
+            FrequencyModel model;
+            FrequencyFileReader::Status status = SharedModelFile::load(modelFile, model);
+            if (status != FrequencyFileReader::Status::NotFound) {
+                run.loads++;
+                long long observations = status == FrequencyFileReader::Status::Ok ? order3Observations(model) : 0;
+                if (status == FrequencyFileReader::Status::Invalid) {
+                    run.invalidLoads++;
+                } else if (observations < previous) {
+                    run.shrinkingLoads++;
+                }
+                previous = std::max(previous, observations);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+#ifdef RPS_BENCH_HAS_FORK
+    for (pid_t child : children) {
+        int status = 0;
+        waitpid(child, &status, 0);
+    }
+#endif
+    run.seconds = timer.seconds();
+    done = true;
+    reader.join();
+    FrequencyModel final;
+    if (FrequencyFileReader::load(modelFile, final) == FrequencyFileReader::Status::Ok) {
+        run.kept = order3Observations(final);
+    }
+    return run;
+}
+
+} // namespace
+
+int benchProcesses(const Options& options) {
+#ifndef RPS_BENCH_HAS_FORK
+    (void)options;
+    std::cout << "processes needs fork(); skipped" << std::endl;
+    return 0;
+#else
+    const std::string modelFile = "bench-processes-freq.txt";
+    std::cout << options.rounds << " rounds per process against a random opponent, saving every "
+              << options.saveEvery << " rounds" << std::endl;
+    std::cout << std::left << std::setw(11) << "processes" << std::setw(9) << "saves" << std::right
+              << std::setw(10) << "seconds" << std::setw(9) << "kept%" << std::setw(16) << "kept rounds/s"
+              << std::setw(8) << "loads" << std::setw(9) << "invalid" << std::setw(11) << "shrinking"
+              << std::endl;
+    int failures = 0;
+    for (int processes = 1; processes <= options.processes; processes *= 2) {
+        for (bool merge : {false, true}) {
+            ProcessRun run = runProcesses(options, modelFile, processes, merge);
+            long long played = processes * (options.rounds - 2);
+            std::cout << std::left << std::setw(11) << processes << std::setw(9) << (merge ? "merge" : "replace")
+                      << std::right << std::fixed << std::setprecision(2) << std::setw(10) << run.seconds
+                      << std::setprecision(1) << std::setw(9) << 100.0 * run.kept / played
+                      << std::setprecision(0) << std::setw(16) << (run.kept + 2.0 * processes) / run.seconds
+                      << std::setw(8) << run.loads << std::setw(9) << run.invalidLoads << std::setw(11)
+                      << run.shrinkingLoads;
+            // Merging must keep every round of every process, and the reader
+            // must only ever see complete models that keep growing.
+            if (merge && (run.kept != played || run.invalidLoads != 0 || run.shrinkingLoads != 0)) {
+                std::cout << "  FAIL";
+                failures++;
+            }
+            std::cout << std::endl;
+        }
+    }
+    std::filesystem::remove(modelFile);
+    std::filesystem::remove(modelFile + ".lock");
+    std::cout << "kept%: the processes' rounds found in the final file; loads: by a concurrent reader,"
+              << " invalid if unparsable, shrinking if it had fewer rounds than the one before" << std::endl;
+    return failures > 0 ? 1 : 0;
+#endif
+}
+
+} // namespace bench
@@ -0,0 +1,159 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "SmartStrategy.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// reload: hot reload of the model file while a game is running.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+struct ReloadRun {
+    double seconds = 0;
+    std::vector<double> roundSeconds;  // sorted
+    long long versionsWritten = 0;
+    long long adoptions = 0;
+    long long unknownModels = 0;  // adopted models that match no written version
+    ModelReloader::Stats stats;
+};
+
+// Play the smart strategy on 'liveFile'. With 'reload' on, a writer thread
+// replaces the file with the next of 'versions' every 'writeEvery' and the
+// strategy hot-reloads it; every model it adopts is checked against the
+// digests of the versions.
+ReloadRun runReload(const Options& options, bool reload, const std::string& liveFile,
+                    const std::vector<std::string>& versions, const std::vector<uint64_t>& digests) {
+    namespace fs = std::filesystem;
+    ReloadRun run;
+    fs::copy_file(versions[0], liveFile, fs::copy_options::overwrite_existing);
+    SmartStrategy smart(options.seed, liveFile, "");
+    smart.setHotReload(reload, std::chrono::milliseconds(10));
+
+    std::atomic<bool> done{false};
+    std::thread writer;
+    if (reload) {
+        writer = std::thread([&] {
+            for (std::size_t next = 1; !done.load(); ++next) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                std::string temp = liveFile + ".new";
+                fs::copy_file(versions[next % versions.size()], temp, fs::copy_options::overwrite_existing);
+                fs::rename(temp, liveFile);
+                run.versionsWritten++;
+            }
+        });
+    }
+
+    bench::Opponent opponent(bench::OpponentKind::Lag, options.seed);
+    std::vector<std::pair<Move, Move>> history;
+    history.reserve(static_cast<size_t>(options.rounds));
+    run.roundSeconds.reserve(static_cast<size_t>(options.rounds));
+    uint64_t adopted = 0;
+    bench::Timer total;
+    for (long long round = 0; round < options.rounds; ++round) {
+        bench::Timer timer;
+        Move humanMove = opponent.next(history);
+        Move computerMove = smart.makeMove(history);
+        double seconds = timer.seconds();
+        // A model is only swapped in by makeMove, so right after it the model
+        // must be exactly one of the versions on disk.
+        if (reload && smart.getReloader()->getAdoptedVersion() != adopted) {
+            adopted = smart.getReloader()->getAdoptedVersion();
+            run.adoptions++;
+            uint64_t digest = modelDigest(smart.getModel());
+            if (std::find(digests.begin(), digests.end(), digest) == digests.end()) {
+                run.unknownModels++;
+            }
+        }
+        timer = bench::Timer();
+        history.emplace_back(humanMove, computerMove);
+        smart.updateFrequencies(history);
+        run.roundSeconds.push_back(seconds + timer.seconds());
+    }
+    run.seconds = total.seconds();
+    done = true;
+    if (writer.joinable()) {
+        writer.join();
+    }
+    if (reload) {
+        run.stats = smart.getReloader()->getStats();
+    }
+    std::sort(run.roundSeconds.begin(), run.roundSeconds.end());
+    return run;
+}
+
+} // namespace
+
+// Round latency of a game whose model file is replaced every 50 ms and
+// hot-reloaded, against the same game without reloading.
+int benchReload(const Options& options) {
+    namespace fs = std::filesystem;
+    const std::string liveFile = "rps_bench_reload.txt";
+    std::vector<std::string> versions;
+    std::vector<uint64_t> digests;
+    const auto& kinds = bench::opponentKinds();
+    for (std::size_t v = 0; v < 3; ++v) {
+        // Each version is trained on a different opponent.
+        SmartStrategy trainer(options.seed + static_cast<unsigned int>(v), "", "");
+        bench::Opponent opponent(kinds[v].second, options.seed + static_cast<unsigned int>(v));
+        std::vector<std::pair<Move, Move>> history;
+        for (long long round = 0; round < 100000; ++round) {
+            Move humanMove = opponent.next(history);
+            history.emplace_back(humanMove, trainer.makeMove(history));
+            trainer.updateFrequencies(history);
+        }
+        versions.push_back("rps_bench_reload_v" + std::to_string(v) + ".txt");
+        trainer.saveModel(versions.back());
+        FrequencyModel loaded;
+        FrequencyFileReader::load(versions.back(), loaded);
+        digests.push_back(modelDigest(loaded));
+    }
+
+    std::cout << "Smart vs lag opponent, " << options.rounds << " rounds; freq.txt replaced every 50 ms, "
+              << "polled every 10 ms" << std::endl;
+    std::cout << std::left << std::setw(12) << "reload" << std::right << std::setw(10) << "total ms"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(12) << "max us"
+              << std::setw(9) << "written" << std::setw(8) << "loaded" << std::setw(9) << "adopted" << std::endl;
+    auto print = [](const char* label, const ReloadRun& run) {
+        auto percentile = [&run](double p) {
+            return run.roundSeconds[static_cast<size_t>(p * (run.roundSeconds.size() - 1))] * 1e6;
+        };
+        std::cout << std::left << std::setw(12) << label << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << run.seconds * 1000 << std::setw(10) << percentile(0.5)
+                  << std::setw(10) << percentile(0.99) << std::setw(12) << percentile(1.0)
+                  << std::setw(9) << run.versionsWritten << std::setw(8) << run.stats.loads
+                  << std::setw(9) << run.adoptions << std::endl;
+    };
+    ReloadRun off = runReload(options, false, liveFile, versions, digests);
+    print("off", off);
+    ReloadRun on = runReload(options, true, liveFile, versions, digests);
+    print("hot reload", on);
+
+    fs::remove(liveFile);
+    for (const std::string& version : versions) {
+        fs::remove(version);
+    }
+    if (on.unknownModels > 0) {
+        std::cerr << on.unknownModels << " adopted models matched no version of the file" << std::endl;
+        return 1;
+    }
+    if (on.versionsWritten > 1 && on.adoptions == 0) {
+        std::cerr << "no new version was adopted" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace bench
@@ -0,0 +1,194 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "ReplicatedModel.h"
+#include "SmartStrategy.h"
+#include <algorithm>
+#include <barrier>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// replicas: simulation threads learning one model, shared vs replicated.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+struct ReplicaRun {
+    double seconds = 0;
+    long long rounds = 0;
+    long long computerWins = 0;
+    long long increments = 0;  // counter increments the strategies made
+    uint64_t digest = 0;       // of the final model
+    ReplicatedModel::Stats stats;
+};
+
+// 'threads' workers play options.rounds rounds between them, in games of
+// options.gameRounds rounds against lag opponents seeded by game number.
+// Without 'replicated', the workers share one smart strategy behind a mutex;
+// with it, each has a strategy on its own replica and the replicas are merged
+// every options.epochRounds rounds at a barrier.
+ReplicaRun runReplicas(const Options& options, std::size_t threads, bool replicated) {
+    const long long perThread = options.rounds / static_cast<long long>(threads);
+    const std::size_t gameRounds = static_cast<std::size_t>(options.gameRounds);
+
+    SmartStrategy shared(options.seed, "", "");
+    std::mutex sharedMutex;
+    const std::vector<int> orders = shared.getSeqLengths();
+    std::unique_ptr<ReplicatedModel> model;
+    std::vector<std::unique_ptr<SmartStrategy>> strategies;
+    if (replicated) {
+        model = std::make_unique<ReplicatedModel>(FrequencyModel(), threads);
+        for (std::size_t t = 0; t < threads; ++t) {
+            strategies.push_back(std::make_unique<SmartStrategy>(options.seed + static_cast<unsigned int>(t), "", ""));
+            strategies.back()->setReplica(&model->replica(t));
+        }
+    }
+    // A merge is replayed by all workers, split by sequence length, between
+    // two barriers.
+    std::barrier epochEnd(static_cast<std::ptrdiff_t>(threads), [&model]() noexcept { model->beginMerge(); });
+    std::barrier replayed(static_cast<std::ptrdiff_t>(threads), [&model]() noexcept { model->endMerge(); });
+
+    std::vector<ReplicaRun> tallies(threads);
+    auto work = [&](std::size_t t) {
+        ReplicaRun& tally = tallies[t];
+        std::vector<std::pair<Move, Move>> history;
+        history.reserve(gameRounds);
+        std::size_t game = t;  // games are numbered across the workers
+        bench::Opponent opponent(bench::OpponentKind::Lag, options.seed + static_cast<unsigned int>(game));
+        for (long long round = 0; round < perThread; ++round) {
+            if (history.size() == gameRounds) {
+                history.clear();
+                game += threads;
+                opponent = bench::Opponent(bench::OpponentKind::Lag, options.seed + static_cast<unsigned int>(game));
+            }
+            Move humanMove = opponent.next(history);
+            Move computerMove;
+            if (replicated) {
+                computerMove = strategies[t]->makeMove(history);
+                history.emplace_back(humanMove, computerMove);
+                strategies[t]->updateFrequencies(history);
+            } else {
+                std::lock_guard<std::mutex> lock(sharedMutex);
+                computerMove = shared.makeMove(history);
+                history.emplace_back(humanMove, computerMove);
+                shared.updateFrequencies(history);
+            }
+            if (determineWinner(humanMove, computerMove) < 0) {
+                tally.computerWins++;
+            }
+            for (int seqLen : orders) {
+                if (history.size() >= static_cast<std::size_t>(seqLen)) {
+                    tally.increments++;
+                }
+            }
+            // Every worker plays the same number of rounds, so all of them
+            // reach the same barriers.
+            if (replicated && ((round + 1) % options.epochRounds == 0 || round + 1 == perThread)) {
+                epochEnd.arrive_and_wait();
+                model->mergePart(t, threads);
+                replayed.arrive_and_wait();
+            }
+        }
+    };
+
+    bench::Timer timer;
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back(work, t);
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    ReplicaRun run;
+    run.seconds = timer.seconds();
+    run.rounds = perThread * static_cast<long long>(threads);
+    for (const ReplicaRun& tally : tallies) {
+        run.computerWins += tally.computerWins;
+        run.increments += tally.increments;
+    }
+    if (replicated) {
+        run.stats = model->getStats();
+        run.digest = modelDigest(model->getGlobal());
+    } else {
+        run.digest = modelDigest(shared.getModel());
+    }
+    return run;
+}
+
+} // namespace
+
+// Learning throughput of 1, 2, 4 ... --threads workers on one shared,
+// locked model and on per-thread replicas merged every --epoch-rounds
+// rounds, with the staleness the replicas pay for it. Checks that every
+// update reaches the global model, that a single replica learns exactly what
+// the shared model does, and that replicated runs are reproducible.
+int benchReplicas(const Options& options) {
+    std::cout << "Smart vs lag opponents, " << options.rounds << " rounds in games of " << options.gameRounds
+              << ", epoch " << options.epochRounds << " rounds per replica; "
+              << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+    std::cout << std::left << std::setw(12) << "model" << std::right << std::setw(8) << "threads"
+              << std::setw(12) << "rounds/s" << std::setw(9) << "scaling" << std::setw(8) << "win%"
+              << std::setw(8) << "epochs" << std::setw(10) << "lag avg" << std::setw(10) << "lag max"
+              << std::setw(10) << "epoch ms" << std::setw(10) << "merge ms" << std::endl;
+    std::vector<std::size_t> threadCounts;
+    for (std::size_t threads = 1; threads < static_cast<std::size_t>(options.threads); threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(static_cast<std::size_t>(options.threads));
+
+    int failures = 0;
+    uint64_t singleDigest = 0;
+    for (bool replicated : {false, true}) {
+        double baseline = 0;
+        for (std::size_t threads : threadCounts) {
+            ReplicaRun run = runReplicas(options, threads, replicated);
+            double rate = run.rounds / run.seconds;
+            if (baseline == 0) {
+                baseline = rate;
+                if (!replicated) {
+                    singleDigest = run.digest;
+                } else if (run.digest != singleDigest) {
+                    std::cerr << "one replica learned a different model than the shared strategy" << std::endl;
+                    failures++;
+                }
+            }
+            const ReplicatedModel::Stats& stats = run.stats;
+            std::cout << std::left << std::setw(12) << (replicated ? "replicas" : "shared") << std::right
+                      << std::fixed << std::setprecision(1) << std::setw(8) << threads
+                      << std::setw(12) << std::setprecision(0) << rate << std::setprecision(2)
+                      << std::setw(9) << rate / baseline << std::setprecision(1)
+                      << std::setw(8) << run.computerWins * 100.0 / run.rounds;
+            if (replicated) {
+                double lagSamples = static_cast<double>(std::max<long long>(stats.epochs, 1) * threads);
+                double epochs = static_cast<double>(std::max<long long>(stats.epochs, 1));
+                std::cout << std::setw(8) << stats.epochs << std::setw(10) << stats.lagRounds / lagSamples
+                          << std::setw(10) << stats.maxLagRounds << std::setprecision(2)
+                          << std::setw(10) << stats.epochSeconds * 1000 / epochs
+                          << std::setw(10) << stats.mergeSeconds * 1000 / epochs;
+                if (stats.increments != run.increments || stats.rounds != run.rounds) {
+                    std::cerr << "\nthe global model merged " << stats.increments << " of " << run.increments
+                              << " increments" << std::endl;
+                    failures++;
+                }
+                if (threads == threadCounts.back() && runReplicas(options, threads, true).digest != run.digest) {
+                    std::cerr << "\nreplicated runs with the same seed built different models" << std::endl;
+                    failures++;
+                }
+            }
+            std::cout << std::endl;
+        }
+    }
+    std::cout << "lag: rounds a replica had not seen when its epoch was merged; epoch and merge: mean wall time"
+              << std::endl;
+    return failures > 0 ? 1 : 0;
+}
+
+} // namespace bench
@@ -0,0 +1,212 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "SmartStrategy.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// save, profiles: model saves during a game, and per-player profiles under a
+// memory cap.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+struct SaveRun {
+    double seconds = 0;
+    std::vector<double> roundSeconds;  // sorted
+    ModelSaver::Stats saves;
+};
+
+// Play against a random opponent and call saveState() every saveEvery rounds,
+// timing every round including the ones that save.
+SaveRun runWithSaves(const Options& options, bool background, const std::string& modelFile) {
+    SaveRun run;
+    SmartStrategy smart(options.seed, modelFile, "");
+    smart.setBackgroundSave(background);
+    bench::Opponent opponent(bench::OpponentKind::Random, options.seed);
+    std::vector<std::pair<Move, Move>> history;
+    history.reserve(static_cast<size_t>(options.rounds));
+    run.roundSeconds.reserve(static_cast<size_t>(options.rounds));
+
+    bench::Timer total;
+    for (long long round = 1; round <= options.rounds; ++round) {
+        bench::Timer timer;
+        Move humanMove = opponent.next(history);
+        Move computerMove = smart.makeMove(history);
+        history.emplace_back(humanMove, computerMove);
+        smart.updateFrequencies(history);
+        if (round % options.saveEvery == 0) {
+            smart.saveState();
+        }
+        run.roundSeconds.push_back(timer.seconds());
+    }
+    run.seconds = total.seconds();
+    smart.waitForSaves();
+    run.saves = smart.getSaveStats();
+    if (!background) {
+        run.saves.submitted = run.saves.written = options.rounds / options.saveEvery;
+    }
+    std::sort(run.roundSeconds.begin(), run.roundSeconds.end());
+    return run;
+}
+
+void printSaveRun(const std::string& mode, const SaveRun& run) {
+    auto percentile = [&run](double p) {
+        size_t i = static_cast<size_t>(p * (run.roundSeconds.size() - 1));
+        return run.roundSeconds[i] * 1e6;
+    };
+    std::cout << std::left << std::setw(12) << mode << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << run.seconds * 1000
+              << std::setw(10) << percentile(0.5)
+              << std::setw(10) << percentile(0.99)
+              << std::setw(12) << percentile(1.0)
+              << std::setw(9) << run.saves.written
+              << std::setw(12) << run.saves.superseded << std::endl;
+}
+
+} // namespace
+
+// Round latency while the model is saved periodically, synchronously versus
+// through background copy-on-write snapshots.
+int benchSave(const Options& options) {
+    const std::string syncFile = "rps_bench_save_sync.txt";
+    const std::string backgroundFile = "rps_bench_save_background.txt";
+    std::remove(syncFile.c_str());
+    std::remove(backgroundFile.c_str());
+
+    std::cout << "Random opponent, " << options.rounds << " rounds, save every " << options.saveEvery
+              << " rounds" << std::endl;
+    std::cout << std::left << std::setw(12) << "save" << std::right << std::setw(10) << "total ms"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(12) << "max us"
+              << std::setw(9) << "written" << std::setw(12) << "superseded" << std::endl;
+    printSaveRun("synchronous", runWithSaves(options, false, syncFile));
+    printSaveRun("background", runWithSaves(options, true, backgroundFile));
+
+    // The last background save must match the last synchronous one.
+    std::ifstream a(syncFile, std::ios::binary), b(backgroundFile, std::ios::binary);
+    std::string syncText((std::istreambuf_iterator<char>(a)), std::istreambuf_iterator<char>());
+    std::string backgroundText((std::istreambuf_iterator<char>(b)), std::istreambuf_iterator<char>());
+    std::remove(syncFile.c_str());
+    std::remove(backgroundFile.c_str());
+    if (syncText != backgroundText) {
+        std::cerr << "Background save differs from the synchronous save" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+namespace {
+
+struct ProfileRun {
+    double seconds = 0;
+    ProfileStore::Stats stats;
+    long long rssBytes = 0;
+    bool rssKnown = false;
+};
+
+// Play 'sessions' games of sessionRounds rounds. Each session picks a player
+// with a skewed distribution (a few players come back often, most rarely)
+// and plays that player's simulated opponent with their own profile.
+ProfileRun runProfiles(const Options& options, const std::string& directory, std::size_t capBytes) {
+    ProfileRun run;
+    auto store = std::make_shared<ProfileStore>(directory, capBytes);
+    std::mt19937 pick(options.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const auto& kinds = bench::opponentKinds();
+    std::vector<std::pair<Move, Move>> history;
+
+    bench::Timer timer;
+    for (long long session = 0; session < options.sessions; ++session) {
+        // Squaring a uniform draw favours low player numbers.
+        double u = unit(pick);
+        int player = static_cast<int>(u * u * options.players);
+        SmartStrategy smart(options.seed + static_cast<unsigned int>(session), "", "");
+        smart.setProfileStore(store);
+        smart.setPlayer("player" + std::to_string(player));
+        bench::Opponent opponent(kinds[player % kinds.size()].second, options.seed + player);
+        history.clear();
+        for (int round = 0; round < options.sessionRounds; ++round) {
+            Move humanMove = opponent.next(history);
+            Move computerMove = smart.makeMove(history);
+            history.emplace_back(humanMove, computerMove);
+            smart.updateFrequencies(history);
+        }
+    }
+    store->flush();
+    run.seconds = timer.seconds();
+    run.stats = store->getStats();
+    run.rssBytes = bench::currentRssBytes();
+    run.rssKnown = run.rssBytes >= 0;
+    return run;
+}
+
+void printProfileRun(const std::string& label, const ProfileRun& run) {
+    const ProfileStore::Stats& s = run.stats;
+    std::cout << std::left << std::setw(10) << label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << run.seconds * 1000
+              << std::setw(8) << (s.checkouts > 0 ? s.hits * 100.0 / s.checkouts : 0)
+              << std::setw(8) << s.loads << std::setw(8) << s.created
+              << std::setw(8) << s.writes << std::setw(10) << s.evictions
+              << std::setw(12) << s.peakResidentBytes / 1024
+              << std::setw(10) << (run.rssKnown ? std::to_string(run.rssBytes / 1024) : "n/a") << std::endl;
+}
+
+} // namespace
+
+// Per-player profiles under a memory cap against the same workload with
+// every profile kept in memory. The profile files must come out identical.
+int benchProfiles(const Options& options) {
+    namespace fs = std::filesystem;
+    const std::string cappedDir = "rps_bench_profiles_capped";
+    const std::string residentDir = "rps_bench_profiles_resident";
+    fs::remove_all(cappedDir);
+    fs::remove_all(residentDir);
+
+    std::cout << options.players << " players, " << options.sessions << " sessions of "
+              << options.sessionRounds << " rounds, cap " << options.profileCapMiB << " MiB" << std::endl;
+    std::cout << std::left << std::setw(10) << "cap" << std::right << std::setw(10) << "ms"
+              << std::setw(8) << "hit%" << std::setw(8) << "loads" << std::setw(8) << "new"
+              << std::setw(8) << "writes" << std::setw(10) << "evicted"
+              << std::setw(12) << "peak KiB" << std::setw(10) << "RSS KiB" << std::endl;
+    // Separate processes, so RSS shows each run on its own.
+    runIsolated([&] {
+        std::size_t capBytes = static_cast<std::size_t>(options.profileCapMiB) << 20;
+        printProfileRun(std::to_string(options.profileCapMiB) + " MiB", runProfiles(options, cappedDir, capBytes));
+    });
+    runIsolated([&] {
+        printProfileRun("none", runProfiles(options, residentDir, std::numeric_limits<std::size_t>::max()));
+    });
+
+    int differing = 0;
+    for (const auto& entry : fs::directory_iterator(residentDir)) {
+        std::ifstream a(entry.path(), std::ios::binary);
+        std::ifstream b(fs::path(cappedDir) / entry.path().filename(), std::ios::binary);
+        std::string residentText((std::istreambuf_iterator<char>(a)), std::istreambuf_iterator<char>());
+        std::string cappedText((std::istreambuf_iterator<char>(b)), std::istreambuf_iterator<char>());
+        if (residentText != cappedText) {
+            differing++;
+        }
+    }
+    fs::remove_all(cappedDir);
+    fs::remove_all(residentDir);
+    if (differing > 0) {
+        std::cerr << differing << " profiles differ between the capped and the resident run" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace bench
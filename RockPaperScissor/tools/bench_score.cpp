@@ -0,0 +1,134 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "RoundScoring.h"
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// score: throughput of the packed round-scoring kernels.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+// determineWinner as it was before the payoff table, for comparison.
+int branchyWinner(Move playerMove, Move computerMove) {
+    if (playerMove == computerMove) {
+        return 0;
+    }
+    if ((playerMove == Move::ROCK && computerMove == Move::SCISSORS) ||
+        (playerMove == Move::PAPER && computerMove == Move::ROCK) ||
+        (playerMove == Move::SCISSORS && computerMove == Move::PAPER)) {
+        return 1;
+    }
+    return -1;
+}
+
+template <typename WinnerFn>
+RoundTally scorePerRound(const std::vector<uint8_t>& codes, WinnerFn winner) {
+    RoundTally tally;
+    for (uint8_t code : codes) {
+        int result = winner(static_cast<Move>(code / 3), static_cast<Move>(code % 3));
+        if (result > 0) tally.humanWins++;
+        else if (result < 0) tally.computerWins++;
+        else tally.ties++;
+    }
+    return tally;
+}
+
+// Best of 'passes' runs of fn over the buffer, in GB/s.
+template <typename Fn>
+double bestRate(std::size_t bytes, int passes, Fn fn) {
+    double best = 0;
+    for (int pass = 0; pass < passes; ++pass) {
+        bench::Timer timer;
+        fn();
+        best = std::max(best, bytes / timer.seconds() / 1e9);
+    }
+    return best;
+}
+
+} // namespace
+
+// Throughput of the round-scoring kernels on 'scoreMiB' MiB of packed rounds,
+// against per-round determineWinner calls and a plain read of the buffer.
+int benchScore(const Options& options) {
+    std::vector<uint8_t> codes(static_cast<std::size_t>(options.scoreMiB) << 20);
+    std::mt19937 rng(options.seed);
+    for (uint8_t& code : codes) {
+        code = static_cast<uint8_t>(rng() % 9);
+    }
+
+    // Every misalignment and many lengths of the vector loop's head and tail,
+    // on bytes that include codes above 8.
+    std::vector<uint8_t> mixed(20000);
+    for (uint8_t& code : mixed) {
+        code = static_cast<uint8_t>(rng() % 4 == 0 ? rng() % 256 : rng() % 9);
+    }
+    for (std::size_t offset = 0; offset < 64; ++offset) {
+        for (std::size_t length = 0; offset + length <= mixed.size(); length += length < 300 ? 1 : 997) {
+            if (!(RoundScoring::score(mixed.data() + offset, length) ==
+                  RoundScoring::scoreScalar(mixed.data() + offset, length))) {
+                std::cerr << "score() differs from scoreScalar() at offset " << offset << ", length " << length
+                          << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    const int passes = 3;
+    const std::size_t bytes = codes.size();
+    RoundTally branchy, table, scalar, vectorized, blocks;
+    uint64_t checksum = 0;
+    double readRate = bestRate(bytes, passes, [&] {
+        uint64_t sum = 0;
+        const uint64_t* words = reinterpret_cast<const uint64_t*>(codes.data());
+        for (std::size_t i = 0; i < bytes / 8; ++i) sum += words[i];
+        checksum = sum;
+    });
+    // One pass of the per-round loops takes seconds.
+    double branchyRate = bestRate(bytes, 1, [&] { branchy = scorePerRound(codes, branchyWinner); });
+    double tableRate = bestRate(bytes, 1, [&] { table = scorePerRound(codes, determineWinner); });
+    double scalarRate = bestRate(bytes, passes, [&] {
+        scalar = RoundScoring::scoreScalar(codes.data(), codes.size());
+    });
+    double vectorRate = bestRate(bytes, passes, [&] {
+        vectorized = RoundScoring::score(codes.data(), codes.size());
+    });
+    double blockRate = bestRate(bytes, passes, [&] {
+        blocks = RoundTally();
+        for (const RoundTally& block : RoundScoring::scoreBlocks(codes.data(), codes.size(), 1000)) {
+            blocks += block;
+        }
+    });
+
+    std::cout << options.scoreMiB << " MiB of packed rounds (one byte each), kernel " << RoundScoring::kernelName()
+              << " (read checksum " << (checksum & 0xff) << ")" << std::endl;
+    std::cout << std::left << std::setw(28) << "method" << std::right << std::setw(12) << "Grounds/s" << std::endl;
+    auto row = [](const std::string& method, double rate) {
+        std::cout << std::left << std::setw(28) << method << std::right << std::setw(12) << std::fixed
+                  << std::setprecision(2) << rate << std::endl;
+    };
+    row("read only", readRate);
+    row("determineWinner (branches)", branchyRate);
+    row("determineWinner (table)", tableRate);
+    row("scoreScalar", scalarRate);
+    row("score", vectorRate);
+    row("scoreBlocks (1000 rounds)", blockRate);
+    std::cout << "human " << vectorized.humanWins << ", computer " << vectorized.computerWins
+              << ", ties " << vectorized.ties << std::endl;
+
+    if (!(branchy == table) || !(table == scalar) || !(scalar == vectorized) || !(vectorized == blocks)) {
+        std::cerr << "tallies differ between methods" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace bench
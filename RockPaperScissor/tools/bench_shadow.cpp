@@ -0,0 +1,109 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "ContextTreeStrategy.h"
+#include "RandomStrategy.h"
+#include "ShadowEvaluator.h"
+#include "SmartStrategy.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// shadow: cost of shadow strategies on the live round path.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+struct ShadowRun {
+    double seconds = 0;
+    std::vector<double> roundSeconds;  // sorted
+    std::string report;
+};
+
+// The live smart strategy against a lag opponent, timing every round. With
+// 'shadowed' set, ContextTree, adaptive Smart and Random shadows run on
+// batches of 'batchRounds' rounds, in the background or on this thread.
+ShadowRun runShadowed(const Options& options, bool shadowed, std::size_t batchRounds, bool background) {
+    ShadowRun run;
+    SmartStrategy smart(options.seed, "", "");
+    ShadowEvaluator evaluator(options.window, batchRounds);
+    if (shadowed) {
+        evaluator.addShadow(std::make_unique<ContextTreeStrategy>(options.seed, 3, options.maxOrder));
+        auto adaptive = std::make_unique<SmartStrategy>(options.seed, "", "");
+        adaptive->setAdaptiveOrders(true);
+        evaluator.addShadow(std::move(adaptive), "Smart adaptive");
+        evaluator.addShadow(std::make_unique<RandomStrategy>(options.seed, ""));
+        evaluator.setBackground(background);
+        evaluator.setLiveName("Smart");
+    }
+    bench::Opponent opponent(bench::OpponentKind::Lag, options.seed);
+    std::vector<std::pair<Move, Move>> history;
+    history.reserve(static_cast<size_t>(options.rounds));
+    run.roundSeconds.reserve(static_cast<size_t>(options.rounds));
+
+    bench::Timer total;
+    for (long long round = 0; round < options.rounds; ++round) {
+        bench::Timer timer;
+        Move humanMove = opponent.next(history);
+        Move computerMove = smart.makeMove(history);
+        int predicted = smart.isPredictionValid() ? static_cast<int>(smart.getLastPredictedHumanMove()) : -1;
+        history.emplace_back(humanMove, computerMove);
+        smart.updateFrequencies(history);
+        evaluator.record(humanMove, computerMove, predicted);
+        run.roundSeconds.push_back(timer.seconds());
+    }
+    run.seconds = total.seconds();
+    if (shadowed) {
+        evaluator.endGame();
+        evaluator.flush();
+        std::ostringstream text;
+        evaluator.report(text);
+        run.report = text.str();
+    }
+    std::sort(run.roundSeconds.begin(), run.roundSeconds.end());
+    return run;
+}
+
+} // namespace
+
+// Live round latency without shadows, with shadows evaluated every round,
+// in batches on the game's thread, and in batches on the worker thread.
+// All shadowed runs must report the same results.
+int benchShadow(const Options& options) {
+    std::cout << "Smart vs lag opponent, " << options.rounds << " rounds; shadows: ContextTree, Smart adaptive, Random"
+              << std::endl;
+    std::cout << std::left << std::setw(22) << "shadows" << std::right << std::setw(10) << "total ms"
+              << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(12) << "max us" << std::endl;
+    auto print = [](const char* label, const ShadowRun& run) {
+        auto percentile = [&run](double p) {
+            return run.roundSeconds[static_cast<size_t>(p * (run.roundSeconds.size() - 1))] * 1e6;
+        };
+        std::cout << std::left << std::setw(22) << label << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << run.seconds * 1000 << std::setw(10) << percentile(0.5)
+                  << std::setw(10) << percentile(0.99) << std::setw(12) << percentile(1.0) << std::endl;
+    };
+    ShadowRun none = runShadowed(options, false, 1, false);
+    print("none", none);
+    ShadowRun everyRound = runShadowed(options, true, 1, false);
+    print("inline, every round", everyRound);
+    ShadowRun batched = runShadowed(options, true, 256, false);
+    print("inline, batches of 256", batched);
+    ShadowRun background = runShadowed(options, true, 256, true);
+    print("worker, batches of 256", background);
+
+    std::cout << '\n' << background.report;
+    if (everyRound.report != batched.report || everyRound.report != background.report) {
+        std::cerr << "shadow results differ between runs" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace bench
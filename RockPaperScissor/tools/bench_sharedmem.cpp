@@ -0,0 +1,186 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "SharedMemoryModel.h"
+#include "SmartStrategy.h"
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// sharedmem: writer processes on one shared-memory model vs private models.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+// What one writer process reports back through shared memory.
+struct WriterResult {
+    double seconds = 0;
+    long long computerWins = 0;
+    long long modelBytes = 0;  // its private model; 0 with the shared one
+};
+
+// One writer: options.rounds rounds of the smart strategy against a lag
+// opponent, learning into its own model or into the segment 'segment'.
+WriterResult playWriter(const Options& options, const std::string& segment, unsigned int seed) {
+    SmartStrategy smart(seed, "", "");
+    if (!segment.empty()) {
+        std::shared_ptr<SharedMemoryModel> shared = SharedMemoryModel::open(segment, "");
+        if (!shared || !smart.setSharedModel(std::move(shared))) {
+            _exit(1);
+        }
+    }
+    std::vector<std::pair<Move, Move>> history;
+    history.reserve(static_cast<std::size_t>(options.rounds));
+    bench::Opponent opponent(bench::OpponentKind::Lag, seed);
+    WriterResult result;
+    bench::Timer timer;
+    for (long long round = 0; round < options.rounds; ++round) {
+        Move humanMove = opponent.next(history);
+        Move computerMove = smart.makeMove(history);
+        if (determineWinner(humanMove, computerMove) < 0) {
+            result.computerWins++;
+        }
+        history.emplace_back(humanMove, computerMove);
+        smart.updateFrequencies(history);
+    }
+    result.seconds = timer.seconds();
+    if (segment.empty()) {
+        result.modelBytes = static_cast<long long>(smart.getModel().memoryUsage());
+    }
+    return result;
+}
+
+struct SharedMemoryRun {
+    double seconds = 0;         // wall time of all writers
+    long long computerWins = 0;
+    long long modelBytes = 0;   // private models summed, or the segment's resident pages
+    long long kept = 0;         // order-3 observations in the shared model
+    long long dropped = 0;
+    bool failedWriters = false;
+};
+
+// Run 'processes' writers at once, with private models or on one segment
+// that this process creates empty beforehand and the writers attach to.
+SharedMemoryRun runSharedMemory(const Options& options, int processes, bool shared) {
+    SharedMemoryRun run;
+#ifdef RPS_BENCH_HAS_FORK
+    const std::string segment = shared ? "rps-bench-" + std::to_string(getpid()) : "";
+    std::unique_ptr<SharedMemoryModel> model;
+    if (shared) {
+        SharedMemoryModel::remove(segment);
+        model = SharedMemoryModel::open(segment, "", 3, 7, static_cast<std::size_t>(options.sharedSlots));
+        if (!model) {
+            run.failedWriters = true;
+            return run;
+        }
+    }
+    void* mapping = mmap(nullptr, sizeof(WriterResult) * processes, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        run.failedWriters = true;
+        return run;
+    }
+    WriterResult* results = static_cast<WriterResult*>(mapping);
+    bench::Timer timer;
+    std::vector<pid_t> children;
+    for (int p = 0; p < processes; ++p) {
+        pid_t child = fork();
+        if (child == 0) {
+            results[p] = playWriter(options, segment, options.seed + static_cast<unsigned int>(p));
+            _exit(0);
+        }
+        if (child > 0) {
+            children.push_back(child);
+        }
+    }
+    for (pid_t child : children) {
+        int status = 0;
+        waitpid(child, &status, 0);
+        run.failedWriters = run.failedWriters || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+    run.seconds = timer.seconds();
+    run.failedWriters = run.failedWriters || static_cast<int>(children.size()) != processes;
+    for (int p = 0; p < processes; ++p) {
+        run.computerWins += results[p].computerWins;
+        run.modelBytes += results[p].modelBytes;
+    }
+    munmap(mapping, sizeof(WriterResult) * processes);
+    if (shared) {
+        // Resident pages first: exporting reads, and so maps, every slot.
+        run.modelBytes = static_cast<long long>(model->getResidentBytes());
+        run.dropped = model->getDroppedUpdates();
+        FrequencyModel32 snapshot;
+        model->exportTo(snapshot);
+        run.kept = order3Observations(snapshot);
+        SharedMemoryModel::remove(segment);
+    }
+#else
+    (void)options;
+    (void)processes;
+    (void)shared;
+#endif
+    return run;
+}
+
+} // namespace
+
+int benchSharedMemory(const Options& options) {
+#ifndef RPS_BENCH_HAS_FORK
+    (void)options;
+    std::cout << "sharedmem needs fork() and POSIX shared memory; skipped" << std::endl;
+    return 0;
+#else
+    std::cout << options.rounds << " rounds per process against a lag opponent; "
+              << options.sharedSlots << " slots per shared table" << std::endl;
+    std::cout << std::left << std::setw(11) << "processes" << std::setw(9) << "model" << std::right
+              << std::setw(10) << "seconds" << std::setw(14) << "updates/s" << std::setw(11) << "model MiB"
+              << std::setw(10) << "cpu win%" << std::setw(9) << "dropped" << std::endl;
+    const int orders = 5;  // the smart strategy's sequence lengths 3..7
+    int failures = 0;
+    double privateBytesPerProcess = 0;
+    double sharedBytes = 0;
+    for (int processes = 1; processes <= options.writers; processes *= 2) {
+        for (bool shared : {false, true}) {
+            SharedMemoryRun run = runSharedMemory(options, processes, shared);
+            // From the most processes run, where the segment is fullest.
+            if (shared) {
+                sharedBytes = static_cast<double>(run.modelBytes);
+            } else {
+                privateBytesPerProcess = static_cast<double>(run.modelBytes) / processes;
+            }
+            double rounds = static_cast<double>(processes) * options.rounds;
+            std::cout << std::left << std::setw(11) << processes << std::setw(9) << (shared ? "shared" : "private")
+                      << std::right << std::fixed << std::setprecision(2) << std::setw(10) << run.seconds
+                      << std::setprecision(0) << std::setw(14) << rounds * orders / run.seconds
+                      << std::setprecision(1) << std::setw(11) << run.modelBytes / (1024.0 * 1024.0)
+                      << std::setw(10) << run.computerWins * 100.0 / rounds
+                      << std::setw(9) << run.dropped;
+            // Every writer's every round must be in the shared model.
+            bool failed = run.failedWriters ||
+                          (shared && (run.kept != processes * (options.rounds - 2) || run.dropped != 0));
+            if (failed) {
+                std::cout << "  FAIL";
+                failures++;
+            }
+            std::cout << std::endl;
+        }
+    }
+    if (privateBytesPerProcess > 0) {
+        std::cout << "break-even: the segment takes less memory than private models from "
+                  << static_cast<long long>(sharedBytes / privateBytesPerProcess) + 1 << " writers on ("
+                  << std::setprecision(1) << sharedBytes / (1024.0 * 1024.0) << " MiB vs "
+                  << std::setprecision(2) << privateBytesPerProcess / (1024.0 * 1024.0) << " MiB per process)"
+                  << std::endl;
+    }
+    std::cout << "updates/s: context updates (one per order per round) by all writers; model MiB: private"
+              << " models summed, or the shared segment's resident pages" << std::endl;
+    return failures > 0 ? 1 : 0;
+#endif
+}
+
+} // namespace bench
@@ -0,0 +1,245 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "ContextSketch.h"
+#include "SmartStrategy.h"
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// sketch: long orders counted in a Count-Min sketch vs exact counts.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+// Most frequent move among the moves in 'mask', ties to the lowest, as in
+// SmartStrategy; -1 without any.
+int predictFromCounts(const int64_t counts[3], int mask) {
+    if (mask == 0) {
+        return -1;
+    }
+    int prediction = 0;
+    int64_t maxFreq = 0;
+    for (int m = 0; m < 3; ++m) {
+        if ((mask & (1 << m)) && counts[m] > maxFreq) {
+            maxFreq = counts[m];
+            prediction = m;
+        }
+    }
+    return prediction;
+}
+
+struct SketchTally {
+    std::string label;
+    ContextSketch sketch;
+    double seconds = 0;
+    long long seen = 0;            // long contexts looked up that had been counted
+    long long exact = 0;           // of those, estimated exactly
+    long long overcount = 0;       // estimate minus exact count, summed over moves
+    long long unseen = 0;          // long contexts looked up that had not
+    long long falsePositives = 0;  // of those, reported as counted
+    long long correct = 0;         // predictions that named the human move
+    long long agreeing = 0;        // rounds predicting what exact long counts predict
+
+    SketchTally(std::string name, std::size_t bytes, bool conservative)
+        : label(std::move(name)), sketch(bytes, 4, conservative) {}
+};
+
+// Replay a game through SmartStrategy's prediction rule with orders 3..7
+// exact and 8..options.longOrders added three ways: not at all, exactly, and
+// from each sketch. Exact long counts are kept in a 32-bit model keyed by
+// the same 64-bit context hashes the sketches use.
+int benchSketchGame(const Options& options, const RecordedGame& game) {
+    static const int seqLengths[] = {3, 4, 5, 6, 7};
+    const int longMin = 8;
+    const int longMax = options.longOrders;
+    std::vector<std::unique_ptr<SketchTally>> tallies;
+    for (std::size_t kib : {64, 256, 1024, 4096}) {
+        for (bool conservative : {true, false}) {
+            tallies.push_back(std::make_unique<SketchTally>(
+                std::to_string(kib) + " KiB " + (conservative ? "cons" : "plain"), kib << 10, conservative));
+        }
+    }
+    FrequencyModel32 shortModel;
+    FrequencyModel32 longModel;
+    long long predictions = 0;
+    long long shortCorrect = 0;
+    long long exactCorrect = 0;
+    std::vector<uint64_t> contexts(static_cast<std::size_t>(longMax));
+    History history;
+    history.reserve(game.history.size());
+
+    for (const auto& round : game.history) {
+        int human = static_cast<int>(round.first);
+        int64_t shortCounts[3] = {0, 0, 0};
+        int shortMask = 0;
+        for (int seqLen : seqLengths) {
+            if (history.size() < static_cast<size_t>(seqLen - 1)) continue;
+            uint64_t key = FrequencyModel32::makeKey(history, history.size() - (seqLen - 1), seqLen - 1);
+            if (const FrequencyModel32::Context* context = shortModel.find(seqLen, key)) {
+                for (int m = 0; m < 3; ++m) shortCounts[m] += context->counts[m];
+                shortMask |= context->mask;
+            }
+        }
+
+        // Look up every long context before the human's move.
+        int rounds = std::min(static_cast<int>(history.size()), longMax - 1);
+        ContextSketch::hashContexts(history, history.size(), rounds, contexts.data());
+        int64_t exactCounts[3] = {shortCounts[0], shortCounts[1], shortCounts[2]};
+        int exactMask = shortMask;
+        std::vector<const FrequencyModel32::Context*> exactContexts;
+        for (int seqLen = longMin; seqLen <= rounds + 1; ++seqLen) {
+            const FrequencyModel32::Context* context = longModel.find(seqLen, contexts[seqLen - 2]);
+            exactContexts.push_back(context);
+            if (context) {
+                for (int m = 0; m < 3; ++m) {
+                    exactCounts[m] += context->counts[m];
+                    if (context->counts[m] > 0) exactMask |= 1 << m;
+                }
+            }
+        }
+        int shortPrediction = predictFromCounts(shortCounts, shortMask);
+        int exactPrediction = predictFromCounts(exactCounts, exactMask);
+        if (exactPrediction >= 0) {
+            predictions++;
+        }
+        shortCorrect += shortPrediction == human;
+        exactCorrect += exactPrediction == human;
+
+        for (auto& tally : tallies) {
+            bench::Timer timer;
+            int64_t counts[3] = {shortCounts[0], shortCounts[1], shortCounts[2]};
+            int mask = shortMask;
+            for (int seqLen = longMin; seqLen <= rounds + 1; ++seqLen) {
+                tally->sketch.prefetch(contexts[seqLen - 2]);
+            }
+            for (int seqLen = longMin; seqLen <= rounds + 1; ++seqLen) {
+                uint32_t estimate[3];
+                bool any = tally->sketch.estimate(contexts[seqLen - 2], estimate);
+                const FrequencyModel32::Context* context = exactContexts[static_cast<std::size_t>(seqLen - longMin)];
+                if (context) {
+                    tally->seen++;
+                    bool same = true;
+                    for (int m = 0; m < 3; ++m) {
+                        tally->overcount += static_cast<long long>(estimate[m]) - context->counts[m];
+                        same = same && estimate[m] == static_cast<uint32_t>(context->counts[m]);
+                    }
+                    tally->exact += same;
+                } else {
+                    tally->unseen++;
+                    tally->falsePositives += any;
+                }
+                for (int m = 0; m < 3; ++m) {
+                    counts[m] += estimate[m];
+                    if (estimate[m] > 0) mask |= 1 << m;
+                }
+            }
+            int prediction = predictFromCounts(counts, mask);
+            tally->correct += prediction == human;
+            tally->agreeing += prediction == exactPrediction;
+            tally->seconds += timer.seconds();
+        }
+
+        history.push_back(round);
+        for (int seqLen : seqLengths) {
+            if (history.size() < static_cast<size_t>(seqLen)) continue;
+            uint64_t key = FrequencyModel32::makeKey(history, history.size() - seqLen, seqLen - 1);
+            shortModel.increment(seqLen, key, round.first);
+        }
+        if (history.size() >= static_cast<size_t>(longMin)) {
+            int updateRounds = std::min(static_cast<int>(history.size()) - 1, longMax - 1);
+            ContextSketch::hashContexts(history, history.size() - 1, updateRounds, contexts.data());
+            for (int seqLen = longMin; seqLen <= updateRounds + 1; ++seqLen) {
+                longModel.increment(seqLen, contexts[seqLen - 2], round.first);
+            }
+            for (auto& tally : tallies) {
+                bench::Timer timer;
+                for (int seqLen = longMin; seqLen <= updateRounds + 1; ++seqLen) {
+                    tally->sketch.prefetch(contexts[seqLen - 2]);
+                }
+                for (int seqLen = longMin; seqLen <= updateRounds + 1; ++seqLen) {
+                    tally->sketch.add(contexts[seqLen - 2], round.first);
+                }
+                tally->seconds += timer.seconds();
+            }
+        }
+    }
+
+    std::size_t longContexts = 0;
+    for (int seqLen : longModel.seqLengths()) {
+        longContexts += longModel.contextCount(seqLen);
+    }
+    const long long total = static_cast<long long>(game.history.size());
+    auto row = [&](const std::string& label, const std::string& memory, const std::string& nsPerRound,
+                   const std::string& exactPct, const std::string& overcount, const std::string& falsePct,
+                   const std::string& agreePct, long long correct) {
+        std::cout << std::left << std::setw(10) << game.name << std::setw(23) << label << std::right
+                  << std::setw(11) << memory << std::setw(10) << nsPerRound << std::setw(9) << exactPct
+                  << std::setw(10) << overcount << std::setw(9) << falsePct << std::setw(9) << agreePct
+                  << std::setw(8) << percent(correct, total) << std::endl;
+    };
+    row("exact 3..7", std::to_string(shortModel.memoryUsage() >> 10), "-", "-", "-", "-", "-", shortCorrect);
+    row("exact 3.." + std::to_string(longMax), std::to_string((shortModel.memoryUsage() + longModel.memoryUsage()) >> 10),
+        "-", "100.00", "0", "0.00", "100.00", exactCorrect);
+    for (const auto& tally : tallies) {
+        std::ostringstream ns;
+        ns << std::fixed << std::setprecision(0) << tally->seconds * 1e9 / static_cast<double>(std::max<long long>(total, 1));
+        std::ostringstream over;
+        over << std::fixed << std::setprecision(2)
+             << static_cast<double>(tally->overcount) / static_cast<double>(std::max<long long>(tally->seen, 1));
+        row("sketch " + tally->label, std::to_string((shortModel.memoryUsage() + tally->sketch.memoryUsage()) >> 10),
+            ns.str(), percent(tally->exact, tally->seen), over.str(), percent(tally->falsePositives, tally->unseen),
+            percent(tally->agreeing, total), tally->correct);
+    }
+    std::cout << "  " << longContexts << " long contexts counted exactly, " << predictions << " rounds predicted"
+              << std::endl;
+    return 0;
+}
+
+} // namespace
+
+// Accuracy of Count-Min sketches for orders 8..--long-orders against exact
+// counts, on games recorded from the simulated opponents (and the script, if
+// given), and what the long orders add to the prediction.
+int benchSketch(const Options& options) {
+    std::vector<RecordedGame> games;
+    for (const auto& entry : bench::opponentKinds()) {
+        bench::Opponent opponent(entry.second, options.seed);
+        games.push_back({entry.first, recordGame(options, [&opponent](const History& history) {
+            return opponent.next(history);
+        }, options.rounds)});
+    }
+    if (!options.scriptPath.empty()) {
+        std::vector<Move> moves;
+        if (!readScriptMoves(options.scriptPath, moves)) {
+            std::cerr << "Failed to open script " << options.scriptPath << std::endl;
+            return 1;
+        }
+        games.push_back({"script", recordGame(options, [&moves](const History& history) {
+            return moves[history.size()];
+        }, static_cast<long long>(moves.size()))});
+    }
+
+    std::cout << "Rounds per simulated game: " << options.rounds << ", seed " << options.seed << "; long orders 8.."
+              << options.longOrders << ", sketches of depth 4" << std::endl;
+    std::cout << "ns: sketch update and lookup per round; exact%, overcount and false+% over long-context lookups;"
+              << " agree%: same prediction as exact long counts" << std::endl;
+    std::cout << std::left << std::setw(10) << "game" << std::setw(23) << "counts" << std::right
+              << std::setw(11) << "model KiB" << std::setw(10) << "ns/round" << std::setw(9) << "exact%"
+              << std::setw(10) << "overcount" << std::setw(9) << "false+%" << std::setw(9) << "agree%"
+              << std::setw(8) << "acc%" << std::endl;
+    for (const RecordedGame& game : games) {
+        benchSketchGame(options, game);
+    }
+    return 0;
+}
+
+} // namespace bench
@@ -0,0 +1,135 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "ContextTreeStrategy.h"
+#include "LongestMatchStrategy.h"
+#include "SmartStrategy.h"
+#include "Strategy.h"
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// strategies, variants: per-round cost and memory of the strategies against the
+// simulated opponents, on each move set.
+// ---------------------------------------------------------------------------
+
+namespace bench {
+
+namespace {
+
+struct RunResult {
+    double seconds = 0;
+    long long computerWins = 0;
+    long long modelBytes = 0;
+    long long modelAllocations = 0;
+};
+
+// Play 'rounds' rounds of a simulated opponent against the strategy that
+// makeStrategy() builds, measuring time and the heap held by the strategy.
+// Rock-Paper-Scissors unless MoveSet says otherwise.
+template <typename MoveSet = RockPaperScissors>
+RunResult runStrategy(const std::type_identity_t<std::function<std::unique_ptr<BasicStrategy<MoveSet>>()>>& makeStrategy,
+                      bench::OpponentKind kind, const Options& options) {
+    using Move = typename MoveSet::Move;
+    std::vector<std::pair<Move, Move>> history;
+    history.reserve(static_cast<size_t>(options.rounds));
+    bench::BasicOpponent<MoveSet> opponent(kind, options.seed);
+
+    auto& stats = bench::allocStats();
+    long long bytesBefore = stats.liveBytes.load();
+    long long allocsBefore = stats.allocations.load();
+
+    RunResult result;
+    std::unique_ptr<BasicStrategy<MoveSet>> strategy = makeStrategy();
+    bench::Timer timer;
+    for (long long round = 0; round < options.rounds; ++round) {
+        Move humanMove = opponent.next(history);
+        Move computerMove = strategy->makeMove(history);
+        if (MoveRules<MoveSet>::winner(humanMove, computerMove) < 0) {
+            result.computerWins++;
+        }
+        history.emplace_back(humanMove, computerMove);
+        strategy->updateFrequencies(history);
+    }
+    result.seconds = timer.seconds();
+    result.modelBytes = stats.liveBytes.load() - bytesBefore;
+    result.modelAllocations = stats.allocations.load() - allocsBefore;
+    return result;
+}
+
+void printRow(const std::string& opponent, const std::string& engine, const RunResult& r, const Options& options) {
+    std::cout << std::left << std::setw(10) << opponent
+              << std::setw(22) << engine << std::right
+              << std::setw(10) << std::fixed << std::setprecision(1)
+              << (r.seconds * 1e9 / options.rounds)
+              << std::setw(9) << (r.computerWins * 100.0 / options.rounds)
+              << std::setw(12) << (r.modelBytes / 1024)
+              << std::setw(12) << r.modelAllocations << std::endl;
+}
+
+} // namespace
+
+// Memory and per-round cost of the context tree and the longest-match
+// strategy against SmartStrategy.
+int benchStrategies(const Options& options) {
+    std::cout << "Rounds per run: " << options.rounds << ", seed " << options.seed << std::endl;
+    std::cout << std::left << std::setw(10) << "opponent" << std::setw(22) << "engine" << std::right
+              << std::setw(10) << "ns/round" << std::setw(9) << "cpu win%"
+              << std::setw(12) << "heap KiB" << std::setw(12) << "allocs" << std::endl;
+
+    for (const auto& entry : bench::opponentKinds()) {
+        const Options& o = options;
+        printRow(entry.first, "Smart N=3..7", runStrategy([&o] {
+            return std::make_unique<SmartStrategy>(o.seed, "", "");
+        }, entry.second, options), options);
+        printRow(entry.first, "ContextTree N=3..7", runStrategy([&o] {
+            return std::make_unique<ContextTreeStrategy>(o.seed, 3, 7);
+        }, entry.second, options), options);
+        std::string deep = "ContextTree N=3.." + std::to_string(options.maxOrder);
+        printRow(entry.first, deep, runStrategy([&o] {
+            return std::make_unique<ContextTreeStrategy>(o.seed, 3, o.maxOrder);
+        }, entry.second, options), options);
+        printRow(entry.first, "LongestMatch", runStrategy([&o] {
+            return std::make_unique<LongestMatchStrategy>(o.seed);
+        }, entry.second, options), options);
+    }
+    return 0;
+}
+
+namespace {
+
+// The context tree built for each move set, against the same opponents.
+template <typename MoveSet>
+void benchVariant(const std::string& name, const Options& options) {
+    using Tree = BasicContextTreeStrategy<MoveSet>;
+    std::cout << name << ", " << MoveRules<MoveSet>::COUNT << " moves" << std::endl;
+    for (const auto& entry : bench::opponentKinds()) {
+        const Options& o = options;
+        printRow(entry.first, "ContextTree N=3..7", runStrategy<MoveSet>([&o] {
+            return std::make_unique<Tree>(o.seed, 3, 7);
+        }, entry.second, options), options);
+    }
+}
+
+} // namespace
+
+// Games other than Rock-Paper-Scissors: each is only a move-set descriptor,
+// so the Rock-Paper-Scissors rows must cost what the strategies command shows.
+int benchVariants(const Options& options) {
+    std::cout << "Rounds per run: " << options.rounds << ", seed " << options.seed << std::endl;
+    std::cout << std::left << std::setw(10) << "opponent" << std::setw(22) << "engine" << std::right
+              << std::setw(10) << "ns/round" << std::setw(9) << "cpu win%"
+              << std::setw(12) << "heap KiB" << std::setw(12) << "allocs" << std::endl;
+    benchVariant<RockPaperScissors>("Rock-Paper-Scissors", options);
+    benchVariant<RockPaperScissorsLizardSpock>("Rock-Paper-Scissors-Lizard-Spock", options);
+    std::cout << "Against a random opponent the computer wins about (moves - 1) / (2 * moves) of the rounds"
+              << std::endl;
+    return 0;
+}
+
+} // namespace bench
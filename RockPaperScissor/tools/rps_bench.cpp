@@ -0,0 +1,287 @@
+#include "BenchCommands.h"
+#include "BenchUtil.h"
+#include "DiffHarness.h"
+#include "SmartStrategy.h"
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+// ---------------------------------------------------------------------------
+// Global allocation accounting. Every block carries a small header with its
+// size so live bytes can be tracked exactly.
+// ---------------------------------------------------------------------------
+namespace {
+constexpr std::size_t ALLOC_HEADER = alignof(std::max_align_t);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+// The blocks below come from malloc and go back to free; GCC cannot see that
+// through the replaced operators.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+    void* block = std::malloc(size + ALLOC_HEADER);
+    if (!block) throw std::bad_alloc();
+    *static_cast<std::size_t*>(block) = size;
+    auto& stats = bench::allocStats();
+    stats.allocations.fetch_add(1, std::memory_order_relaxed);
+    stats.liveBytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed);
+    return static_cast<char*>(block) + ALLOC_HEADER;
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    void* block = static_cast<char*>(ptr) - ALLOC_HEADER;
+    auto& stats = bench::allocStats();
+    stats.frees.fetch_add(1, std::memory_order_relaxed);
+    stats.liveBytes.fetch_sub(static_cast<long long>(*static_cast<std::size_t*>(block)), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete[](void* ptr) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+namespace {
+
+void printUsage() {
+    std::cerr << "Usage: rps_bench <command> [--rounds N] [--seed S] [--max-order K]" << std::endl;
+    std::cerr << "                 [--histories H] [--history-length L] [--engine E]" << std::endl;
+    std::cerr << "                 [--save-every K] [--players P] [--sessions S] [--session-rounds R]" << std::endl;
+    std::cerr << "                 [--profile-cap MiB] [--script FILE] [--score-mib M]" << std::endl;
+    std::cerr << "                 [--games G] [--game-rounds R] [--window W]" << std::endl;
+    std::cerr << "                 [--threads T] [--epoch-rounds E] [--long-orders N] [--processes N]" << std::endl;
+    std::cerr << "                 [--writers N] [--shared-slots N]" << std::endl;
+    std::cerr << "Commands:" << std::endl;
+    std::cerr << "  strategies   per-round cost and memory of ContextTree and LongestMatch vs Smart" << std::endl;
+    std::cerr << "  variants     the context tree on Rock-Paper-Scissors and Rock-Paper-Scissors-Lizard-Spock" << std::endl;
+    std::cerr << "  model        allocations, heap and RSS of the map-based vs arena model" << std::endl;
+    std::cerr << "  diff         check an engine (--engine smart|tree, default smart) against the reference" << std::endl;
+    std::cerr << "               Smart strategy on H seeded histories of 1..L rounds and report their relative speed" << std::endl;
+    std::cerr << "  save         round latency with a model save every K rounds, synchronous vs background" << std::endl;
+    std::cerr << "  profiles     per-player profiles under a memory cap vs all resident" << std::endl;
+    std::cerr << "  counters     accuracy vs memory and file size of 8-, 16- and 32-bit counters on" << std::endl;
+    std::cerr << "               recorded games (the simulated opponents, plus a script file of R/P/S)" << std::endl;
+    std::cerr << "  sketch       Count-Min sketches for orders 8..N against exact counts on the same recorded" << std::endl;
+    std::cerr << "               games: estimate error, prediction agreement and accuracy per sketch size" << std::endl;
+    std::cerr << "  score        throughput of the packed round-scoring kernels on M MiB of rounds" << std::endl;
+    std::cerr << "  analytics    game analytics over G recorded games of R rounds (P players), sequential" << std::endl;
+    std::cerr << "               vs per player vs threads, checking that the merged results agree" << std::endl;
+    std::cerr << "  coroutines   G games of R rounds multiplexed on one thread by coroutines vs a thread" << std::endl;
+    std::cerr << "               per game: time per round and memory per waiting game" << std::endl;
+    std::cerr << "  shadow       live round latency with shadow strategies: none, inline per round," << std::endl;
+    std::cerr << "               inline batches and batches on a worker thread" << std::endl;
+    std::cerr << "  reload       round latency while freq.txt is replaced and hot-reloaded, checking" << std::endl;
+    std::cerr << "               that every adopted model is a complete version of the file" << std::endl;
+    std::cerr << "  replicas     learning throughput of 1..T threads on one locked model vs per-thread" << std::endl;
+    std::cerr << "               replicas merged every E rounds, with the replicas' staleness" << std::endl;
+    std::cerr << "  allocs       heap allocations per round after a warm-up, per strategy; fails if any" << std::endl;
+    std::cerr << "               happen against a cycling opponent, whose contexts are all known by then" << std::endl;
+    std::cerr << "  processes    1..N processes learning into one model file, merging on save vs replacing" << std::endl;
+    std::cerr << "               it: rounds kept on disk, and what a concurrent reader loads" << std::endl;
+    std::cerr << "  sharedmem    1..N (--writers, default 16) writer processes with private models vs one" << std::endl;
+    std::cerr << "               shared-memory model (--shared-slots per table): memory and its break-even," << std::endl;
+    std::cerr << "               updates/s; fails on lost rounds" << std::endl;
+    std::cerr << "  predict      makeMove and updateFrequencies time with the smart strategy's prediction" << std::endl;
+    std::cerr << "               cache off and on, per opponent; fails unless the moves are the same" << std::endl;
+    std::cerr << "  core         rps_core C ABI: P sessions of R rounds (--session-rounds) stepped one call" << std::endl;
+    std::cerr << "               per round vs batched, against direct C++ calls (--engine smart|tree|match," << std::endl;
+    std::cerr << "               default smart)" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    std::string command = argv[1];
+    bench::Options options;
+    bench::DiffOptions diffOptions;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--rounds" && hasValue) {
+            options.rounds = std::atoll(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--max-order" && hasValue) {
+            options.maxOrder = std::atoi(argv[++i]);
+        } else if (arg == "--save-every" && hasValue) {
+            options.saveEvery = std::atoll(argv[++i]);
+        } else if (arg == "--players" && hasValue) {
+            options.players = std::atoi(argv[++i]);
+        } else if (arg == "--sessions" && hasValue) {
+            options.sessions = std::atoll(argv[++i]);
+        } else if (arg == "--session-rounds" && hasValue) {
+            options.sessionRounds = std::atoi(argv[++i]);
+        } else if (arg == "--profile-cap" && hasValue) {
+            options.profileCapMiB = std::atoll(argv[++i]);
+        } else if (arg == "--games" && hasValue) {
+            options.games = std::atoll(argv[++i]);
+        } else if (arg == "--game-rounds" && hasValue) {
+            options.gameRounds = std::atoi(argv[++i]);
+        } else if (arg == "--window" && hasValue) {
+            options.window = std::atoi(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (arg == "--processes" && hasValue) {
+            options.processes = std::atoi(argv[++i]);
+        } else if (arg == "--writers" && hasValue) {
+            options.writers = std::atoi(argv[++i]);
+        } else if (arg == "--shared-slots" && hasValue) {
+            options.sharedSlots = std::atoll(argv[++i]);
+        } else if (arg == "--long-orders" && hasValue) {
+            options.longOrders = std::atoi(argv[++i]);
+        } else if (arg == "--epoch-rounds" && hasValue) {
+            options.epochRounds = std::atoll(argv[++i]);
+        } else if (arg == "--score-mib" && hasValue) {
+            options.scoreMiB = std::atoll(argv[++i]);
+        } else if (arg == "--script" && hasValue) {
+            options.scriptPath = argv[++i];
+        } else if (arg == "--histories" && hasValue) {
+            diffOptions.histories = std::atoll(argv[++i]);
+        } else if (arg == "--history-length" && hasValue) {
+            diffOptions.maxHistoryLength = std::atoll(argv[++i]);
+        } else if (arg == "--engine" && hasValue) {
+            diffOptions.engine = argv[++i];
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (options.rounds <= 0) {
+        std::cerr << "--rounds must be positive" << std::endl;
+        return 1;
+    }
+
+    if (command == "strategies") {
+        return bench::benchStrategies(options);
+    }
+    if (command == "variants") {
+        return bench::benchVariants(options);
+    }
+    if (command == "model") {
+        return bench::benchModel(options);
+    }
+    if (command == "save") {
+        if (options.saveEvery <= 0) {
+            std::cerr << "--save-every must be positive" << std::endl;
+            return 1;
+        }
+        return bench::benchSave(options);
+    }
+    if (command == "profiles") {
+        if (options.players <= 0 || options.sessions <= 0 || options.sessionRounds <= 0 || options.profileCapMiB < 0) {
+            std::cerr << "--players, --sessions and --session-rounds must be positive" << std::endl;
+            return 1;
+        }
+        return bench::benchProfiles(options);
+    }
+    if (command == "analytics") {
+        if (options.games <= 0 || options.gameRounds <= 0 || options.players <= 0 || options.window <= 0) {
+            std::cerr << "--games, --game-rounds, --players and --window must be positive" << std::endl;
+            return 1;
+        }
+        return bench::benchAnalytics(options);
+    }
+    if (command == "score") {
+        if (options.scoreMiB <= 0) {
+            std::cerr << "--score-mib must be positive" << std::endl;
+            return 1;
+        }
+        return bench::benchScore(options);
+    }
+    if (command == "coroutines") {
+        if (options.games <= 0 || options.gameRounds <= 0) {
+            std::cerr << "--games and --game-rounds must be positive" << std::endl;
+            return 1;
+        }
+        return bench::benchCoroutines(options);
+    }
+    if (command == "shadow") {
+        if (options.window <= 0) {
+            std::cerr << "--window must be positive" << std::endl;
+            return 1;
+        }
+        return bench::benchShadow(options);
+    }
+    if (command == "reload") {
+        return bench::benchReload(options);
+    }
+    if (command == "replicas") {
+        if (options.threads <= 0 || options.epochRounds <= 0 || options.gameRounds <= 0 ||
+            options.rounds < options.threads) {
+            std::cerr << "--threads, --epoch-rounds and --game-rounds must be positive, --rounds at least T" << std::endl;
+            return 1;
+        }
+        return bench::benchReplicas(options);
+    }
+    if (command == "core") {
+        if (options.players <= 0 || options.sessionRounds <= 0) {
+            std::cerr << "--players and --session-rounds must be positive" << std::endl;
+            return 1;
+        }
+        return bench::benchCore(options, diffOptions.engine);
+    }
+    if (command == "sketch") {
+        if (options.longOrders < 8 || options.longOrders > SmartStrategy::MAX_LONG_ORDER) {
+            std::cerr << "--long-orders must be between 8 and " << SmartStrategy::MAX_LONG_ORDER << std::endl;
+            return 1;
+        }
+        return bench::benchSketch(options);
+    }
+    if (command == "allocs") {
+        if (options.longOrders < 8 || options.longOrders > SmartStrategy::MAX_LONG_ORDER) {
+            std::cerr << "--long-orders must be between 8 and " << SmartStrategy::MAX_LONG_ORDER << std::endl;
+            return 1;
+        }
+        return bench::benchAllocs(options);
+    }
+    if (command == "processes") {
+        if (options.processes <= 0 || options.saveEvery <= 0 || options.rounds < 3) {
+            std::cerr << "--processes and --save-every must be positive, --rounds at least 3" << std::endl;
+            return 1;
+        }
+        return bench::benchProcesses(options);
+    }
+    if (command == "sharedmem") {
+        if (options.writers <= 0 || options.sharedSlots <= 0 || options.rounds < 3) {
+            std::cerr << "--writers and --shared-slots must be positive, --rounds at least 3" << std::endl;
+            return 1;
+        }
+        return bench::benchSharedMemory(options);
+    }
+    if (command == "predict") {
+        return bench::benchPredict(options);
+    }
+    if (command == "counters") {
+        return bench::benchCounters(options);
+    }
+    if (command == "diff") {
+        if (diffOptions.histories <= 0 || diffOptions.maxHistoryLength <= 0) {
+            std::cerr << "--histories and --history-length must be positive" << std::endl;
+            return 1;
+        }
+        diffOptions.seed = options.seed;
+        return bench::runDiffHarness(diffOptions);
+    }
+    printUsage();
+    return 1;
+}